@@ -35,17 +35,66 @@
 
 #define DEVICE_ROBOTARMBASE
 
+/*****************************************************************************/
+// Board revision:
+// The library is built for one PCB revision - only its pinout is compiled,
+// so e.g. Power_Servos() is a single port instruction.
+// 3 = Robot ARM v3 PCB (default), 2 = older PCBs.
+// Select it in the Makefile: make BOARD_REV=2
+// initRobotBase() stops with an error message if the BOARD_ID pin
+// (check_board) shows that the board does not match.
+
+#ifndef ROBOT_ARM_REVISION
+#define ROBOT_ARM_REVISION 3
+#endif
+
+#if ROBOT_ARM_REVISION >= 3
+#define ROBOT_ARM_V3 1
+#else
+#define ROBOT_ARM_V3 0
+#endif
+
 /*****************************************************************************/
 // CPU Clock:
+// The v3 PCB has a 16.000MHz crystal, the older PCBs 16.384MHz. F_CPU is
+// the clock of the board revision - Timer 2, the baudrates and the
+// _delay_xx() functions are calculated from it.
 
 #ifdef F_CPU
 #undef F_CPU
 #endif
-#ifndef F_CPU
-#define F_CPU 16384000 // Base: 16.384MHz  - DO NOT CHANGE!
+#if ROBOT_ARM_V3
+#define F_CPU 16000000UL // Base: 16.000MHz  - DO NOT CHANGE!
+#else
+#define F_CPU 16384000UL // Base: 16.384MHz  - DO NOT CHANGE!
 #endif
 #define F_CPU_v3 16000000 // Base: 16.000MHz  - DO NOT CHANGE!
 
+// Timer 2 (prescaler 8) interrupts 10 times per ms. If the counts per ms
+// can not be divided by 10 (16.384MHz: 2048), the first TIMER2_EXTRA
+// ticks of every ms are one count longer, so the ms is still exact.
+#if F_CPU % 8000
+#error "Timer 2 needs a clock that is a multiple of 8kHz!"
+#endif
+#define TIMER2_COUNTS_MS	(F_CPU / 8 / 1000)		// counts per ms
+#define TIMER2_COUNTS		(TIMER2_COUNTS_MS / 10)	// counts per 100us tick
+#define TIMER2_EXTRA		(TIMER2_COUNTS_MS % 10)
+#define TIMER2_TOP			(TIMER2_COUNTS - 1)		// OCR2
+
+// Counts from the start of the ms to the start of tick __T__ (0..10):
+#if TIMER2_EXTRA
+#define TIMER2_TICK_START(__T__) \
+	((__T__) * TIMER2_COUNTS + ((__T__) < TIMER2_EXTRA ? (__T__) : TIMER2_EXTRA))
+#else
+#define TIMER2_TICK_START(__T__) ((__T__) * TIMER2_COUNTS)
+#endif
+// Counts of the current ms to microseconds:
+#if TIMER2_COUNTS_MS == 2000
+#define TIMER2_US(__COUNT__) ((__COUNT__) >> 1)
+#else
+#define TIMER2_US(__COUNT__) ((uint16_t)((uint32_t)(__COUNT__) * 1000 / TIMER2_COUNTS_MS))
+#endif
+
 
 /*****************************************************************************/
 // Includes:
@@ -387,4 +436,46 @@ DDRG = INIT_DDRG_v3;
 #define BAUD_HIGH		500000 //High speed - 500 kBaud
 #define UBRR_BAUD_HIGH	((F_CPU/(16*BAUD_HIGH))-1)
 #define UBRR_BAUD_HIGH_v3	((F_CPU_v3/(16*BAUD_HIGH))-1)
+
+/*****************************************************************************/
+// Baudrate calculation for the clock of the board revision (F_CPU).
+// Everything is calculated by the compiler - see the baudrate table in
+// RobotArmUart.c.
+//
+// __DIV__ is 16 for normal mode and 8 for double speed mode (U2X).
+// The UBRR value is rounded to the nearest value.
+
+#define BAUD_UBRR(__BAUD__, __DIV__) \
+	((F_CPU + (__DIV__) * (__BAUD__) / 2) / ((__DIV__) * (__BAUD__)) - 1)
+#define BAUD_ACTUAL(__BAUD__, __DIV__) \
+	(F_CPU / ((__DIV__) * (BAUD_UBRR(__BAUD__, __DIV__) + 1)))
+// Error in 1/1000:
+#define BAUD_ERROR(__BAUD__, __DIV__) \
+	((BAUD_ACTUAL(__BAUD__, __DIV__) > (__BAUD__) ? \
+	  BAUD_ACTUAL(__BAUD__, __DIV__) - (__BAUD__) : \
+	  (__BAUD__) - BAUD_ACTUAL(__BAUD__, __DIV__)) * 1000 / (__BAUD__))
+// Use double speed only if it is more accurate (normal mode samples
+// each bit more often and is less sensitive to noise):
+#define BAUD_U2X(__BAUD__) \
+	(BAUD_ERROR(__BAUD__, 8) < BAUD_ERROR(__BAUD__, 16))
+#define BAUD_ERROR_BEST(__BAUD__) \
+	(BAUD_U2X(__BAUD__) ? BAUD_ERROR(__BAUD__, 8) : BAUD_ERROR(__BAUD__, 16))
+// UBRR value with the U2X flag in bit 15:
+#define BAUD_SETTING(__BAUD__) \
+	(BAUD_U2X(__BAUD__) ? (0x8000 | BAUD_UBRR(__BAUD__, 8)) : BAUD_UBRR(__BAUD__, 16))
+
+// Baudrates that can be selected at runtime with setUARTBaudrate():
+#define BAUD_250K		250000
+#define BAUD_1M			1000000
+
+// Maximum baudrate error in 1/1000. 2% is the limit for 8N1 if both
+// sides have an error. Baudrates above it can not be selected (with
+// 16.384MHz 250k, 500k and 1M are 2.4% too fast), BAUD_LOW must work:
+#define BAUD_MAX_ERROR	20
+#define BAUD_SUPPORTED(__BAUD__) (BAUD_ERROR_BEST(__BAUD__) <= BAUD_MAX_ERROR)
+
+#if !BAUD_SUPPORTED(BAUD_LOW)
+#error "Baudrate error too large for F_CPU!"
+#endif
+
 #endif
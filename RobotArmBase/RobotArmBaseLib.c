@@ -72,7 +72,14 @@ volatile uint8_t ms_timer;
 volatile stopwatches_t stopwatches;
 volatile uint8_t feeler_timer;
 
-// Can be used to detect which board revision is used
+// 1ms steps of the Timer 2 interrupt that are not finished yet:
+static volatile uint8_t ms_pending;
+
+static inline void task_ADC_rate(void);
+static inline void task_overcurrent_backoff(void);
+
+// Board revision detected by check_board(). The library itself is built
+// for ROBOT_ARM_REVISION (s. RobotArmBase.h), this is only a sanity check.
 uint8_t robot_arm_v3 = 0; 
 
 /*****************************************************************************/
@@ -82,27 +89,43 @@ uint8_t robot_arm_v3 = 0;
 ISR(TIMER2_COMP_vect)
 {
 	delay_timer++;
-
-	if(ms_timer++ >= 10) { // 10 * 100s = 1ms
-  	// 16bit Stopwatches:
-  	if(stopwatches.watches & STOPWATCH1)
-  		stopwatches.watch1++;
-  	if(stopwatches.watches & STOPWATCH2)
-  		stopwatches.watch2++;
-  	if(stopwatches.watches & STOPWATCH3)
-  		stopwatches.watch3++;
-  	if(stopwatches.watches & STOPWATCH4)
-  		stopwatches.watch4++;
-  	if(stopwatches.watches & STOPWATCH5)
-  		stopwatches.watch5++;
-  	if(stopwatches.watches & STOPWATCH6)
-  		stopwatches.watch6++;
-  	if(stopwatches.watches & STOPWATCH7)
-  		stopwatches.watch7++;
-  	if(stopwatches.watches & STOPWATCH8)
-  		stopwatches.watch8++;
-  	ms_timer=0;
+	ISR_STATS_ENTER();	// after delay_timer++, the compare match was before
+	if(cpu_idle) {		// woke idle() up, the sleep ends here
+		idle_time += (uint16_t)(delay_timer * TIMER2_COUNTS + TCNT2 - idle_start);
+		cpu_idle = 0;
+	}
+#if TIMER2_EXTRA
+	// Length of the tick that has just started (s. TIMER2_EXTRA):
+	OCR2 = (ms_timer >= 9 || ms_timer + 1 < TIMER2_EXTRA) ? TIMER2_TOP + 1 : TIMER2_TOP;
+#endif
+
+	if(++ms_timer >= 10) { // 10 * 100s = 1ms
+  	ms_timer = 0;
+  	ms_ticks++;	// the stopwatches are calculated from ms_ticks
+  	// Idle time of the last second, TIMER2_COUNTS_MS * 1000 = 100%:
+  	if(++idle_window >= 1000) {
+  		idle_percent = idle_time / (TIMER2_COUNTS_MS * 10UL);
+  		idle_time = 0;
+  		idle_window = 0;
+  	}
+  	// The 1ms step (soft timers, motion engine...) takes several
+  	// 100s ticks with six moving servos. It runs with interrupts
+  	// enabled, so the UART and the ADC are not blocked. A tick that
+  	// ends while it is running only counts ms_pending - the running
+  	// step is repeated instead of nesting:
+  	if(!ms_pending++) {
+  		do {
+  			sei();
+  			timerTick();
+  			task_overcurrent_backoff();
+  			motionTick();
+  			task_ADC_rate();
+  			checkStackGuard();
+  			cli();
+  		} while(--ms_pending);
+  	}
 	}
+	ISR_STATS_LEAVE(ISR_STAT_TIMER2);
 }
 
 /*****************************************************************************/
@@ -111,10 +134,10 @@ ISR(TIMER2_COMP_vect)
  * anywhere in this library!
  * sleep has 100s resolution but can only delay for max. 255 * 100s. 
  *
- * This is a blocking routine, which means that the processor
- * will loop in this routine and (except for interrupts) the
- * normal program flow is stopped!
- * Thus you should use the Stopwatch functions wherever you can!
+ * The normal program flow is stopped, but the tasks of the
+ * cooperative scheduler (addTask, RobotArmScheduler.c) keep running
+ * while the processor waits here.
+ * Thus you should use the Stopwatch functions or tasks wherever you can!
  *
  * Example:
  *		mSleep(1); // delay 1 * 1ms = 1ms 
@@ -126,102 +149,70 @@ ISR(TIMER2_COMP_vect)
 
 void sleep(uint8_t time)
 {
-	for (delay_timer = 0; delay_timer < time;);
+	yieldTicks(time);
 }
 
 
 void mSleep(uint16_t time)
 {
-	while (time--) sleep(10);
+	yieldFor(time);
 }
 
 
 /*****************************************************************************/
-// 4 blue Status LEDs (SL1 - SL4) for Robot Arm v3:
-
-/** 
- * Set the 4 Status LEDs that are connected to the Microcontroller
- * 
- * Example:
- *  setLEDs(0b1111); // All LEDs on
- *  setLEDs(0b0011); // LED1 + 2 on, LED3 + 4 off
+/* Stopwatches.
+ * They are not incremented in the interrupt: a running stopwatch stores
+ * the start time (ms_ticks - value), a stopped one its value. So there
+ * is no work in the Timer 2 interrupt, no matter how many are running.
+ * Use the macros startStopwatch1(), getStopwatch1() ... from
+ * RobotArmBaseLib.h - watch is the stopwatch number 1..8.
  */
-void setLEDs(uint8_t leds)
-{
-	PORTG &= ~0xF; 
-	PORTG |= (leds & 0xf);	
-}	
 
-/** 
- * Set ONLY LED1, don't change anything for the other LEDs.
- */
-void setLED1(uint8_t led)
+void startStopwatch(uint8_t watch)
 {
-	PORTG &= ~SLED1; 
-	PORTG |= (led > 0) ? SLED1 : 0;	
+	uint8_t mask = 1 << (watch - 1);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(!(stopwatches.watches & mask)) {
+			stopwatches.watch[watch - 1] = (uint16_t)ms_ticks - stopwatches.watch[watch - 1];
+			stopwatches.watches |= mask;
+		}
+	}
 }
 
-/** 
- * Set ONLY LED2, don't change anything for the other LEDs.
- */
-void setLED2(uint8_t led)
-{
-	PORTG &= ~SLED2; 
-	PORTG |= (led > 0) ? SLED2 : 0;	
-}	
-
-/** 
- * Set ONLY LED3, don't change anything for the other LEDs.
- */
-void setLED3(uint8_t led)
+void stopStopwatch(uint8_t watch)
 {
-	PORTG &= ~SLED3; 
-	PORTG |= (led > 0) ? SLED3 : 0;	
-}	
+	uint8_t mask = 1 << (watch - 1);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(stopwatches.watches & mask) {
+			stopwatches.watch[watch - 1] = (uint16_t)ms_ticks - stopwatches.watch[watch - 1];
+			stopwatches.watches &= ~mask;
+		}
+	}
+}
 
-/** 
- * Set ONLY LED4, don't change anything for the other LEDs.
- */
-void setLED4(uint8_t led)
+uint16_t getStopwatch(uint8_t watch)
 {
-	PORTG &= ~SLED4; 
-	PORTG |= (led > 0) ? SLED4 : 0;	
-}	
-
-
-/*****************************************************************************/
-// Duo LED red+green for old Robot Arm PCBs:
-
-// Set Power LED on red
-/*
- * Example:
- *
- *			PowerLEDred();
- *			// Power led = RED
- */
-
-void PowerLEDred(void){
-PORTG |= LED_RED;
-PORTG &= ~LED_GREEN;	
+	uint16_t value;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		value = stopwatches.watch[watch - 1];
+		if(stopwatches.watches & (1 << (watch - 1)))
+			value = (uint16_t)ms_ticks - value;
+	}
+	return value;
 }
 
-// Set Power LED on green
-void PowerLEDgreen(void){	
-PORTG &= ~LED_RED;
-PORTG |= LED_GREEN;		
+void setStopwatch(uint8_t watch, uint16_t value)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(stopwatches.watches & (1 << (watch - 1)))
+			value = (uint16_t)ms_ticks - value;
+		stopwatches.watch[watch - 1] = value;
+	}
 }
 
-// Set Power LED on orange
-void PowerLEDorange(void){	
-PORTG |= LED_RED;
-PORTG |= LED_GREEN;	
-}
 
-// Set Power LED off
-void PowerLEDoff(void){
-PORTG &= ~LED_RED;
-PORTG &= ~LED_GREEN;	
-}
+/*****************************************************************************/
+// Status LEDs, Power LED and servo power: s. RobotArmPins.cpp
 
 
 
@@ -229,19 +220,17 @@ PORTG &= ~LED_GREEN;
 // Set Beep sound on
 void setBeepsound(void)
 {
-  if(!robot_arm_v3) {
+#if ROBOT_ARM_V3
+	//Clear OC0 on compare match, set OC0 at BOTTOM,
+	TCCR0 =   (0 << WGM00) | (1 << WGM01) 
+			| (1 << COM00) | (0 << COM01)   
+			| (1 << CS02)  | (0 << CS01) | (1 << CS00);
+#else
 	//Clear OC0 on compare match, set OC0 at BOTTOM,
 	TCCR0 =   (1 << WGM00) | (1 << WGM01) 
 			| (0 << COM00) | (1 << COM01)   
 			| (0 << CS02)  | (1 << CS01) | (0 << CS00);
-	}
-	else
-	{
-		//Clear OC0 on compare match, set OC0 at BOTTOM,
-  	TCCR0 =   (0 << WGM00) | (1 << WGM01) 
-			| (1 << COM00) | (0 << COM01)   
-			| (1 << CS02)  | (0 << CS01) | (1 << CS00);
-	}
+#endif
 }
 
 /*****************************************************************************/
@@ -284,8 +273,7 @@ void changeBeepsound(int PWMvalue)
 int scan_keyboard(void){
 
 	int i,mask,x;
-	if(robot_arm_v3) // connector pinout is different for v3
-	{
+#if ROBOT_ARM_V3 // connector pinout is different for v3
 		DDRA = 0x0F;
 		PORTA = 0x01;
 		sleep(15);
@@ -326,9 +314,7 @@ int scan_keyboard(void){
 		        return i + 1;
 		  mask >>= 1;
 		}
-	}
-	else
-	{
+#else
 	  DDRA = 0xF0;
     PORTA = 0x10;
   	sleep(15);	
@@ -373,7 +359,7 @@ int scan_keyboard(void){
               return i + 13;
           mask <<= 1;
   	}
-  }
+#endif
 	
 	return 0;
 }
@@ -394,10 +380,17 @@ int scan_keyboard(void){
  *
  * This function returns 0 if the ADC is buisy! This has been done to
  * prevents problems when the automatical function is used.
+ * If the interrupt driven ADC scanner is running, the last value of the
+ * scanner is returned immediately.
  *
  */
 uint16_t readADC (int channel)
 {
+	if (adc_scanner_running) {	// scanner has the ADC, return its value
+		adc_snapshot_t snapshot;
+		getADCSnapshot(&snapshot);
+		return snapshot.value[channel & (ADC_CHANNELS - 1)];
+	}
 	if (ADCSRA & (1<<ADSC)) return 0;  // check if ADC is buisy...
 	
 	ADMUX = (1<<REFS0) | (0<<REFS1) | (channel<<MUX0);// AVCC
@@ -442,18 +435,466 @@ void startADC(uint8_t channel)
 
 // -----------------------
 
-uint16_t Current_1; 
-uint16_t Current_2; 
-uint16_t Current_3; 
-uint16_t Current_4; 
-uint16_t Current_5; 
-uint16_t Current_6; 
+volatile uint16_t Current_1; 
+volatile uint16_t Current_2; 
+volatile uint16_t Current_3; 
+volatile uint16_t Current_4; 
+volatile uint16_t Current_5; 
+volatile uint16_t Current_6; 
 
-uint16_t adcUBat;
-uint16_t adcExt;
+volatile uint16_t adcUBat;
+volatile uint16_t adcExt;
 
 uint8_t current_adc_channel = 255; // 255 = inital run
 
+/*****************************************************************************/
+// Interrupt driven ADC scanner:
+
+// The ADC interrupt converts all 8 channels one after another in the
+// background. A complete scan is written to the back buffer, then the
+// buffers are swapped, so the front buffer always contains one consistent
+// scan. The Current_N, adcUBat and adcExt variables are updated as well.
+// All values go through the filter bank (s. below) first.
+// One conversion takes 13 ADC clocks at 250kHz = 52us, one scan of all
+// channels about 416us.
+
+static adc_snapshot_t adc_buffer[2];
+static volatile uint8_t adc_front;
+static volatile uint8_t adc_scan_channel;
+volatile uint8_t adc_scanner_running;
+
+static volatile uint16_t adc_sample_count[ADC_CHANNELS];
+static volatile uint16_t adc_sample_rate[ADC_CHANNELS];
+static volatile uint16_t adc_rate_timer;
+
+/*****************************************************************************/
+// ADC filter bank:
+
+// Every channel has its own filter which runs in the ADC interrupt.
+// All filters use integer math only and take a fixed number of cycles:
+//
+// ADC_FILTER_MEDIAN3    - median of the last 3 samples, removes single
+//                         spikes (e.g. servo PWM switching noise).
+// ADC_FILTER_EMA        - exponential moving average:
+//                         y += (x - y) / 2^shift  (shift 0..6)
+// ADC_FILTER_OVERSAMPLE - sums 4^shift samples and returns the sum / 2^shift,
+//                         which is a (10 + shift) bit value (shift 0..3).
+//                         The output changes only every 4^shift samples.
+//
+// MEDIAN3 can be combined with one of the others, it is applied first.
+
+static adc_filter_t adc_filter[ADC_CHANNELS] = {
+	{ADC_FILTER_MEDIAN3 | ADC_FILTER_EMA, 2},	// Current 1
+	{ADC_FILTER_MEDIAN3 | ADC_FILTER_EMA, 2},	// Current 2
+	{ADC_FILTER_MEDIAN3 | ADC_FILTER_EMA, 2},	// Current 3
+	{ADC_FILTER_MEDIAN3 | ADC_FILTER_EMA, 2},	// Current 4
+	{ADC_FILTER_MEDIAN3 | ADC_FILTER_EMA, 2},	// Current 5
+	{ADC_FILTER_MEDIAN3 | ADC_FILTER_EMA, 2},	// Current 6
+	{ADC_FILTER_EMA, 5},						// UBAT
+	{ADC_FILTER_NONE, 0}						// EXT ADC
+};
+
+static inline uint16_t median3(uint16_t a, uint16_t b, uint16_t c)
+{
+	uint16_t t;
+	if(a > b) {
+		t = a; a = b; b = t;
+	}
+	if(b > c)
+		b = (a > c) ? a : c;
+	return b;
+}
+
+/**
+ * Feeds one sample into the filter and returns the filter output.
+ */
+static inline uint16_t filterADC(adc_filter_t *f, uint16_t x)
+{
+	uint8_t mode = f->mode;
+
+	if(mode & ADC_FILTER_MEDIAN3) {
+		uint16_t m = median3(f->hist[0], f->hist[1], x);
+		f->hist[0] = f->hist[1];
+		f->hist[1] = x;
+		x = m;
+	}
+	if(mode & ADC_FILTER_EMA) {
+		if(!f->count) {		// first sample - no history yet
+			f->acc = x << f->shift;
+			f->count = 1;
+		}
+		else
+			f->acc += x - (f->acc >> f->shift);
+		f->out = f->acc >> f->shift;
+	}
+	else if(mode & ADC_FILTER_OVERSAMPLE) {
+		f->acc += x;
+		if(++f->count >= (1 << (2 * f->shift))) {
+			f->out = f->acc >> f->shift;
+			f->acc = 0;
+			f->count = 0;
+		}
+	}
+	else
+		f->out = x;
+	return f->out;
+}
+
+static inline uint8_t filterBits(adc_filter_t *f)
+{
+	if(!(f->mode & ADC_FILTER_EMA) && (f->mode & ADC_FILTER_OVERSAMPLE))
+		return f->shift;
+	return 0;
+}
+
+/**
+ * Changes the filter of an ADC channel - s. ADC_FILTER_xxx above.
+ * shift is limited to 6 for EMA and 3 for OVERSAMPLE. The filter state
+ * is reset.
+ *
+ * Example:
+ *
+ *			// 12 bit battery voltage, 16 samples per value:
+ *			setADCFilter(ADC_UBAT, ADC_FILTER_OVERSAMPLE, 2);
+ *			// Faster current measurement for servo 3:
+ *			setADCFilter(ADC_CURRENT_3, ADC_FILTER_MEDIAN3 | ADC_FILTER_EMA, 1);
+ */
+void setADCFilter(uint8_t channel, uint8_t mode, uint8_t shift)
+{
+	adc_filter_t *f = &adc_filter[channel & (ADC_CHANNELS - 1)];
+
+	if((mode & ADC_FILTER_EMA) && shift > 6)
+		shift = 6;
+	else if(!(mode & ADC_FILTER_EMA) && (mode & ADC_FILTER_OVERSAMPLE) && shift > 3)
+		shift = 3;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		f->mode = mode;
+		f->shift = shift;
+		f->acc = 0;
+		f->count = 0;
+		f->hist[0] = f->hist[1] = f->out;
+	}
+}
+
+/**
+ * Number of extra bits the filter output of the channel has
+ * (only ADC_FILTER_OVERSAMPLE adds extra bits).
+ */
+uint8_t getADCFilterBits(uint8_t channel)
+{
+	return filterBits(&adc_filter[channel & (ADC_CHANNELS - 1)]);
+}
+
+/*****************************************************************************/
+// Overcurrent protection:
+
+// Checked in the ADC interrupt for every filtered current sample, so a
+// stalled servo is detected within one scan (~0.4ms) after its window
+// has run out - no matter what the main program does.
+// For every servo the number of samples above its limit is counted
+// (and decremented again for samples below the limit). If the count
+// reaches the window, the servo trips:
+//  OC_FREEZE   - the servo ignores all further Move/s_Move commands
+//  OC_BACKOFF  - the servo is moved OC_BACKOFF_STEPS back against the
+//                direction of its last movement. Its move (and the
+//                synchronized move and waypoint queue it belongs to) is
+//                stopped. This is done in the next 1ms step of the
+//                Timer 2 interrupt, the ADC interrupt may interrupt the
+//                motion engine.
+// If the sum of all currents is above the global limit for its window:
+//  OC_POWER_OFF - the servo power is switched off (the arm falls down!)
+// The first fault is stored until clearOvercurrentFault() is called.
+
+static uint16_t oc_limit[6] = {
+#if ROBOT_ARM_V3
+	max_current_servo1_v3, max_current_servo2_v3, max_current_servo3_v3,
+	max_current_servo4_v3, max_current_servo5_v3, max_current_servo6_v3
+#else
+	max_current_servo1, max_current_servo2, max_current_servo3,
+	max_current_servo4, max_current_servo5, max_current_servo6
+#endif
+};
+static uint8_t oc_window[6] = {
+	OC_DEFAULT_WINDOW, OC_DEFAULT_WINDOW, OC_DEFAULT_WINDOW,
+	OC_DEFAULT_WINDOW, OC_DEFAULT_WINDOW, OC_DEFAULT_WINDOW
+};
+static uint8_t oc_count[6];
+static uint16_t oc_global_limit = OC_DEFAULT_GLOBAL_LIMIT;
+static uint8_t oc_global_window = OC_DEFAULT_WINDOW;
+static uint8_t oc_global_count;
+static uint16_t oc_sum;
+static uint8_t oc_action = OC_FREEZE | OC_BACKOFF;
+
+volatile uint8_t servo_frozen;		// bit 0 = servo 1
+static volatile uint8_t oc_backoff;	// servos to move back, bit 0 = servo 1
+static int8_t servo_direction[6];	// direction of the last movement
+
+static volatile overcurrent_fault_t oc_fault;
+
+static inline volatile uint16_t *servoRegister(uint8_t servo)
+{
+	switch(servo) {
+		case 1: return &Pos_Servo_1;
+		case 2: return &Pos_Servo_2;
+		case 3: return &Pos_Servo_3;
+		case 4: return &Pos_Servo_4;
+		case 5: return &Pos_Servo_5;
+		default: return &Pos_Servo_6;
+	}
+}
+
+static void tripOvercurrent(uint8_t joint, uint16_t current, uint16_t limit)
+{
+	if(!oc_fault.active) {
+		oc_fault.joint = joint;
+		oc_fault.current = current;
+		oc_fault.limit = limit;
+		oc_fault.adc_seq = adc_buffer[adc_front].seq;
+	}
+	oc_fault.trips++;
+	if(joint) {
+		uint8_t mask = 1 << (joint - 1);
+		oc_fault.active |= mask;
+		if(oc_action & OC_FREEZE)
+			servo_frozen |= mask;
+		if(oc_action & OC_BACKOFF)
+			oc_backoff |= mask;		// s. task_overcurrent_backoff
+	}
+	else {
+		oc_fault.active |= OC_FAULT_GLOBAL;
+		if(oc_action & OC_POWER_OFF)
+			Power_Off_Servos();
+	}
+}
+
+static inline void checkOvercurrent(uint8_t channel, uint16_t current)
+{
+	if(current > oc_limit[channel]) {
+		if(++oc_count[channel] >= oc_window[channel]) {
+			oc_count[channel] = 0;
+			tripOvercurrent(channel + 1, current, oc_limit[channel]);
+		}
+	}
+	else if(oc_count[channel])
+		oc_count[channel]--;
+
+	oc_sum += current;
+	if(channel == ADC_CURRENT_6) {
+		if(oc_sum > oc_global_limit) {
+			if(++oc_global_count >= oc_global_window) {
+				oc_global_count = 0;
+				tripOvercurrent(0, oc_sum, oc_global_limit);
+			}
+		}
+		else if(oc_global_count)
+			oc_global_count--;
+		oc_sum = 0;
+	}
+}
+
+/**
+ * Moves the servos back that tripped with OC_BACKOFF. Called every ms
+ * from the Timer 2 interrupt before the motion engine.
+ */
+static inline void task_overcurrent_backoff(void)
+{
+	uint8_t servo, mask;
+
+	if(!oc_backoff)
+		return;
+	for(servo = 1, mask = 1; servo <= 6; servo++, mask <<= 1) {
+		if(!(oc_backoff & mask))
+			continue;
+		abortServoMotion(servo);
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			*servoRegister(servo) -= servo_direction[servo - 1] * OC_BACKOFF_STEPS;
+			servo_direction[servo - 1] = 0;
+			oc_backoff &= ~mask;
+		}
+	}
+}
+
+/**
+ * Sets the current limit (10 bit ADC value, s. max_current_servoN_v3 or
+ * max_current_servoN for board revision 2)
+ * and the window (number of samples, one sample per ~0.4ms) of a servo.
+ *
+ * Example:
+ *
+ *			// Gripper may draw more current for 10 samples:
+ *			setOvercurrentLimit(1, 200, 10);
+ */
+void setOvercurrentLimit(uint8_t servo, uint16_t limit, uint8_t window)
+{
+	if(servo < 1 || servo > 6)
+		return;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		oc_limit[servo - 1] = limit;
+		oc_window[servo - 1] = window ? window : 1;
+	}
+}
+
+/**
+ * Sets the limit for the sum of all six currents.
+ */
+void setOvercurrentGlobalLimit(uint16_t limit, uint8_t window)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		oc_global_limit = limit;
+		oc_global_window = window ? window : 1;
+	}
+}
+
+/**
+ * Selects what happens if a limit is exceeded: any combination of
+ * OC_FREEZE, OC_BACKOFF and OC_POWER_OFF. 0 only records the fault.
+ */
+void setOvercurrentAction(uint8_t action)
+{
+	oc_action = action;
+}
+
+/**
+ * Copies the fault record. fault->active is 0 if nothing has tripped.
+ */
+void getOvercurrentFault(overcurrent_fault_t *fault)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		*fault = *(overcurrent_fault_t *)&oc_fault;
+	}
+}
+
+/**
+ * Clears the fault record and unfreezes all servos. The trip counter is
+ * kept.
+ */
+void clearOvercurrentFault(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		oc_fault.active = 0;
+		servo_frozen = 0;
+	}
+}
+
+ISR(ADC_vect)
+{
+	ISR_STATS_ENTER();
+	uint8_t channel = adc_scan_channel;
+	uint16_t value = ADC;
+	uint8_t back = adc_front ^ 1;
+	adc_filter_t *f = &adc_filter[channel];
+
+	// Start the next conversion first - the ADC can work while we store
+	// the result:
+	if(channel < ADC_CHANNELS - 1)
+		adc_scan_channel = channel + 1;
+	else
+		adc_scan_channel = 0;
+	ADMUX = (1<<REFS0) | (0<<REFS1) | (adc_scan_channel<<MUX0);
+	ADCSRA |= (1<<ADSC);
+
+	value = filterADC(f, value);
+	adc_buffer[back].value[channel] = value;
+	adc_sample_count[channel]++;
+	value >>= filterBits(f);	// the old variables always have 10 bit
+	if(channel <= ADC_CURRENT_6)
+		checkOvercurrent(channel, value);
+	switch(channel) {
+		case ADC_CURRENT_1: Current_1 = value; break;
+		case ADC_CURRENT_2: Current_2 = value; break;
+		case ADC_CURRENT_3: Current_3 = value; break;
+		case ADC_CURRENT_4: Current_4 = value; break;
+		case ADC_CURRENT_5: Current_5 = value; break;
+		case ADC_CURRENT_6: Current_6 = value; break;
+		case ADC_UBAT: adcUBat = value; break;
+		case ADC_EXT_ADC:
+			adcExt = value;
+			adc_buffer[back].seq = adc_buffer[back ^ 1].seq + 1;
+			adc_front = back;
+			break;
+	}
+	ISR_STATS_LEAVE(ISR_STAT_ADC);
+}
+
+/**
+ * Called once per millisecond from the Timer 2 interrupt, latches the
+ * number of samples per channel every second.
+ */
+static inline void task_ADC_rate(void)
+{
+	uint8_t i;
+	if(++adc_rate_timer >= 1000) {
+		adc_rate_timer = 0;
+		for(i = 0; i < ADC_CHANNELS; i++) {
+			adc_sample_rate[i] = adc_sample_count[i];
+			adc_sample_count[i] = 0;
+		}
+	}
+}
+
+/**
+ * Starts the interrupt driven ADC scanner. This is done by initRobotBase()
+ * already. While the scanner is running task_ADC() & co. do nothing and
+ * readADC() returns the last value of the scanner, so old programs still
+ * work - but they don't need to poll anymore.
+ */
+void startADCScanner(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		adc_scan_channel = 0;
+		adc_scanner_running = true;
+		ADMUX = (1<<REFS0) | (0<<REFS1) | (ADC_CURRENT_1<<MUX0);
+		ADCSRA = (1<<ADIE) | (1<<ADSC) | (1<<ADEN) | (1<<ADPS2) | (1<<ADPS1) | (0<<ADPS0) | (1<<ADIF);
+	}
+}
+
+/**
+ * Stops the ADC scanner after the current conversion, e.g. to use readADC
+ * with a different reference voltage.
+ */
+void stopADCScanner(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ADCSRA &= ~(1<<ADIE);
+		adc_scanner_running = false;
+	}
+	while(ADCSRA & (1<<ADSC));
+	ADCSRA = 0;
+	current_adc_channel = 255;
+}
+
+/**
+ * Copies the last complete scan of all 8 channels. The seq member is
+ * incremented for every scan, so you can check if there is new data.
+ *
+ * Example:
+ *
+ *			adc_snapshot_t adc;
+ *			getADCSnapshot(&adc);
+ *			if(adc.seq != last_seq) {
+ *				last_seq = adc.seq;
+ *				writeInteger(adc.value[ADC_UBAT], DEC);
+ *			}
+ */
+void getADCSnapshot(adc_snapshot_t *snapshot)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		*snapshot = adc_buffer[adc_front];
+	}
+}
+
+/**
+ * Returns the number of samples of the channel during the last second.
+ */
+uint16_t getADCSampleRate(uint8_t channel)
+{
+	uint16_t rate;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		rate = adc_sample_rate[channel & (ADC_CHANNELS - 1)];
+	}
+	return rate;
+}
+
 /**
  * This functions checks all ADC channels sequentially in the background!
  * It can save a lot of time, if the ADC channels are checked like this, because
@@ -471,6 +912,8 @@ uint8_t current_adc_channel = 255; // 255 = inital run
  */
 void task_ADC(void)
 {
+	if(adc_scanner_running)
+		return;
 	if(!(ADCSRA & (1<<ADSC))) {
 	//	ADCSRA |= (1<<ADIF);
 		switch(current_adc_channel) {
@@ -496,6 +939,8 @@ void task_ADC(void)
  */ 
 void task_ADC_average(void)
 {
+	if(adc_scanner_running)
+		return;
 	if(!(ADCSRA & (1<<ADSC))) {
 	//	ADCSRA |= (1<<ADIF);
 		switch(current_adc_channel) {
@@ -522,6 +967,8 @@ void task_ADC_average(void)
  */ 
 void task_ADC_channel(uint8_t channel)
 {
+	if(adc_scanner_running)
+		return;
 	if(!(ADCSRA & (1<<ADSC))) {
 	//	ADCSRA |= (1<<ADIF);
 		switch(current_adc_channel) {
@@ -583,124 +1030,88 @@ uint16_t calc_current(uint16_t adc_value_ext_ref)
 
 // Write to EEPROM adress. 
 // Warning: Bytes 0 + 1 are reserved for the Bootloader (autostart)
+// Waits until a record of the record store is written (s. RobotArmEEPROM.c).
 void writeINTEE(uint8_t adr, uint8_t data)
 {
+	waitEEStore();
 	eeprom_busy_wait();
 	EEAR = adr;
 	EEDR = data;
-	EECR |= (1<<EEMWE);
-	EECR |= (1<<EEWE);
+	// EEWE must follow EEMWE within 4 clock cycles - no interrupt in between:
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		EECR |= (1<<EEMWE);
+		EECR |= (1<<EEWE);
+	}
 }
 
 // Read from internal EEPROM
 uint8_t readINTEE(uint8_t adr)
 {
+	waitEEStore();
 	eeprom_busy_wait();	
 	EEAR = adr;
 	EECR |= (1<<EERE);
 	return EEDR;
-	return 0;
 }
 
 
-// Declare storage areas for EEPROM
-//	VALUE EEMEM ee_DEFAULT;
-//uint16_t EEMEM ee_Start_Position[7];
-
-
 // Write default values from servos, to the EEPROM.
-// Warning: Bytes 0 + 1 are reserved for the Bootloader (autostart)
+// The values are saved in the calibration record of the record store
+// (s. RobotArmEEPROM.c). This function does not wait, the EEPROM is written
+// in the background while the program goes on.
 void write_Values_EE (void){
-
-// Write Values to specific locations:
-  writeINTEE(2, Start_Position[1] & 0xFF);
-  writeINTEE(3, (Start_Position[1] >> 8) & 0xFF);
-  writeINTEE(4, Start_Position[2] & 0xFF);
-  writeINTEE(5, (Start_Position[2] >> 8) & 0xFF);
-  writeINTEE(6, Start_Position[3] & 0xFF);
-  writeINTEE(7, (Start_Position[3] >> 8) & 0xFF);
-  writeINTEE(8, Start_Position[4] & 0xFF);
-  writeINTEE(9, (Start_Position[4] >> 8) & 0xFF);
-  writeINTEE(10, Start_Position[5] & 0xFF);
-  writeINTEE(11, (Start_Position[5] >> 8) & 0xFF);
-  writeINTEE(12, Start_Position[6] & 0xFF);
-  writeINTEE(13, (Start_Position[6] >> 8) & 0xFF);
-  
-
-	// To write EEPROM from SRAM
-//	eeprom_write_block((const void *)&Start_Position,(void *)&ee_Start_Position, sizeof(Start_Position));
+	waitEEStore();		// a previous record
+	saveRecord(EE_AREA_CALIBRATION, &Start_Position[1], EE_CALIBRATION_SIZE);
 }
 
 // Read default values from servos, from the EEPROM 
+// Uses the calibration record or - if there is none - the values that
+// older library versions stored in the bytes 2..13. Blank or invalid
+// values are replaced by the middle position.
 void Read_Values_EE (void){
+	uint16_t values[6];
+	uint8_t i;
 
-	// To read EEPROM back to SRAM
-//	eeprom_read_block((void *)&Start_Position, (const void*)&ee_Start_Position, sizeof(Start_Position));
-
-  Start_Position[1] = readINTEE(2) | (readINTEE(3) << 8);
-  Start_Position[2] = readINTEE(4) | (readINTEE(5) << 8);
-  Start_Position[3] = readINTEE(6) | (readINTEE(7) << 8);
-	Start_Position[4] = readINTEE(8) | (readINTEE(9) << 8);
-  Start_Position[5] = readINTEE(10) | (readINTEE(11) << 8);
-  Start_Position[6] = readINTEE(12) | (readINTEE(13) << 8);
-	
-	if(Start_Position[1]  == -1)  Start_Position[1] = 1500;  
-	if(Start_Position[2]  == -1)  Start_Position[2] = 1500;  
-	if(Start_Position[3]  == -1)  Start_Position[3] = 1500;  
-	if(Start_Position[4]  == -1)  Start_Position[4] = 1500;  
-	if(Start_Position[5]  == -1)  Start_Position[5] = 1500;  
-	if(Start_Position[6]  == -1)  Start_Position[6] = 1500;  
+	if(loadRecord(EE_AREA_CALIBRATION, values, sizeof(values)) != EE_OK) {
+		for(i = 0; i < 6; i++)
+			values[i] = readINTEE(2 + 2 * i) | (readINTEE(3 + 2 * i) << 8);
+	}
+	for(i = 0; i < 6; i++) {
+		if(values[i] < START_POSITION_MIN || values[i] > START_POSITION_MAX)
+			values[i] = START_POSITION_DEFAULT;
+		Start_Position[i + 1] = values[i];
+	}
 
 	Start_position(); 	
 }
 
 
 /*****************************************************************************/
-// Power off servo's 
-void Power_Servos (void)
-{
-  if(robot_arm_v3) 
-  {
-    PORTG |= SERVO_POWER_v3;
-  }
-  else
-  {
-    PORTG &=~SERVO_POWER;
-  }
-}
-
-/*****************************************************************************/
-// Power off servo's 
-
-void Power_Off_Servos (void)
+// The start position functions set absolute PWM values. Like Move() they
+// stop the motion engine for the servo first and write the register with
+// disabled interrupts - the motion engine writes the same registers in
+// the Timer 2 interrupt.
+static void setServoPWM(uint8_t servo, uint16_t pwm)
 {
-  if(robot_arm_v3) 
-  {
-    PORTG &=~ SERVO_POWER_v3;
-    
-  }
-  else
-  {
-    PORTG |= SERVO_POWER;
-  }
+	stopServoMotion(servo);
+	setServoOffset(servo, pwm - Start_Position[servo]);
 }
 
-
 /*****************************************************************************/
 // Set servo motors in normal position
 void Start_position(void)
 {
-	Pos_Servo_1=Start_Position [1];
+	setServoPWM(1, Start_Position[1]);
 	mSleep(100);
-	Pos_Servo_2=Start_Position [2];
+	setServoPWM(2, Start_Position[2]);
 	mSleep(100);
-	Pos_Servo_3=Start_Position [3];
+	setServoPWM(3, Start_Position[3]);
 	mSleep(50);
-	Pos_Servo_4=Start_Position [4];
+	setServoPWM(4, Start_Position[4]);
 	mSleep(50);
-	Pos_Servo_5=Start_Position [5];
+	setServoPWM(5, Start_Position[5]);
 	mSleep(50);
-	Pos_Servo_6=Start_Position [6];
+	setServoPWM(6, Start_Position[6]);
 	mSleep(50);
 }
 
@@ -708,30 +1119,33 @@ void Start_position(void)
 // Default (uncalibrated) start position
 void Default_Start_position(void)
 {
-	Pos_Servo_1=1000;
+	setServoPWM(1, 1000);
 	mSleep(100);
-	Pos_Servo_2=1000;
+	setServoPWM(2, 1000);
 	mSleep(100);
-	Pos_Servo_3=1000;
+	setServoPWM(3, 1000);
 	mSleep(50);
-	Pos_Servo_4=1000;
+	setServoPWM(4, 1000);
 	mSleep(50);
-	Pos_Servo_5=1000;
+	setServoPWM(5, 1000);
 	mSleep(50);
-	Pos_Servo_6=1000;
+	setServoPWM(6, 1000);
 	mSleep(50);
 }
 
 /*****************************************************************************/
 // Set all Servo PWM values to 0
+// This switches the servo signals off, so it also works for servos frozen
+// by the overcurrent protection.
 void Servo_PWM_Zero(void)
 {
-	Pos_Servo_1=0;
-	Pos_Servo_2=0;
-	Pos_Servo_3=0;
-	Pos_Servo_4=0;
-	Pos_Servo_5=0;
-	Pos_Servo_6=0;
+	uint8_t servo;
+
+	stopMotion();
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for(servo = 1; servo <= 6; servo++)
+			*servoRegister(servo) = 0;
+	}
 }
 
 /*****************************************************************************/
@@ -743,17 +1157,17 @@ void Servo_Power_And_Start(void)
 	Servo_PWM_Zero();
 	Power_Servos();
 	mSleep(250); 
-	Pos_Servo_1=Start_Position[1];
+	setServoPWM(1, Start_Position[1]);
 	mSleep(100);
-	Pos_Servo_2=Start_Position[2];
+	setServoPWM(2, Start_Position[2]);
 	mSleep(100);
-	Pos_Servo_3=Start_Position[3];
+	setServoPWM(3, Start_Position[3]);
 	mSleep(50);
-	Pos_Servo_4=Start_Position[4];
+	setServoPWM(4, Start_Position[4]);
 	mSleep(50);
-	Pos_Servo_5=Start_Position[5];
+	setServoPWM(5, Start_Position[5]);
 	mSleep(50);
-	Pos_Servo_6=Start_Position[6];
+	setServoPWM(6, Start_Position[6]);
 	mSleep(50);
 }
 
@@ -764,34 +1178,64 @@ void Servo_Power_And_Start_Default(void)
 	Servo_PWM_Zero();
 	Power_Servos();
 	mSleep(250); 
-	Pos_Servo_1=1600;
+	setServoPWM(1, 1600);
 	mSleep(100);
-	Pos_Servo_2=1500;
+	setServoPWM(2, 1500);
 	mSleep(100);
-	Pos_Servo_3=1500;
+	setServoPWM(3, 1500);
 	mSleep(50);
-	Pos_Servo_4=1500;
+	setServoPWM(4, 1500);
 	mSleep(50);
-	Pos_Servo_5=1500;
+	setServoPWM(5, 1500);
 	mSleep(50);
-	Pos_Servo_6=1500;
+	setServoPWM(6, 1500);
 	mSleep(50);
 }        
 
+/*****************************************************************************/
+// Servo PWM
+
+/**
+ * Sets the PWM value of a servo to Start_Position + offset. This is the
+ * low level function used by Move and the motion engine.
+ * Servos that were stopped by the overcurrent protection are not moved.
+ * The 16 bit PWM registers are written with interrupts disabled because
+ * the overcurrent protection may change them in the ADC interrupt.
+ */
+void setServoOffset(uint8_t servo, int16_t offset)
+{
+	volatile uint16_t *reg;
+	uint16_t pwm;
+
+	if (servo < 1 || servo > 6 || isServoFrozen(servo))
+		return;
+	reg = servoRegister(servo);
+	pwm = Start_Position[servo] + offset;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if (pwm != *reg)
+			servo_direction[servo - 1] = (pwm > *reg) ? 1 : -1;
+		*reg = pwm;
+	}
+}
+
+/**
+ * Returns the current PWM value of a servo minus its Start_Position.
+ */
+int16_t getServoOffset(uint8_t servo)
+{
+	if (servo < 1 || servo > 6)
+		return 0;
+	return *servoRegister(servo) - Start_Position[servo];
+}
+
 /*****************************************************************************/
 // Move Servo's 
 
+// Sets the servo immediately. Stops the motion engine for this servo.
 void Move (uint8_t Servo, uint16_t Value) 
 {
-	switch (Servo) 
-	{
-  	case 1:	Pos_Servo_1 = Start_Position[1] + Value; break; 
-  	case 2:	Pos_Servo_2 = Start_Position[2] + Value; break; 
-  	case 3:	Pos_Servo_3 = Start_Position[3] + Value; break; 
-  	case 4:	Pos_Servo_4 = Start_Position[4] + Value; break; 
-  	case 5:	Pos_Servo_5 = Start_Position[5] + Value; break; 
-  	case 6:	Pos_Servo_6 = Start_Position[6] + Value; break; 
-	}
+	stopServoMotion(Servo);
+	setServoOffset(Servo, Value);
 }
 
 
@@ -803,112 +1247,38 @@ void Move (uint8_t Servo, uint16_t Value)
 *		1 - Servo 6
 *		2 - (Startpostion + 500) = 2ms (right)
 *		3 - (speed = 2) 
+*
+* This is a blocking function - it uses the motion engine (s. moveTo in
+* RobotArmMotion.c) and waits until the servo has arrived. Use moveTo
+* directly to move several servos at the same time.
 */
 void s_Move (uint8_t Servo, int16_t D_Value, uint16_t Speed) 
 {
-	int16_t Actual_position=2700;  
-	uint8_t move_servo1_back = 0;
-	switch (Servo) 
-	{
-	case 1:	Actual_position = Pos_Servo_1 - Start_Position[1]; break; 
-	case 2:	Actual_position = Pos_Servo_2 - Start_Position[2]; break; 
-	case 3:	Actual_position = Pos_Servo_3 - Start_Position[3]; break; 
-	case 4:	Actual_position = Pos_Servo_4 - Start_Position[4]; break; 
-	case 5:	Actual_position = Pos_Servo_5 - Start_Position[5]; break; 
-	case 6:	Actual_position = Pos_Servo_6 - Start_Position[6]; break; 
+	int16_t Actual_position;
+	int16_t back = 0;
+
+	if (Servo < 1 || Servo > 6)
+		return;
+	Actual_position = getServoPosition(Servo);
+	if (Servo == 1)		// Gripper Servo?
+	{	
+		// Move it backwards a little after the move to reduce current 
+		// consumption with closed gripper
+		if (Actual_position - D_Value >= 40)
+			back = 50;
+		else if (D_Value - Actual_position >= 30)
+			back = -30;
 	}
-	move_servo1_back = 0;
-	if (Actual_position > D_Value )
-	{ 
-    if(Servo == 1 && (Actual_position - D_Value) >= 40)   // Gripper Servo? 
-    {                                              // Difference > 40 ?        
-        move_servo1_back = 1;
-    }
-		while (Actual_position > D_Value)
-		{
-			Actual_position--; 
-			Move(Servo, Actual_position);
-			
-    	//	mSleep(Speed);
-    		// Instead of mSleep, perform ADC readings while waiting:
-    		setStopwatch8(0);
-    		startStopwatch8();
-    		while(getStopwatch8() < Speed)
-    		{
-    			task_ADC();
-    		}
-    		stopStopwatch8();
-		}
-    if(move_servo1_back)     // Gripper Servo? 
-    {                  // Move it backwards a little to reduce current consumption 
-                       // with closed gripper     
-                       
-        while (Actual_position < (D_Value+50))
-    		{
-    			Actual_position++; 
-          if(Actual_position < 500 && Actual_position > -500)
-            Move(Servo, Actual_position);
-                     /*
-    			writeString_P("SERVO1-POS:"); 
-          writeInteger(Actual_position, DEC);
-          writeString_P("\n");    */
-        	//	mSleep(Speed);
-        		// Instead of mSleep, perform ADC readings while waiting:
-        		setStopwatch8(0);
-        		startStopwatch8();
-        		while(getStopwatch8() < Speed+2)
-        		{
-        			task_ADC();
-        		}
-        		stopStopwatch8();
-    		}
-        	
-    }
-		return; 
+	moveTo(Servo, D_Value, Speed);
+	waitForServo(Servo);
+	if (back)
+	{
+		D_Value += back;
+		if (D_Value >= 500) D_Value = 499;
+		if (D_Value <= -500) D_Value = -499;
+		moveTo(Servo, D_Value, (back > 0) ? Speed + 2 : Speed);
+		waitForServo(Servo);
 	}
-  
-  move_servo1_back = 0;
-	if (Actual_position < D_Value )
-	{ 
-    if(Servo == 1 && (D_Value - Actual_position) >= 30)   // Gripper Servo? 
-    {                                              // Difference > 30 ?      
-        move_servo1_back = 1;
-    }
-		while (Actual_position < D_Value)
-		{
-			Actual_position++; 
-			Move(Servo, Actual_position);
-			
-			//	mSleep(Speed);
-    		// Instead of mSleep, perform ADC readings while waiting:
-    		setStopwatch8(0);
-    		startStopwatch8();
-    		while(getStopwatch8() < Speed)
-    		{
-    			task_ADC();
-    		}
-    		stopStopwatch8();
-		}
-    if(move_servo1_back)     // Gripper Servo? 
-    {                  // Move it backwards a little to reduce current consumption 
-        while (Actual_position > (D_Value-30))
-    		{
-    			Actual_position--; 
-          if(Actual_position < 500 && Actual_position > -500)
-            Move(Servo, Actual_position);
-          
-        	//	mSleep(Speed);
-        		// Instead of mSleep, perform ADC readings while waiting:
-        		setStopwatch8(0);
-        		startStopwatch8();
-        		while(getStopwatch8() < Speed)
-        		{
-        			task_ADC();
-        		}
-        		stopStopwatch8();
-    		}
-    }
-	}	
 }
 
 
@@ -963,46 +1333,40 @@ void initRobotBase(void)
 	/****************************************************************************/
 	// Setup port directions and initial values.
 	// THIS IS THE MOST IMPORTANT STEP!
-	if(robot_arm_v3)
+	// Only the pinout of the board revision selected at build time is
+	// compiled (ROBOT_ARM_REVISION, make BOARD_REV=2 for the older PCBs).
+	initPorts();
+	if(robot_arm_v3 != ROBOT_ARM_V3)
 	{
-    portInit_v3();
-	}
-	else
-	{
-	   portInit();
-	   writeString_P("\n\n#############################################################\n");
-	   writeString_P("ERROR: This program is intended for the new Robot ARM v3 PCB!\n");
-		 writeString_P("For older revisions you need the old example programs!\n");
-		 writeString_P("#############################################################\n\n");
-		 while(true)
-     {
-       delay_ms(200);
-       PowerLEDred();
-       delay_ms(100);
-       PowerLEDoff();
-     }
-     	// Note: 
-      // The software is in principle compatible with the older PCBs. 
-     	// Current sensing is different, crystal oscillator is slightly different, 
-      // the pinout is also a bit different. 
-     	// There are also more LEDs on the v3 PCB.
-     	// But you may change this library to operate with the older PCBs as well!
+		// Wrong PCB for this build - the pinout does not match:
+		writeString_P("\n\n#############################################################\n");
+#if ROBOT_ARM_V3
+		writeString_P("ERROR: This program is intended for the new Robot ARM v3 PCB!\n");
+		writeString_P("For older revisions build it with BOARD_REV=2!\n");
+#else
+		writeString_P("ERROR: This program is built for the older PCBs (BOARD_REV=2)!\n");
+		writeString_P("For the Robot ARM v3 PCB build it with BOARD_REV=3!\n");
+#endif
+		writeString_P("#############################################################\n\n");
+		while(true)
+		{
+			delay_ms(200);
+			PowerLEDred();
+			delay_ms(100);
+			PowerLEDoff();
+		}
 	}
+	// Note: 
+	// On the older PCBs current sensing is different, the crystal
+	// oscillator is slightly different and there are less LEDs.
 
 	
 	Power_Off_Servos();
 	/*****************************************************************************/
 	// setADC
-	// AVCC with external capacitor at AREF pin
-	ADMUX = (1<<REFS1)|(1<<REFS0)|(0<<ADLAR)|(0<<MUX4)|(0<<MUX3)|(0<<MUX2)|(0<<MUX1)|(0<<MUX0);
-	// ADC Enable, ADC Start Conversion, Auto Trigger Enable, Division Factor 8
-	
-	
-	//ADCSRA = (0<<ADEN)|(0<<ADSC)|(1<<ADATE)|(0<<ADPS2)|(1<<ADPS1)|(1<<ADPS0); 
-	ADCSRA = (0<<ADEN)|(0<<ADSC)|(1<<ADATE)|(1<<ADPS2)|(0<<ADPS1)|(0<<ADPS0); 
-	// Free Running mode
-	ADCSRB  = (0<<ADTS2)|(0<<ADTS1)|(0<<ADTS0);
-	//ADCSRA |= (1<<ADIF);
+	// AVCC as reference, all 8 channels are converted in the background
+	// by the ADC interrupt (s. startADCScanner).
+	startADCScanner();
 	
 
 	/*****************************************************************************/
@@ -1018,7 +1382,7 @@ void initRobotBase(void)
 	// Initialize Timer 2 -  100s cycle for Delays and Stopwatches:
 	TCCR2 =   (0 << WGM20) | (1 << WGM21) 	| (0 << COM20) | (0 << COM21) 
 			   | (0 << CS22)  | (1 << CS21) | (0 << CS20);	   
-	OCR2  = 204;
+	OCR2  = TIMER2_EXTRA ? TIMER2_TOP + 1 : TIMER2_TOP;	// 16MHz / 8 / (199 + 1) = 10kHz
 	
 
 	/*****************************************************************************/
@@ -1070,9 +1434,7 @@ void initRobotBase(void)
 
 	/*****************************************************************************/
 	// UART:
-	UBRR1H = UBRR_BAUD_LOW >> 8;	// Setup UART: Baudrate is Low Speed
-	UBRR1L = (uint8_t) UBRR_BAUD_LOW;
-	UCSR1A = 0x00;
+	setUARTBaudrate(UART_BAUD_38400);	// Setup UART: Baudrate is Low Speed
   UCSR1C = (1<<UCSZ11)|(1<<UCSZ10);
   UCSR1B = (1 << TXEN1) | (1 << RXEN1) | (1 << RXCIE1);
 	
@@ -1104,6 +1466,42 @@ void initRobotBase(void)
  * - v. 1.0 (initial release) 27.05.2010 by Huy Nguyen 
  *											Hein Wielink
  * - v. 2.0  30.04.2013 by AREXX
+ * - v. 2.1  17.10.2026: interrupt driven ADC scanner (startADCScanner,
+ *                       getADCSnapshot, getADCSampleRate)
+ *                     - fixed point ADC filter bank (setADCFilter)
+ *                     - overcurrent protection in the ADC interrupt
+ *                     - s_Move uses the new motion engine
+ *                     - sleep and mSleep run the cooperative scheduler
+ *                       while they wait
+ *                     - idle sleep mode and idle time measurement
+ *                     - Timer 2 runs at exactly 100s / 1ms (was 102.5s
+ *                       and 11 ticks per ms), software timers, stopwatches
+ *                       without work in the interrupt
+ *                     - 32 bit time base (millis32, micros32)
+ *                     - optional interrupt statistics (ISR_STATS)
+ *                     - stack guard check in the Timer 2 interrupt
+ *                     - board revision selected at build time
+ *                       (ROBOT_ARM_REVISION), check_board only checks it
+ *                     - LED, servo power and port init functions moved
+ *                       to RobotArmPins.cpp (C++ pin templates)
+ *                     - servo calibration in the CRC protected EEPROM
+ *                       record store, written in the background
+ *                       (RobotArmEEPROM.c). Read_Values_EE checks the
+ *                       range of the values (the -1 test never matched)
+ *                     - writeINTEE: EEMWE/EEWE timing with interrupts
+ *                     - overcurrent limits of the board revision
+ *                       (max_current_servoN for revision 2)
+ *                     - F_CPU, Timer 2 and the baudrates for the
+ *                       16.384MHz crystal of revision 2
+ *                     - the 1ms step of the Timer 2 interrupt runs with
+ *                       interrupts enabled (USART1 overruns at 500k)
+ *                     - Start_position & co. stop the motion engine and
+ *                       write the servo registers atomically
+ *                     - OC_BACKOFF stops the move of the servo (and its
+ *                       synchronized move) in the Timer 2 interrupt
+ *                     - readINTEE/writeINTEE declared in RobotArmBaseLib.h,
+ *                       the EEPROM record store starts behind their
+ *                       range at 0x100
  *
 * ****************************************************************************
  * Bugs, feedback, questions and modifications can be posted on the AREXX Forum
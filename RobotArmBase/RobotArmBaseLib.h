@@ -29,6 +29,7 @@
 #include "RobotArmBase.h"	// General Robot ARM Base definitions
 #include "RobotArmUart.h"		// Robotarm UART function lib
 #include <avr/eeprom.h> 
+#include <avr/sleep.h>
 #include <stdlib.h>
 #include <util/delay.h>
 
@@ -39,6 +40,7 @@ extern uint8_t robot_arm_v3;
 // Init:
 
 void initRobotBase(void);
+void initPorts(void);
 
 /*****************************************************************************/
 // Status LEDs
@@ -75,40 +77,38 @@ void setLED4(uint8_t led);
  */
 typedef struct {
 	volatile uint8_t watches;
-	volatile uint16_t watch1;
-	volatile uint16_t watch2;
-	volatile uint16_t watch3;
-	volatile uint16_t watch4;
-	volatile uint16_t watch5;
-	volatile uint16_t watch6;
-	volatile uint16_t watch7;
-	volatile uint16_t watch8;
+	volatile uint16_t watch[8];	// start time or value, s. getStopwatch
 } stopwatches_t;
 extern volatile stopwatches_t stopwatches;
 
-#define stopStopwatch1() stopwatches.watches &= ~STOPWATCH1
-#define stopStopwatch2() stopwatches.watches &= ~STOPWATCH2
-#define stopStopwatch3() stopwatches.watches &= ~STOPWATCH3
-#define stopStopwatch4() stopwatches.watches &= ~STOPWATCH4
-#define stopStopwatch5() stopwatches.watches &= ~STOPWATCH5
-#define stopStopwatch6() stopwatches.watches &= ~STOPWATCH6
-#define stopStopwatch7() stopwatches.watches &= ~STOPWATCH7
+void startStopwatch(uint8_t watch);
+void stopStopwatch(uint8_t watch);
+uint16_t getStopwatch(uint8_t watch);
+void setStopwatch(uint8_t watch, uint16_t value);
+
+#define stopStopwatch1() stopStopwatch(1)
+#define stopStopwatch2() stopStopwatch(2)
+#define stopStopwatch3() stopStopwatch(3)
+#define stopStopwatch4() stopStopwatch(4)
+#define stopStopwatch5() stopStopwatch(5)
+#define stopStopwatch6() stopStopwatch(6)
+#define stopStopwatch7() stopStopwatch(7)
 
 // Please note: Stopwatch 8 is used for ADC measurements quite often
 // in the examples and functions like s_Move()!
-#define stopStopwatch8() stopwatches.watches &= ~STOPWATCH8
+#define stopStopwatch8() stopStopwatch(8)
 
-#define startStopwatch1() stopwatches.watches |= STOPWATCH1
-#define startStopwatch2() stopwatches.watches |= STOPWATCH2
-#define startStopwatch3() stopwatches.watches |= STOPWATCH3
-#define startStopwatch4() stopwatches.watches |= STOPWATCH4
-#define startStopwatch5() stopwatches.watches |= STOPWATCH5
-#define startStopwatch6() stopwatches.watches |= STOPWATCH6
-#define startStopwatch7() stopwatches.watches |= STOPWATCH7
+#define startStopwatch1() startStopwatch(1)
+#define startStopwatch2() startStopwatch(2)
+#define startStopwatch3() startStopwatch(3)
+#define startStopwatch4() startStopwatch(4)
+#define startStopwatch5() startStopwatch(5)
+#define startStopwatch6() startStopwatch(6)
+#define startStopwatch7() startStopwatch(7)
 
 // Please note: Stopwatch 8 is used for ADC measurements quite often
 // in the examples and functions like s_Move()!
-#define startStopwatch8() stopwatches.watches |= STOPWATCH8
+#define startStopwatch8() startStopwatch(8)
 
 #define isStopwatch1Running() (stopwatches.watches & STOPWATCH1)
 #define isStopwatch2Running() (stopwatches.watches & STOPWATCH2)
@@ -122,35 +122,38 @@ extern volatile stopwatches_t stopwatches;
 // in the examples and functions like s_Move()!
 #define isStopwatch8Running() (stopwatches.watches & STOPWATCH8)
 
-#define getStopwatch1() stopwatches.watch1
-#define getStopwatch2() stopwatches.watch2
-#define getStopwatch3() stopwatches.watch3
-#define getStopwatch4() stopwatches.watch4
-#define getStopwatch5() stopwatches.watch5
-#define getStopwatch6() stopwatches.watch6
-#define getStopwatch7() stopwatches.watch7
+#define getStopwatch1() getStopwatch(1)
+#define getStopwatch2() getStopwatch(2)
+#define getStopwatch3() getStopwatch(3)
+#define getStopwatch4() getStopwatch(4)
+#define getStopwatch5() getStopwatch(5)
+#define getStopwatch6() getStopwatch(6)
+#define getStopwatch7() getStopwatch(7)
 
 // Please note: Stopwatch 8 is used for ADC measurements quite often
 // in the examples and functions like s_Move()!
-#define getStopwatch8() stopwatches.watch8
+#define getStopwatch8() getStopwatch(8)
 
-#define setStopwatch1(__VALUE__) stopwatches.watch1 = __VALUE__
-#define setStopwatch2(__VALUE__) stopwatches.watch2 = __VALUE__
-#define setStopwatch3(__VALUE__) stopwatches.watch3 = __VALUE__
-#define setStopwatch4(__VALUE__) stopwatches.watch4 = __VALUE__
-#define setStopwatch5(__VALUE__) stopwatches.watch5 = __VALUE__
-#define setStopwatch6(__VALUE__) stopwatches.watch6 = __VALUE__
-#define setStopwatch7(__VALUE__) stopwatches.watch7 = __VALUE__
+#define setStopwatch1(__VALUE__) setStopwatch(1, (__VALUE__))
+#define setStopwatch2(__VALUE__) setStopwatch(2, (__VALUE__))
+#define setStopwatch3(__VALUE__) setStopwatch(3, (__VALUE__))
+#define setStopwatch4(__VALUE__) setStopwatch(4, (__VALUE__))
+#define setStopwatch5(__VALUE__) setStopwatch(5, (__VALUE__))
+#define setStopwatch6(__VALUE__) setStopwatch(6, (__VALUE__))
+#define setStopwatch7(__VALUE__) setStopwatch(7, (__VALUE__))
 
 // Please note: Stopwatch 8 is used for ADC measurements quite often
 // in the examples and functions like s_Move()!
-#define setStopwatch8(__VALUE__) stopwatches.watch8 = __VALUE__
+#define setStopwatch8(__VALUE__) setStopwatch(8, (__VALUE__))
 
 
 
 /*****************************************************************************/
 // Delays
 
+extern volatile uint16_t delay_timer;	// 100us ticks, free running
+extern volatile uint8_t ms_timer;		// 100us ticks of the current ms
+
 void sleep(uint8_t time);
 void mSleep(uint16_t time);
 
@@ -179,12 +182,77 @@ int scan_keyboard(void);
 
 /*****************************************************************************/
 // ADC
-uint16_t Current_1; 
-uint16_t Current_2; 
-uint16_t Current_3; 
-uint16_t Current_4; 
-uint16_t Current_5; 
-uint16_t Current_6; 
+volatile uint16_t Current_1; 
+volatile uint16_t Current_2; 
+volatile uint16_t Current_3; 
+volatile uint16_t Current_4; 
+volatile uint16_t Current_5; 
+volatile uint16_t Current_6; 
+
+extern volatile uint16_t adcUBat;
+extern volatile uint16_t adcExt;
+
+#define ADC_CHANNELS 8
+
+typedef struct {
+	uint16_t seq;	// incremented with every complete scan
+	uint16_t value[ADC_CHANNELS];	// filter output, s. setADCFilter
+} adc_snapshot_t;
+
+#define ADC_FILTER_NONE			0
+#define ADC_FILTER_MEDIAN3		1
+#define ADC_FILTER_EMA			2
+#define ADC_FILTER_OVERSAMPLE	4
+
+typedef struct {
+	uint8_t mode;		// ADC_FILTER_xxx
+	uint8_t shift;		// EMA: 1/2^shift, OVERSAMPLE: extra bits
+	uint16_t hist[2];	// last two samples for MEDIAN3
+	uint16_t acc;		// EMA: output << shift, OVERSAMPLE: sum
+	uint8_t count;
+	uint16_t out;
+} adc_filter_t;
+
+void setADCFilter(uint8_t channel, uint8_t mode, uint8_t shift);
+uint8_t getADCFilterBits(uint8_t channel);
+
+extern volatile uint8_t adc_scanner_running;
+
+void startADCScanner(void);
+void stopADCScanner(void);
+void getADCSnapshot(adc_snapshot_t *snapshot);
+uint16_t getADCSampleRate(uint8_t channel);
+
+/*****************************************************************************/
+// Overcurrent protection
+
+#define OC_FREEZE		1	// stop the servo
+#define OC_BACKOFF		2	// move the servo back a little
+#define OC_POWER_OFF	4	// global overload: switch off servo power
+
+#define OC_DEFAULT_WINDOW		4		// samples
+#define OC_DEFAULT_GLOBAL_LIMIT	1000	// ~3A for all servos together
+#define OC_BACKOFF_STEPS		20
+
+#define OC_FAULT_GLOBAL	0x80	// bit in overcurrent_fault_t.active
+
+typedef struct {
+	uint8_t active;		// tripped servos (bit 0 = servo 1) + OC_FAULT_GLOBAL
+	uint8_t joint;		// first fault: servo 1..6 or 0 = global overload
+	uint16_t current;	// first fault: current (sum) at the trip
+	uint16_t limit;		// first fault: limit that was exceeded
+	uint16_t adc_seq;	// first fault: ADC scan number
+	uint16_t trips;		// number of trips since power on
+} overcurrent_fault_t;
+
+extern volatile uint8_t servo_frozen;
+#define isServoFrozen(__SERVO__) (servo_frozen & (1 << ((__SERVO__) - 1)))
+
+void setOvercurrentLimit(uint8_t servo, uint16_t limit, uint8_t window);
+void setOvercurrentGlobalLimit(uint16_t limit, uint8_t window);
+void setOvercurrentAction(uint8_t action);
+void getOvercurrentFault(overcurrent_fault_t *fault);
+void clearOvercurrentFault(void);
 
 uint16_t readADC (int channel);
 
@@ -197,11 +265,30 @@ void sampleADCs_average_and_sleep(uint16_t ms);
 
 uint16_t calc_current(uint16_t adc_value_ext_ref);
 
+/*****************************************************************************/
+// Internal EEPROM
+
+// readINTEE/writeINTEE reach the addresses 0x000..0x0FF:
+//  0, 1    - reserved for the bootloader (autostart)
+//  2..13   - servo calibration of library versions before 2.1
+//  14..255 - free for your own program
+// The EEPROM record store (calibration, poses and sequences, s.
+// RobotArmEEPROM.h) starts at EE_STORE_START = 0x100 and ends below E2END,
+// so it is never overwritten by writeINTEE.
+void writeINTEE(uint8_t adr, uint8_t data);
+uint8_t readINTEE(uint8_t adr);
+
 /*****************************************************************************/
 // Servo
 
 uint16_t  Start_Position[7];
 
+// Valid start positions (servo pulse in s), others are replaced by the
+// default when they are read from the EEPROM:
+#define START_POSITION_MIN		500
+#define START_POSITION_MAX		2500
+#define START_POSITION_DEFAULT	1500
+
 void write_Values_EE (void);
 void Read_Values_EE (void);
 void Power_Servos(void);
@@ -212,9 +299,52 @@ void Servo_Power_And_Start_Default(void);
 void Servo_PWM_Zero(void);
 void Servo_Power_And_Start(void);
 
+void setServoOffset(uint8_t servo, int16_t offset);
+int16_t getServoOffset(uint8_t servo);
+
 void Move (uint8_t Servo, uint16_t Value);
 void s_Move (uint8_t Servo, int16_t D_Value, uint16_t Speed);
 
+/*****************************************************************************/
+// Fixed point math
+
+#include "RobotArmMath.h"
+
+/*****************************************************************************/
+// Motion engine
+
+#include "RobotArmMotion.h"
+
+/*****************************************************************************/
+// Cooperative scheduler
+
+#include "RobotArmScheduler.h"
+
+/*****************************************************************************/
+// Software timers
+
+#include "RobotArmTimer.h"
+
+/*****************************************************************************/
+// Interrupt statistics (only with ISR_STATS)
+
+#include "RobotArmIsrStats.h"
+
+/*****************************************************************************/
+// SRAM and stack monitor
+
+#include "RobotArmMemory.h"
+
+/*****************************************************************************/
+// EEPROM record store
+
+#include "RobotArmEEPROM.h"
+
+/*****************************************************************************/
+// Pose library
+
+#include "RobotArmPoses.h"
+
 
 
 #endif
@@ -0,0 +1,327 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmEEPROM.c
+ * Version: 1.1
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * EEPROM record store. Every area of the EEPROM (s. RobotArmEEPROM.h)
+ * holds one record, e.g. the calibration of the servos. A record is
+ * saved in the next of several slots each time, so the EEPROM cells wear
+ * out EE_xxx_SLOTS times slower, and the previous record is still there
+ * if the power fails while the new one is written.
+ * Each slot stores a header with a sequence number, the version of the
+ * data and its length, and a CRC-16 over all of it. loadRecord() uses the
+ * valid slot with the highest sequence number - blank or damaged slots
+ * are ignored.
+ *
+ * Example:
+ *
+ *			my_settings_t settings;
+ *
+ *			if(loadRecord(EE_AREA_MY_SETTINGS, &settings, sizeof(settings)) != EE_OK)
+ *				setDefaults(&settings);
+ *			...
+ *			settings.speed = 5;
+ *			saveRecord(EE_AREA_MY_SETTINGS, &settings, sizeof(settings));
+ *
+ * saveRecord() does not wait: it copies the record into a buffer and
+ * the EE_READY interrupt writes one byte after the other (8.5ms each).
+ * Bytes that did not change are not written at all. The motion engine,
+ * the UART and the scheduler keep running in the meantime.
+ * A second saveRecord() before the first one is finished returns EE_BUSY,
+ * use waitEEStore() or isEEStoreBusy() if you need to save more than one
+ * record. loadRecord(), readINTEE() and writeINTEE() wait until the
+ * record is written.
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+#include "RobotArmProtocolDefs.h"	// protocolCRC16
+
+#if EE_STORE_END > E2END + 1
+#error "The EEPROM record store is larger than the EEPROM!"
+#endif
+#if EE_STORE_START < 0x100
+#error "The EEPROM record store overlaps the range of readINTEE/writeINTEE!"
+#endif
+
+/*****************************************************************************/
+// Variables:
+
+// Areas of the same kind (e.g. all poses) are one entry of the table:
+typedef struct {
+	uint16_t start;		// EEPROM address of the first slot
+	uint8_t count;		// number of areas
+	uint8_t size;		// max. data bytes
+	uint8_t slots;
+	uint8_t version;
+} ee_area_t;
+
+static const ee_area_t ee_areas[] PROGMEM = {
+	{EE_CALIBRATION_START, 1, EE_CALIBRATION_SIZE, EE_CALIBRATION_SLOTS, EE_CALIBRATION_VERSION},
+	{EE_POSE_START, EE_POSES, EE_POSE_SIZE, EE_POSE_SLOTS, EE_POSE_VERSION},
+	{EE_SEQUENCE_START, EE_SEQUENCES, EE_SEQUENCE_SIZE, EE_SEQUENCE_SLOTS, EE_SEQUENCE_VERSION},
+};
+
+// Record that is written by the EE_READY interrupt, also used by
+// loadRecord while no record is written:
+static uint8_t ee_buffer[EE_SLOT_SIZE(EE_RECORD_MAX)];
+static uint16_t ee_write_adr;
+static uint8_t ee_write_pos;
+static uint8_t ee_write_length;
+static volatile uint8_t ee_busy;
+
+/*****************************************************************************/
+// Slots:
+
+/**
+ * Returns the table entry of the area, start is the address of its
+ * first slot. area must be less than EE_AREAS.
+ */
+static void getArea(uint8_t area, ee_area_t *a)
+{
+	const ee_area_t *entry = ee_areas;
+
+	memcpy_P(a, entry, sizeof(ee_area_t));
+	while(area >= a->count) {
+		area -= a->count;
+		memcpy_P(a, ++entry, sizeof(ee_area_t));
+	}
+	a->start += area * a->slots * EE_SLOT_SIZE(a->size);
+}
+
+static uint16_t getSlotAdr(const ee_area_t *a, uint8_t slot)
+{
+	return a->start + slot * EE_SLOT_SIZE(a->size);
+}
+
+static uint8_t readByteEE(uint16_t adr)
+{
+	eeprom_busy_wait();		// writeINTEE does not wait
+	EEAR = adr;
+	EECR |= (1<<EERE);
+	return EEDR;
+}
+
+/**
+ * Reads a slot into buffer and checks it. Returns the number of data
+ * bytes or 0xFF if the slot is blank or damaged.
+ * Must not be called while a record is written.
+ */
+static uint8_t readSlot(const ee_area_t *a, uint8_t area, uint8_t slot, uint8_t *buffer)
+{
+	uint16_t adr = getSlotAdr(a, slot);
+	uint16_t crc = 0xFFFF;
+	uint8_t i, length;
+
+	for(i = 0; i < EE_RECORD_HEADER; i++)
+		buffer[i] = readByteEE(adr++);
+	length = buffer[4];
+	if(buffer[0] != area || length > a->size)
+		return 0xFF;
+	for(; i < EE_SLOT_SIZE(length); i++)
+		buffer[i] = readByteEE(adr++);
+	for(i = 0; i < EE_RECORD_HEADER + length; i++)
+		crc = protocolCRC16(crc, buffer[i]);
+	if(crc != (buffer[i] | (buffer[i + 1] << 8)))
+		return 0xFF;
+	return length;
+}
+
+/**
+ * Finds the valid slot with the highest sequence number. Returns the slot
+ * or 0xFF if there is no valid record. The sequence number wraps around,
+ * so it is compared by the difference.
+ */
+static uint8_t findNewest(const ee_area_t *a, uint8_t area, uint16_t *seq)
+{
+	uint8_t slot, newest = 0xFF;
+	uint16_t s;
+
+	for(slot = 0; slot < a->slots; slot++) {
+		if(readSlot(a, area, slot, ee_buffer) == 0xFF)
+			continue;
+		s = ee_buffer[2] | (ee_buffer[3] << 8);
+		if(newest == 0xFF || (int16_t)(s - *seq) > 0) {
+			newest = slot;
+			*seq = s;
+		}
+	}
+	return newest;
+}
+
+/*****************************************************************************/
+// Record store:
+
+/**
+ * Saves a record in the next slot of the area. The data is copied, so
+ * it may change right after the call. Returns EE_OK (the record is written
+ * in the background), EE_BUSY (the previous record is still written,
+ * nothing is saved) or EE_BAD_PARAM.
+ *
+ * Example:
+ *
+ *			while(saveRecord(EE_AREA_CALIBRATION, values, 12) == EE_BUSY)
+ *				task_scheduler();
+ *
+ */
+uint8_t saveRecord(uint8_t area, const void *data, uint8_t size)
+{
+	ee_area_t a;
+	uint16_t seq = 0, crc = 0xFFFF;
+	uint8_t slot, i;
+
+	if(area >= EE_AREAS)
+		return EE_BAD_PARAM;
+	getArea(area, &a);
+	if(size > a.size)
+		return EE_BAD_PARAM;
+	if(ee_busy)
+		return EE_BUSY;
+
+	slot = findNewest(&a, area, &seq);
+	if(slot == 0xFF)
+		slot = 0;
+	else if(++slot >= a.slots)
+		slot = 0;
+	seq++;
+
+	ee_buffer[0] = area;
+	ee_buffer[1] = a.version;
+	ee_buffer[2] = seq & 0xFF;
+	ee_buffer[3] = seq >> 8;
+	ee_buffer[4] = size;
+	memcpy(&ee_buffer[EE_RECORD_HEADER], data, size);
+	for(i = 0; i < EE_RECORD_HEADER + size; i++)
+		crc = protocolCRC16(crc, ee_buffer[i]);
+	ee_buffer[i] = crc & 0xFF;
+	ee_buffer[i + 1] = crc >> 8;
+
+	ee_write_adr = getSlotAdr(&a, slot);
+	ee_write_pos = 0;
+	ee_write_length = EE_SLOT_SIZE(size);
+	ee_busy = true;
+	EECR |= (1<<EERIE);		// the EE_READY interrupt writes the bytes
+	return EE_OK;
+}
+
+/**
+ * Loads the newest valid record of an area. Returns EE_OK, EE_NOT_FOUND
+ * (data is unchanged) or EE_WRONG_VERSION: the record was saved by another
+ * version of the program or has another size. In this case the first
+ * size bytes of it are copied anyway, a program can convert them.
+ * Waits until a record that is written right now is finished.
+ */
+uint8_t loadRecord(uint8_t area, void *data, uint8_t size)
+{
+	ee_area_t a;
+	uint16_t seq = 0;
+	uint8_t slot, length;
+
+	if(area >= EE_AREAS)
+		return EE_BAD_PARAM;
+	getArea(area, &a);
+	waitEEStore();
+
+	slot = findNewest(&a, area, &seq);
+	if(slot == 0xFF)
+		return EE_NOT_FOUND;
+	length = readSlot(&a, area, slot, ee_buffer);
+	memcpy(data, &ee_buffer[EE_RECORD_HEADER], (length < size) ? length : size);
+	if(ee_buffer[1] != a.version || length != size)
+		return EE_WRONG_VERSION;
+	return EE_OK;
+}
+
+/**
+ * Returns how often a record was saved in this area (the sequence number
+ * of the newest record, 0 = never). Divided by the number of slots, this
+ * is the number of writes to each EEPROM cell of the area - the ATmega64
+ * EEPROM is specified for 100.000 writes.
+ */
+uint16_t getRecordWrites(uint8_t area)
+{
+	ee_area_t a;
+	uint16_t seq = 0;
+
+	if(area >= EE_AREAS)
+		return 0;
+	getArea(area, &a);
+	waitEEStore();
+	if(findNewest(&a, area, &seq) == 0xFF)
+		return 0;
+	return seq;
+}
+
+/**
+ * Returns true while a record is written.
+ */
+uint8_t isEEStoreBusy(void)
+{
+	return ee_busy;
+}
+
+/**
+ * Waits until the record is written. Runs the scheduler in the meantime.
+ * Interrupts must be enabled!
+ */
+void waitEEStore(void)
+{
+	while(ee_busy) {
+		task_scheduler();
+		idle();
+	}
+}
+
+/**
+ * EEPROM ready interrupt: writes the next changed byte of the record.
+ * The EEPROM is read first, bytes that are already equal are skipped.
+ */
+ISR(EE_READY_vect)
+{
+	uint8_t data;
+
+	while(ee_write_pos < ee_write_length) {
+		data = ee_buffer[ee_write_pos];
+		EEAR = ee_write_adr + ee_write_pos++;
+		EECR |= (1<<EERE);
+		if(EEDR != data) {
+			EEDR = data;
+			EECR |= (1<<EEMWE);
+			EECR |= (1<<EEWE);
+			return;
+		}
+	}
+	EECR &= ~(1<<EERIE);
+	ee_busy = false;
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ * - v. 1.1 17.10.2026: areas for the pose library, records up to 48 bytes
+ * - v. 1.2 17.10.2026: the store starts at 0x100, behind the addresses
+ *                      of readINTEE/writeINTEE
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,85 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmEEPROM.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * EEPROM record store. Detailled description of each function
+ * can be found in the RobotArmEEPROM.c file!
+ * This file is included by RobotArmBaseLib.h.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMEEPROM_H
+#define ROBOTARMEEPROM_H
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// EEPROM layout
+
+// 0x000..0x0FF is the range of readINTEE/writeINTEE (s. RobotArmBaseLib.h):
+// bytes 0 + 1 are reserved for the bootloader, 2..13 are the calibration
+// of library versions before 2.1, the rest belongs to the user program.
+// The record store starts behind it.
+#define EE_STORE_START			0x100
+
+// Slot: [area][version][seq low][seq high][length][data][crc low][crc high]
+#define EE_RECORD_HEADER		5
+#define EE_RECORD_CRC			2
+#define EE_RECORD_MAX			48		// max. data bytes of a record
+#define EE_SLOT_SIZE(__SIZE__)	(EE_RECORD_HEADER + (__SIZE__) + EE_RECORD_CRC)
+
+// Areas - every area holds one record in EE_xxx_SLOTS rotating slots:
+#define EE_AREA_CALIBRATION		0
+#define EE_AREA_POSE(__N__)		(1 + (__N__))
+#define EE_AREA_SEQUENCE(__N__)	(1 + EE_POSES + (__N__))
+#define EE_AREAS				(1 + EE_POSES + EE_SEQUENCES)
+
+#define EE_CALIBRATION_START	EE_STORE_START
+#define EE_CALIBRATION_SIZE		12		// 6 * uint16 Start_Position
+#define EE_CALIBRATION_SLOTS	8
+#define EE_CALIBRATION_VERSION	1
+
+// Pose library (s. RobotArmPoses.c). Poses and sequences are rarely
+// saved, so they only have one slot each:
+#define EE_POSE_START			(EE_CALIBRATION_START + EE_CALIBRATION_SLOTS * EE_SLOT_SIZE(EE_CALIBRATION_SIZE))
+#define EE_POSES				40
+#define EE_POSE_SIZE			20		// pose_t
+#define EE_POSE_SLOTS			1
+#define EE_POSE_VERSION			1
+
+#define EE_SEQUENCE_START		(EE_POSE_START + EE_POSES * EE_POSE_SLOTS * EE_SLOT_SIZE(EE_POSE_SIZE))
+#define EE_SEQUENCES			8
+#define EE_SEQUENCE_SIZE		45		// pose_sequence_t
+#define EE_SEQUENCE_SLOTS		1
+#define EE_SEQUENCE_VERSION		1
+
+#define EE_STORE_END			(EE_SEQUENCE_START + EE_SEQUENCES * EE_SEQUENCE_SLOTS * EE_SLOT_SIZE(EE_SEQUENCE_SIZE))
+
+/*****************************************************************************/
+// Record store
+
+#define EE_OK					0
+#define EE_BUSY					1	// the previous record is still written
+#define EE_NOT_FOUND			2	// no valid record (blank or CRC error)
+#define EE_WRONG_VERSION		3	// valid record of another version/size
+#define EE_BAD_PARAM			4
+
+uint8_t saveRecord(uint8_t area, const void *data, uint8_t size);
+uint8_t loadRecord(uint8_t area, void *data, uint8_t size);
+uint8_t isEEStoreBusy(void);
+void waitEEStore(void);
+uint16_t getRecordWrites(uint8_t area);
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,170 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmIsrStats.c
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * Measures how often the interrupt routines run, how long they take
+ * and - for Timer 2 - how late they start. Build with
+ *
+ *			make ISR_STATS=1
+ *
+ * (after deleting the old .o files in RobotArmBase). Without ISR_STATS
+ * nothing of this is compiled and the interrupts are not slowed down.
+ *
+ * Measured interrupts: ISR_STAT_TIMER2, ISR_STAT_ADC, ISR_STAT_UART_RX
+ * and ISR_STAT_UART_TX. Timer 1 and 3 create the servo signals and
+ * Timer 0 the beeper, so the times are taken from Timer 2: it counts
+ * with 2MHz, one count is 0.5us or 8 CPU cycles (0.49us with the
+ * 16.384MHz crystal of the older PCBs). The run time starts
+ * after the register saving of the interrupt routine (the prologue) and
+ * ends before the register restore, so add about 2-4us for the full
+ * interrupt. The 1ms step of the Timer 2 interrupt runs with interrupts
+ * enabled, its run time includes the interrupts that came in between.
+ *
+ * Latency is the time from the Timer 2 compare match to the first
+ * instruction of the interrupt routine. It includes the prologue and
+ * the time the interrupts were disabled by other code or interrupts.
+ * For the other interrupts the hardware does not tell when the event
+ * happened, so there is no latency.
+ *
+ * The statistics can be read with MSG_QUERY_ISR_STATS
+ * (RobotArmProtocol.c) or printed as text:
+ *
+ * Example:
+ *
+ *			printISRStats();
+ *			// ISR     count  min  avg  max  lat avg  lat max (0.5us)
+ *			// TIMER2  100000  12  14  97  3  41
+ *			// ...
+ *			resetISRStats();
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+
+#ifdef ISR_STATS
+
+/*****************************************************************************/
+// Variables:
+
+static volatile isr_stat_t isr_stats[ISR_STAT_COUNT];
+
+/*****************************************************************************/
+// Statistics:
+
+/**
+ * Called by ISR_STATS_LEAVE. start is the time and latency the TCNT2
+ * value at the start of the interrupt routine.
+ */
+void isrStatsRecord(uint8_t isr, uint16_t start, uint8_t latency)
+{
+	uint16_t time = isrStatsClock(TCNT2) - start;
+	volatile isr_stat_t *s = &isr_stats[isr];
+
+	if(!s->count++ || time < s->min)
+		s->min = time;
+	if(time > s->max)
+		s->max = time;
+	s->sum += time;
+	if(isr == ISR_STAT_TIMER2) {
+		s->latency_sum += latency;
+		if(latency > s->latency_max)
+			s->latency_max = latency;
+	}
+}
+
+/**
+ * Copies the statistics of one interrupt (ISR_STAT_xxx).
+ */
+void getISRStats(uint8_t isr, isr_stat_t *stat)
+{
+	if(isr >= ISR_STAT_COUNT)
+		return;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		*stat = *(isr_stat_t *)&isr_stats[isr];
+	}
+}
+
+/**
+ * Clears the statistics of all interrupts.
+ */
+void resetISRStats(void)
+{
+	uint8_t i;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for(i = 0; i < ISR_STAT_COUNT; i++) {
+			isr_stats[i].count = 0;
+			isr_stats[i].sum = 0;
+			isr_stats[i].min = 0;
+			isr_stats[i].max = 0;
+			isr_stats[i].latency_sum = 0;
+			isr_stats[i].latency_max = 0;
+		}
+	}
+}
+
+static void writeValue(uint32_t value)
+{
+	char buffer[11];
+	ultoa(value, &buffer[0], 10);
+	writeString(&buffer[0]);
+	writeString_P("  ");
+}
+
+/**
+ * Writes the statistics of all interrupts as a table to the UART.
+ * All times are in Timer 2 counts (0.5us).
+ */
+void printISRStats(void)
+{
+	static const char names[ISR_STAT_COUNT][9] PROGMEM = {
+		"TIMER2  ", "ADC     ", "UART RX ", "UART TX "
+	};
+	isr_stat_t s;
+	uint8_t i;
+
+	writeString_P("ISR     count  min  avg  max  lat avg  lat max (0.5us)\n");
+	for(i = 0; i < ISR_STAT_COUNT; i++) {
+		getISRStats(i, &s);
+		writeNStringP(names[i]);
+		writeValue(s.count);
+		writeValue(s.min);
+		writeValue(s.count ? s.sum / s.count : 0);
+		writeValue(s.max);
+		if(i == ISR_STAT_TIMER2) {
+			writeValue(s.count ? s.latency_sum / s.count : 0);
+			writeValue(s.latency_max);
+		}
+		writeChar('\n');
+	}
+}
+
+#endif
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,80 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmIsrStats.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * Optional run time and latency measurement of the interrupt routines.
+ * Only compiled in with -DISR_STATS (make ISR_STATS=1), otherwise the
+ * ISR_STATS_ENTER/ISR_STATS_LEAVE macros are empty. Detailled description
+ * can be found in the RobotArmIsrStats.c file!
+ * This file is included by RobotArmBaseLib.h.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMISRSTATS_H
+#define ROBOTARMISRSTATS_H
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+#include "RobotArmProtocolDefs.h"	// ISR_STAT_xxx numbers
+
+/*****************************************************************************/
+// Interrupt statistics
+
+#ifdef ISR_STATS
+
+typedef struct {
+	uint32_t count;
+	uint32_t sum;		// sum of the run times
+	uint16_t min;		// run times in Timer 2 counts (0.5us = 8 cycles)
+	uint16_t max;
+	uint32_t latency_sum;	// only for ISR_STAT_TIMER2
+	uint8_t latency_max;
+} isr_stat_t;
+
+extern volatile uint16_t delay_timer;
+
+/**
+ * Time in Timer 2 counts (0.5us), 16 bit. Only valid with disabled
+ * interrupts, i.e. in an interrupt routine. count is TCNT2.
+ */
+static inline uint16_t isrStatsClock(uint8_t count)
+{
+	uint16_t ticks = delay_timer;
+	// Compare match after the interrupts were disabled?
+	if((TIFR & (1 << OCF2)) && count < TIMER2_COUNTS / 2)
+		ticks++;
+	return ticks * TIMER2_COUNTS + count;
+}
+
+// Put ISR_STATS_ENTER() at the start of an interrupt routine and
+// ISR_STATS_LEAVE(ISR_STAT_xxx) before every return:
+#define ISR_STATS_ENTER() \
+	uint8_t isr_stats_count = TCNT2; \
+	uint16_t isr_stats_start = isrStatsClock(isr_stats_count)
+#define ISR_STATS_LEAVE(__ISR__) \
+	isrStatsRecord((__ISR__), isr_stats_start, isr_stats_count)
+
+void isrStatsRecord(uint8_t isr, uint16_t start, uint8_t latency);
+void getISRStats(uint8_t isr, isr_stat_t *stat);
+void resetISRStats(void);
+void printISRStats(void);
+
+#else
+
+#define ISR_STATS_ENTER()
+#define ISR_STATS_LEAVE(__ISR__)
+
+#endif
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,233 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmKinematics.c
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * Forward and inverse kinematics. Move() and s_Move() only know servo
+ * offsets - with this module you can work with the position of the
+ * gripper in millimeters instead.
+ *
+ * Example:
+ *
+ *			kin_pose_t pose = {KIN_MM(150), KIN_MM(-40), KIN_MM(60),
+ *			                   KIN_DEG(-30), 0, 0};
+ *			int16_t offsets[6];
+ *
+ *			if(inverseKinematics(&pose, offsets) == KIN_OK)
+ *				moveAllTo(offsets, 2);
+ *
+ * forwardKinematics calculates the gripper pose from the six servo
+ * offsets, inverseKinematics calculates the servo offsets for a pose
+ * (elbow up solution). The gripper offset is simply copied.
+ *
+ * Every servo must be calibrated with setJointCalibration: the offset
+ * where the joint angle is 0 and the offset change for 90 degree.
+ *
+ * Everything is calculated in fixed point without float, with the table
+ * based sine and arctangent of RobotArmMath - an inverse kinematics takes
+ * well below 1 ms (bench/bench_inverseKinematics.c, "make bench").
+ * Compared to the double precision reference on the host
+ * (host/RobotArmKinematics.cpp) the forward kinematics is better than
+ * 0.2 mm and 0.03 degree. The inverse kinematics differs by at most three
+ * servo counts, unless the elbow is almost stretched (then small position
+ * changes need big angle changes anyway). host/kincheck.cpp measures
+ * this ("make kincheck").
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmKinematics.h"
+
+/*****************************************************************************/
+// Variables:
+
+// Joint calibration of servo 2..6 (index = servo - 2):
+typedef struct {
+	int16_t zero;		// offset at angle 0
+	int16_t quarter;	// offset change for +90 degree
+	int16_t scale;		// angle per offset count, 8.8 fixed point
+} kin_calibration_t;
+
+#define KIN_JOINTS 5
+#define KIN_SCALE(__QUARTER__) ((int16_t)(16384L * 256 / (__QUARTER__)))
+
+static kin_calibration_t kin_calibration[KIN_JOINTS] = {
+	{0, KIN_DEFAULT_QUARTER, KIN_SCALE(KIN_DEFAULT_QUARTER)},
+	{0, KIN_DEFAULT_QUARTER, KIN_SCALE(KIN_DEFAULT_QUARTER)},
+	{0, KIN_DEFAULT_QUARTER, KIN_SCALE(KIN_DEFAULT_QUARTER)},
+	{0, KIN_DEFAULT_QUARTER, KIN_SCALE(KIN_DEFAULT_QUARTER)},
+	{0, KIN_DEFAULT_QUARTER, KIN_SCALE(KIN_DEFAULT_QUARTER)}
+};
+
+/*****************************************************************************/
+// Calibration:
+
+/**
+ * Sets the calibration of a joint (servo 2..6):
+ *  zero    - servo offset where the joint angle is 0 (s. RobotArmKinematicsDefs.h)
+ *  quarter - change of the servo offset for +90 degree, negative if the
+ *            servo turns the other way. |quarter| must be at least 128.
+ *
+ * Example:
+ *
+ *			// Shoulder is horizontal at offset -380 and vertical at 620:
+ *			setJointCalibration(5, -380, 1000);
+ */
+void setJointCalibration(uint8_t servo, int16_t zero, int16_t quarter)
+{
+	kin_calibration_t *c;
+
+	if(servo < 2 || servo > 6 || (quarter > -128 && quarter < 128))
+		return;
+	c = &kin_calibration[servo - 2];
+	c->zero = zero;
+	c->quarter = quarter;
+	c->scale = KIN_SCALE(quarter);
+}
+
+/**
+ * Converts a servo offset to a joint angle (binary angle). Servo 1 (the
+ * gripper) has no angle, the offset is returned.
+ */
+int16_t offsetToAngle(uint8_t servo, int16_t offset)
+{
+	kin_calibration_t *c;
+
+	if(servo < 2 || servo > 6)
+		return offset;
+	c = &kin_calibration[servo - 2];
+	return ((int32_t)(offset - c->zero) * c->scale + 128) >> 8;
+}
+
+/**
+ * Converts a joint angle (binary angle) to a servo offset.
+ */
+int16_t angleToOffset(uint8_t servo, int16_t angle)
+{
+	kin_calibration_t *c;
+
+	if(servo < 2 || servo > 6)
+		return angle;
+	c = &kin_calibration[servo - 2];
+	return c->zero + (int16_t)(((int32_t)angle * c->quarter + 8192) >> 14);
+}
+
+/*****************************************************************************/
+// Kinematics:
+
+/**
+ * Calculates the pose of the gripper from the offsets of servo 1..6
+ * (offsets[0] = servo 1).
+ */
+void forwardKinematics(const int16_t *offsets, kin_pose_t *pose)
+{
+	int16_t base = offsetToAngle(6, offsets[5]);
+	int16_t a1 = offsetToAngle(5, offsets[4]);
+	int16_t a12 = a1 + offsetToAngle(4, offsets[3]);
+	int16_t a123 = a12 + offsetToAngle(3, offsets[2]);
+	int32_t r, z;
+
+	r = (int32_t)KIN_UPPER_ARM * fixCos(a1)
+	    + (int32_t)KIN_FOREARM * fixCos(a12)
+	    + (int32_t)KIN_TOOL * fixCos(a123);
+	z = (int32_t)KIN_UPPER_ARM * fixSin(a1)
+	    + (int32_t)KIN_FOREARM * fixSin(a12)
+	    + (int32_t)KIN_TOOL * fixSin(a123);
+	r = (r + 16384) >> 15;
+
+	pose->x = (r * fixCos(base) + 16384) >> 15;
+	pose->y = (r * fixSin(base) + 16384) >> 15;
+	pose->z = KIN_BASE_HEIGHT + ((z + 16384) >> 15);
+	pose->pitch = a123;
+	pose->roll = offsetToAngle(2, offsets[1]);
+	pose->grip = offsets[0];
+}
+
+/**
+ * Calculates the offsets of servo 1..6 (offsets[0] = servo 1) for a pose
+ * of the gripper. Uses the solution with the elbow above the line from
+ * shoulder to wrist.
+ * Returns KIN_OK, KIN_UNREACHABLE or KIN_JOINT_LIMIT. The offsets are
+ * only changed if the result is KIN_OK.
+ */
+uint8_t inverseKinematics(const kin_pose_t *pose, int16_t *offsets)
+{
+	int16_t joint[6];	// angles, then offsets
+	uint32_t r;
+	int32_t rw, zw, c, d;
+	uint16_t s;
+	uint8_t i;
+
+	joint[5] = fixAtan2(pose->y, pose->x);
+	r = (uint32_t)((int32_t)pose->x * pose->x) + (uint32_t)((int32_t)pose->y * pose->y);
+	if(r >= (1UL << 27))
+		return KIN_UNREACHABLE;	// far out of reach, would overflow below
+	r = fixSqrt(r << 4);	// 4 * r, the truncation error matters here
+
+	// Wrist axis in the arm plane (in 0.025 mm):
+	rw = (int32_t)r - (((int32_t)KIN_TOOL * fixCos(pose->pitch) + 4096) >> 13);
+	zw = 4 * (pose->z - KIN_BASE_HEIGHT)
+	     - (((int32_t)KIN_TOOL * fixSin(pose->pitch) + 4096) >> 13);
+	if(rw > 4L * (KIN_UPPER_ARM + KIN_FOREARM) || rw < -4L * (KIN_UPPER_ARM + KIN_FOREARM)
+	   || zw > 4L * (KIN_UPPER_ARM + KIN_FOREARM) || zw < -4L * (KIN_UPPER_ARM + KIN_FOREARM))
+		return KIN_UNREACHABLE;	// the squares below would overflow
+
+	// Law of cosines for the elbow: cos = c / d. Reduced so that the
+	// squares fit into 32 bit.
+	c = (rw * rw + zw * zw
+	     - 16 * ((int32_t)KIN_UPPER_ARM * KIN_UPPER_ARM
+	             + (int32_t)KIN_FOREARM * KIN_FOREARM) + 512) >> 10;
+	d = ((int32_t)KIN_UPPER_ARM * KIN_FOREARM) >> 5;
+	if(c > d || c < -d)
+		return KIN_UNREACHABLE;
+	s = fixSqrt(d * d - c * c);		// sin * d
+
+	joint[3] = -fixAtan2(s, c);		// elbow up
+	joint[4] = fixAtan2(zw, rw)
+	           - fixAtan2(-(int32_t)KIN_FOREARM * s,
+	                      (int32_t)KIN_UPPER_ARM * d + (int32_t)KIN_FOREARM * c);
+	joint[2] = pose->pitch - joint[4] - joint[3];
+	joint[1] = pose->roll;
+
+	for(i = 2; i <= 6; i++) {
+		int16_t offset = angleToOffset(i, joint[i - 1]);
+		if(offset < KIN_OFFSET_MIN || offset > KIN_OFFSET_MAX)
+			return KIN_JOINT_LIMIT;
+		joint[i - 1] = offset;
+	}
+	joint[0] = pose->grip;
+	for(i = 0; i < 6; i++)
+		offsets[i] = joint[i];
+	return KIN_OK;
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ * - v. 1.1 17.10.2026: uses RobotArmMath instead of own tables
+ * - v. 1.2 17.10.2026: inverseKinematics: wrist point far out of reach
+ *                      overflowed the law of cosines and could return
+ *                      KIN_OK
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,39 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmKinematics.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * Forward and inverse kinematics in fixed point. Geometry and units can
+ * be found in RobotArmKinematicsDefs.h, detailled description of each
+ * function in the RobotArmKinematics.c file!
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMKINEMATICS_H
+#define ROBOTARMKINEMATICS_H
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+#include "RobotArmKinematicsDefs.h"
+
+/*****************************************************************************/
+// Kinematics
+
+void setJointCalibration(uint8_t servo, int16_t zero, int16_t quarter);
+int16_t offsetToAngle(uint8_t servo, int16_t offset);
+int16_t angleToOffset(uint8_t servo, int16_t angle);
+
+void forwardKinematics(const int16_t *offsets, kin_pose_t *pose);
+uint8_t inverseKinematics(const kin_pose_t *pose, int16_t *offsets);
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,87 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmKinematicsDefs.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz and host PC (C and C++)
+ * ****************************************************************************
+ * Description:
+ * Geometry and units of the kinematics. This file is shared by the
+ * firmware (RobotArmKinematics.c) and the host reference implementation
+ * (host/RobotArmKinematics.hpp), so it must not include any AVR headers.
+ *
+ * Joints:
+ *   servo 6 - base (rotation around the vertical axis)
+ *   servo 5 - shoulder
+ *   servo 4 - elbow
+ *   servo 3 - wrist pitch
+ *   servo 2 - wrist roll
+ *   servo 1 - gripper (not part of the kinematics, just passed through)
+ *
+ * Units:
+ *   lengths and positions - 0.1 mm (KIN_MM)
+ *   angles - binary angle, 65536 = 360 degree, int16_t (KIN_DEG)
+ *
+ * Shoulder, elbow and wrist angles are 0 if the link is horizontal and
+ * positive upwards. Pitch is the angle of the gripper to the horizontal.
+ * The origin is on the floor below the base axis, z points up and x
+ * points forward (base angle 0).
+ *
+ * The lengths below are for the standard arm. Measure your own arm if
+ * you need exact positions!
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMKINEMATICSDEFS_H
+#define ROBOTARMKINEMATICSDEFS_H
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// Units:
+
+#define KIN_MM(__MM__) ((int16_t)((__MM__) * 10.0 + ((__MM__) < 0 ? -0.5 : 0.5)))
+#define KIN_DEG(__DEG__) ((int16_t)((__DEG__) * 65536.0 / 360.0 + ((__DEG__) < 0 ? -0.5 : 0.5)))
+
+/*****************************************************************************/
+// Geometry (0.1 mm):
+
+#define KIN_BASE_HEIGHT		KIN_MM(90)		// floor to shoulder axis
+#define KIN_UPPER_ARM		KIN_MM(95)		// shoulder to elbow axis
+#define KIN_FOREARM			KIN_MM(100)		// elbow to wrist axis
+#define KIN_TOOL			KIN_MM(130)		// wrist axis to gripper tip
+
+// Servo offsets that are allowed as result of the inverse kinematics:
+#define KIN_OFFSET_MIN		-500
+#define KIN_OFFSET_MAX		500
+
+// Default calibration: offset change for +90 degree (negative if the
+// servo turns the other way). 1000 counts are 1000 us - the usual
+// RC servo standard.
+#define KIN_DEFAULT_QUARTER	1000
+
+/*****************************************************************************/
+// Results of the inverse kinematics:
+
+#define KIN_OK				0
+#define KIN_UNREACHABLE		1	// position is out of reach
+#define KIN_JOINT_LIMIT		2	// a servo would leave KIN_OFFSET_MIN..MAX
+
+/*****************************************************************************/
+// Gripper pose:
+
+typedef struct {
+	int16_t x;			// 0.1 mm
+	int16_t y;
+	int16_t z;
+	int16_t pitch;		// binary angle
+	int16_t roll;
+	int16_t grip;		// servo 1 offset
+} kin_pose_t;
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,236 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmMath.c
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz and host PC
+ * ****************************************************************************
+ * Description:
+ *
+ * Fixed point math library. The float functions of the avr-libc (sin,
+ * atan2, sqrt...) need several kilobytes of flash and thousands of cycles
+ * per call. These functions only use integer math and small tables in
+ * the flash (PROGMEM):
+ *
+ *  fixSin, fixCos - sine/cosine of a binary angle (65536 = 360 degree),
+ *                   result * 32767 (FIX_ONE). 65 entry table with
+ *                   linear interpolation. Max. error: 3.2 (1e-4).
+ *  fixAtan2       - binary angle of the vector (x, y), x and y can be
+ *                   any 32 bit values. 65 entry table with linear
+ *                   interpolation. Max. error: 1.6 (0.009 degree).
+ *  fixSqrt        - integer square root (rounded down), exact.
+ *  fixRecip       - 2^32 / x for a 16 bit x. Table + one Newton step,
+ *                   relative error below 2^-17.
+ *  fixMulRecip    - a * recip / 2^16. With fixRecip this replaces
+ *                   divisions by the same divisor, e.g.
+ *                   a / x = fixMulRecip(a, fixRecip(x)) >> 16 (fixDiv,
+ *                   can be 1 too small).
+ *
+ * Example:
+ *
+ *			int16_t angle = FIX_DEG(30);
+ *			int16_t x = ((int32_t)length * fixCos(angle)) >> 15;
+ *			int16_t y = ((int32_t)length * fixSin(angle)) >> 15;
+ *			angle = fixAtan2(y, x);			// ~ FIX_DEG(30) again
+ *			length = fixSqrt((int32_t)x * x + (int32_t)y * y);
+ *
+ * The file does not need any AVR headers except for PROGMEM, so it also
+ * compiles on the host - host/mathbench.cpp checks the errors against
+ * libm and compares the speed ("make mathbench"). The cycles on the
+ * ATmega64 compared to sin, atan2 and sqrt of the avr-libc are measured
+ * by bench/bench_fixSin.c & co. ("make bench").
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmMath.h"
+
+#ifdef __AVR__
+	#include <avr/pgmspace.h>
+#else
+	#define PROGMEM
+	#define pgm_read_word(__ADDR__) (*(const uint16_t *)(__ADDR__))
+#endif
+
+/*****************************************************************************/
+// Tables:
+
+// sin(i * 90 / 64 degree) * 32767:
+static const uint16_t sin_table[65] PROGMEM = {
+	0, 804, 1608, 2410, 3212, 4011, 4808, 5602, 6393, 7179, 7962, 8739,
+	9512, 10278, 11039, 11793, 12539, 13279, 14010, 14732, 15446, 16151,
+	16846, 17530, 18204, 18868, 19519, 20159, 20787, 21403, 22005, 22594,
+	23170, 23731, 24279, 24811, 25329, 25832, 26319, 26790, 27245, 27683,
+	28105, 28510, 28898, 29268, 29621, 29956, 30273, 30571, 30852, 31113,
+	31356, 31580, 31785, 31971, 32137, 32285, 32412, 32521, 32609, 32678,
+	32728, 32757, 32767
+};
+
+// atan(i / 64) as binary angle:
+static const uint16_t atan_table[65] PROGMEM = {
+	0, 163, 326, 489, 651, 813, 975, 1136, 1297, 1457, 1617, 1775, 1933,
+	2090, 2246, 2401, 2555, 2708, 2860, 3010, 3159, 3307, 3453, 3599, 3742,
+	3884, 4025, 4164, 4302, 4438, 4572, 4705, 4836, 4966, 5094, 5220, 5344,
+	5467, 5589, 5708, 5826, 5943, 6058, 6171, 6282, 6392, 6500, 6607, 6712,
+	6815, 6917, 7018, 7117, 7214, 7310, 7405, 7498, 7589, 7679, 7768, 7856,
+	7942, 8026, 8110, 8192
+};
+
+// 2^31 / (32768 + 512 * i), first entry limited to 16 bit:
+static const uint16_t recip_table[65] PROGMEM = {
+	65535, 64528, 63550, 62602, 61681, 60787, 59919, 59075, 58254, 57456,
+	56680, 55924, 55188, 54471, 53773, 53092, 52429, 51782, 51150, 50534,
+	49932, 49345, 48771, 48210, 47663, 47127, 46603, 46091, 45590, 45100,
+	44620, 44151, 43691, 43240, 42799, 42367, 41943, 41528, 41121, 40721,
+	40330, 39946, 39569, 39199, 38836, 38480, 38130, 37787, 37449, 37118,
+	36792, 36472, 36158, 35849, 35545, 35246, 34953, 34664, 34380, 34100,
+	33825, 33554, 33288, 33026, 32768
+};
+
+/**
+ * Linear interpolation in a 65 entry table, x = 0..16384.
+ */
+static uint16_t lookup(const uint16_t *table, uint16_t x)
+{
+	uint8_t i = x >> 8;
+	uint16_t a, b;
+
+	a = pgm_read_word(&table[i]);
+	if(i == 64)
+		return a;
+	b = pgm_read_word(&table[i + 1]);
+	if(b >= a)
+		return a + (((uint32_t)(b - a) * (x & 0xFF) + 128) >> 8);
+	return a - (((uint32_t)(a - b) * (x & 0xFF) + 128) >> 8);
+}
+
+/*****************************************************************************/
+// Trigonometry:
+
+/**
+ * Sine of a binary angle (65536 = 360 degree), result * 32767.
+ * Use fixCos for the cosine.
+ */
+int16_t fixSin(int16_t angle)
+{
+	uint16_t x = (uint16_t)angle & 0x3FFF;
+	int16_t value;
+
+	if(angle & 0x4000)	// second and fourth quadrant
+		x = 0x4000 - x;
+	value = lookup(sin_table, x);
+	return (angle & 0x8000) ? -value : value;
+}
+
+/**
+ * Binary angle of the vector (x, y), -32768..32767 = -180..180 degree.
+ * Returns 0 for (0, 0).
+ */
+int16_t fixAtan2(int32_t y, int32_t x)
+{
+	uint32_t ax = (x < 0) ? -(uint32_t)x : (uint32_t)x;
+	uint32_t ay = (y < 0) ? -(uint32_t)y : (uint32_t)y;
+	uint32_t ratio;		// smaller / bigger value * 16384
+	uint16_t angle;
+
+	if(!ax && !ay)
+		return 0;
+	while((ax | ay) > 0xFFFF) {		// fixMulRecip needs 16 bit
+		ax >>= 1;
+		ay >>= 1;
+	}
+	if(ay <= ax)
+		ratio = fixMulRecip(ay, fixRecip(ax)) >> 2;
+	else
+		ratio = fixMulRecip(ax, fixRecip(ay)) >> 2;
+	if(ratio > 16384)
+		ratio = 16384;
+	angle = lookup(atan_table, ratio);
+	if(ay > ax)
+		angle = 0x4000 - angle;
+	if(x < 0)
+		angle = 0x8000 - angle;
+	return (y < 0) ? -(int16_t)angle : (int16_t)angle;
+}
+
+/*****************************************************************************/
+// Square root and division:
+
+/**
+ * Integer square root, rounded down.
+ */
+uint16_t fixSqrt(uint32_t value)
+{
+	uint32_t bit = 1UL << 30;
+	uint32_t root = 0;
+
+	while(bit > value)
+		bit >>= 2;
+	while(bit) {
+		if(value >= root + bit) {
+			value -= root + bit;
+			root = (root >> 1) + bit;
+		}
+		else
+			root >>= 1;
+		bit >>= 2;
+	}
+	return root;
+}
+
+/**
+ * Returns 2^32 / x (0xFFFFFFFF for x = 0 and 1). Faster than a 32 bit
+ * division and can be used for several divisions by the same value with
+ * fixMulRecip.
+ */
+uint32_t fixRecip(uint16_t x)
+{
+	uint8_t shift = 0;
+	uint32_t r;
+	int32_t e;
+
+	if(x <= 1)
+		return 0xFFFFFFFFUL;
+	while(!(x & 0x8000)) {	// normalize to 0x8000..0xFFFF
+		x <<= 1;
+		shift++;
+	}
+	r = (uint32_t)lookup(recip_table, (x - 0x8000) >> 1) << 1;	// ~ 2^32 / x
+	// Newton step r = r * (2 - x * r / 2^32). e = 2^32 - x * r is small,
+	// so the 32 bit overflow does not matter:
+	e = -(int32_t)((uint32_t)x * r);
+	r += ((int32_t)r * ((e + 128) >> 8) + (1L << 23)) >> 24;
+	return r << shift;
+}
+
+/**
+ * Returns a * recip / 2^16 with 16 x 16 bit multiplications only.
+ */
+uint32_t fixMulRecip(uint16_t a, uint32_t recip)
+{
+	return (uint32_t)a * (uint16_t)(recip >> 16)
+	       + (((uint32_t)a * (uint16_t)recip) >> 16);
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
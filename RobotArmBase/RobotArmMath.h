@@ -0,0 +1,44 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmMath.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz and host PC
+ * ****************************************************************************
+ * Description:
+ * Fixed point math without float. Detailled description of each
+ * function and the error bounds can be found in the RobotArmMath.c file!
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMMATH_H
+#define ROBOTARMMATH_H
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// Fixed point math
+
+// Binary angle: 65536 = 360 degree, so int16_t overflows like the angle.
+#define FIX_DEG(__DEG__) ((int16_t)((__DEG__) * 65536.0 / 360.0 + ((__DEG__) < 0 ? -0.5 : 0.5)))
+#define FIX_ONE 32767	// 1.0 as result of fixSin / fixCos
+
+int16_t fixSin(int16_t angle);
+#define fixCos(__ANGLE__) fixSin((int16_t)((__ANGLE__) + 0x4000))
+int16_t fixAtan2(int32_t y, int32_t x);
+
+uint16_t fixSqrt(uint32_t value);
+
+uint32_t fixRecip(uint16_t x);
+uint32_t fixMulRecip(uint16_t a, uint32_t recip);
+#define fixDiv(__A__, __X__) (fixMulRecip((__A__), fixRecip(__X__)) >> 16)
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,244 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmMemory.c
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * The ATmega64 has 4KB SRAM. The global variables (.data and .bss) are
+ * at the bottom, then the heap (only if you use malloc) and the stack
+ * grows down from the top. If the stack grows into the variables, the
+ * program does strange things or crashes - there is no error message.
+ *
+ * Right after a reset, before the variables are initialized, all SRAM
+ * above the variables is filled with STACK_PAINT (0xC5). Bytes that
+ * still have this value have never been used by the stack, so
+ * getStackMaxUsed() can tell how deep the stack has been since the
+ * reset (high-water mark):
+ *
+ * Example:
+ *
+ *			Start_position();
+ *			writeInteger(getStackMaxUsed(), DEC);	// e.g. 213
+ *			writeInteger(getStackUnused(), DEC);		// e.g. 1650
+ *
+ * The lowest STACK_GUARD_SIZE bytes above the heap are a guard zone. The
+ * Timer 2 interrupt checks the highest guard byte - the first one the
+ * stack reaches - every ms, and one more byte of the zone in turn (in
+ * case a function skipped the top byte with a large local array). If
+ * the stack has reached the guard, stack_fault is set, all servos are frozen (like an
+ * overcurrent fault) and MSG_STATE reports STATE_STACK_FAULT - before
+ * the stack overwrites any variables. A stack fault is only cleared by
+ * a reset.
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+
+/*****************************************************************************/
+// Variables:
+
+#ifdef __AVR__
+// Linker symbols (s. avr-libc memory sections):
+extern uint8_t __data_start;	// start of the global variables
+extern uint8_t _end;			// end of the global variables = heap start
+extern uint8_t __stack;			// top of the stack (RAMEND)
+// Only defined if malloc is linked in - weak, so we do not pull it in:
+extern char *__brkval __attribute__((weak));
+
+#define DATA_START		(&__data_start)
+#define DATA_END		(&_end)
+#define STACK_TOP		(&__stack)
+#define STACK_POINTER	((uint8_t *)(uintptr_t)SP)
+#else
+// Host simulation (make sim): the variables are host variables, the
+// simulated SRAM (host/avrsim/AvrSim.c) only contains the stack area.
+#include <string.h>
+
+extern uint8_t sim_sram[];
+
+#define DATA_START		(&sim_sram[RAMSTART])
+#define DATA_END		DATA_START
+#define STACK_TOP		(&sim_sram[RAMEND])
+#define STACK_POINTER	(&sim_sram[SP])
+#endif
+
+volatile uint8_t stack_fault;
+static uint8_t stack_guard_index;
+
+/*****************************************************************************/
+// Stack painting:
+
+#ifdef __AVR__
+/**
+ * Fills the SRAM from the end of the variables to RAMEND with STACK_PAINT.
+ * Runs in .init1, before the stack pointer is set and r1 is cleared,
+ * so it is written in assembler. Only basic asm (without operands) is
+ * safe in a naked function, so STACK_PAINT is pasted in as a string.
+ */
+#define PAINT_STRING_(__X__) #__X__
+#define PAINT_STRING(__X__) PAINT_STRING_(__X__)
+
+void paintStack(void) __attribute__((naked, used, section(".init1")));
+void paintStack(void)
+{
+	asm volatile(
+		"	ldi r30, lo8(_end)\n"
+		"	ldi r31, hi8(_end)\n"
+		"	ldi r24, " PAINT_STRING(STACK_PAINT) "\n"
+		"	ldi r25, hi8(__stack)\n"
+		"	rjmp 2f\n"
+		"1:	st Z+, r24\n"
+		"2:	cpi r30, lo8(__stack)\n"
+		"	cpc r31, r25\n"
+		"	brlo 1b\n"
+		"	breq 1b\n");
+}
+#else
+static void paintStack(void) __attribute__((constructor));
+static void paintStack(void)
+{
+	memset(DATA_END, STACK_PAINT, STACK_TOP - DATA_END + 1);
+}
+#endif
+
+/**
+ * Returns the end of the heap or of the variables if there is no heap.
+ */
+static uint8_t *heapEnd(void)
+{
+#ifdef __AVR__
+	if(&__brkval && __brkval)
+		return (uint8_t *)__brkval;
+#endif
+	return DATA_END;
+}
+
+/**
+ * Returns the lowest address the stack has used since the reset.
+ */
+static uint8_t *stackLowWater(void)
+{
+	uint8_t *p = heapEnd();
+	while(p <= STACK_TOP && *p == STACK_PAINT)
+		p++;
+	return p;
+}
+
+/*****************************************************************************/
+// Memory usage:
+
+/**
+ * Size of the global and static variables (.data + .bss) in bytes.
+ */
+uint16_t getStaticRAM(void)
+{
+	return DATA_END - DATA_START;
+}
+
+/**
+ * Size of the heap in bytes, 0 if malloc is not used.
+ */
+uint16_t getHeapRAM(void)
+{
+	return heapEnd() - DATA_END;
+}
+
+/**
+ * Maximum stack size since the reset in bytes (high-water mark).
+ */
+uint16_t getStackMaxUsed(void)
+{
+	return STACK_TOP - stackLowWater() + 1;
+}
+
+/**
+ * Bytes between heap and stack that have never been used.
+ */
+uint16_t getStackUnused(void)
+{
+	return stackLowWater() - heapEnd();
+}
+
+/**
+ * Bytes between heap and the current stack pointer.
+ */
+uint16_t getFreeRAM(void)
+{
+	return STACK_POINTER - heapEnd();
+}
+
+/*****************************************************************************/
+// Stack guard:
+
+/**
+ * Called every ms in the Timer 2 interrupt. Checks the highest byte of
+ * the guard zone and one other byte per call, so the whole zone is
+ * checked every STACK_GUARD_SIZE ms.
+ */
+void checkStackGuard(void)
+{
+	uint8_t *guard = heapEnd();
+
+	if(stack_fault) {
+		servo_frozen = 0x3F;
+		return;
+	}
+	if(guard[STACK_GUARD_SIZE - 1] != STACK_PAINT
+	   || guard[stack_guard_index] != STACK_PAINT) {
+		stack_fault = true;
+		servo_frozen = 0x3F;
+	}
+	if(++stack_guard_index >= STACK_GUARD_SIZE)
+		stack_guard_index = 0;
+}
+
+/**
+ * Writes the memory usage to the UART.
+ */
+void printMemoryInfo(void)
+{
+	writeString_P("Static RAM: ");
+	writeInteger(getStaticRAM(), DEC);
+	writeString_P("\nHeap: ");
+	writeInteger(getHeapRAM(), DEC);
+	writeString_P("\nStack max: ");
+	writeInteger(getStackMaxUsed(), DEC);
+	writeString_P("\nNever used: ");
+	writeInteger(getStackUnused(), DEC);
+	writeString_P("\nFree now: ");
+	writeInteger(getFreeRAM(), DEC);
+	if(stack_fault)
+		writeString_P("\nSTACK FAULT!");
+	writeChar('\n');
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ * - v. 1.1 17.10.2026: host simulation support
+ * - v. 1.2 17.10.2026: checkStackGuard checks the highest guard byte
+ *                      every ms, not only every STACK_GUARD_SIZE ms
+ * - v. 1.3 17.10.2026: paintStack uses basic asm only (naked function)
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,49 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmMemory.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * SRAM usage and stack monitor. Detailled description of each function
+ * can be found in the RobotArmMemory.c file!
+ * This file is included by RobotArmBaseLib.h.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMMEMORY_H
+#define ROBOTARMMEMORY_H
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// Memory monitor
+
+#define STACK_PAINT 0xC5	// fill pattern of the unused SRAM
+
+// Bytes between heap and stack that must never be used by the stack:
+#ifndef STACK_GUARD_SIZE
+	#define STACK_GUARD_SIZE 32
+#endif
+
+extern volatile uint8_t stack_fault;
+
+uint16_t getStaticRAM(void);
+uint16_t getHeapRAM(void);
+uint16_t getStackMaxUsed(void);
+uint16_t getStackUnused(void);
+uint16_t getFreeRAM(void);
+
+void checkStackGuard(void);
+void printMemoryInfo(void);
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,738 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmMotion.c
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * Non blocking motion engine. s_Move() moves one servo and blocks the
+ * program until the servo has arrived. The motion engine moves all six
+ * servos at the same time in the background - it is called every
+ * millisecond from the Timer 2 interrupt (motionTick) and moves every
+ * servo a little bit closer to its target.
+ *
+ * Example:
+ *
+ *			// Move servo 2 and 3 at the same time:
+ *			moveTo(2, 300, 2);
+ *			moveTo(3, -200, 1);
+ *			while(isMoving()) {
+ *				// do something useful
+ *			}
+ *			// or simply: waitForMotion();
+ *
+ * Positions are offsets to Start_Position, the same as for Move and
+ * s_Move. The speed is also the same as for s_Move: milliseconds per
+ * PWM count (1 = fastest, 0 = jump to the target immediately).
+ *
+ * Internally the positions are 16.16 fixed point values, so the servos
+ * can also move slower or faster than one count per millisecond.
+ *
+ * Velocity profiles:
+ * By default every servo moves with constant speed (MOTION_CONSTANT), which
+ * means it starts and stops abruptly. With setMotionProfile a servo can
+ * use a trapezoid profile (limited acceleration) or an S-curve profile
+ * (limited acceleration and jerk) instead. Then long moves can use a
+ * much higher top speed, because the servo current is limited by the
+ * acceleration and not by the speed.
+ *
+ *			// Servo 2: up to 2 counts/ms, 0.02 counts/ms^2, S-curve:
+ *			setMotionProfile(2, MOTION_SCURVE, MOTION_FIX(2),
+ *			                 MOTION_FIX(0.02), MOTION_FIX(0.001));
+ *			moveToProfile(2, 600);
+ *
+ * All profile calculations use 16.16 fixed point integers. The profile is
+ * calculated online in every tick: the servo accelerates until it reaches
+ * the top speed or until the remaining distance is the braking distance.
+ * Only multiplications are used for this in the interrupt - no division.
+ *
+ * Synchronized moves:
+ * With moveTo every servo arrives after a time that depends on its own
+ * distance, so the tool moves on a dog-leg path. moveAllTo moves all
+ * servos together: the servo with the longest distance (master) runs its
+ * velocity profile, all other servos follow it proportionally. So all
+ * servos start and arrive in the same tick and the path is the same
+ * every time.
+ *
+ *			int16_t pose[6] = {0, 200, -150, 300, 0, 0};
+ *			moveAllTo(pose, 1);		// longest joint: 1 ms per count
+ *			waitForMotion();
+ *
+ * The limits (speed, acceleration) of the master are reduced once per
+ * move so that no servo exceeds its own limits.
+ *
+ * Waypoint queue:
+ * queueMove works like moveAllTo, but appends the move to a queue of
+ * MOTION_QUEUE_SIZE segments. The next segment starts in the same tick
+ * the previous one arrives, so the host can stream a path while the arm
+ * moves. The segments are planned when they are queued, the interrupt
+ * only has to start them.
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+
+/*****************************************************************************/
+// Variables:
+
+static motion_joint_t motion_joint[MOTION_SERVOS];
+volatile uint8_t motion_active;
+
+static motion_profile_t motion_profile[MOTION_SERVOS] = {
+	{MOTION_CONSTANT, MOTION_FIX(1), MOTION_FIX(0.01), 20},
+	{MOTION_CONSTANT, MOTION_FIX(1), MOTION_FIX(0.01), 20},
+	{MOTION_CONSTANT, MOTION_FIX(1), MOTION_FIX(0.01), 20},
+	{MOTION_CONSTANT, MOTION_FIX(1), MOTION_FIX(0.01), 20},
+	{MOTION_CONSTANT, MOTION_FIX(1), MOTION_FIX(0.01), 20},
+	{MOTION_CONSTANT, MOTION_FIX(1), MOTION_FIX(0.01), 20}
+};
+
+// Synchronized move (s. moveAllTo):
+static volatile uint8_t motion_sync;	// servos following the master
+static motion_segment_t *sync_segment;	// running synchronized move or NULL
+static motion_segment_t sync_direct;	// used by moveAllTo
+
+// Waypoint queue (s. queueMove). A segment stays in the queue until it
+// has finished, head and tail are free running like the UART buffers:
+#define MOTION_QUEUE_MASK (MOTION_QUEUE_SIZE - 1)
+#if (MOTION_QUEUE_SIZE & MOTION_QUEUE_MASK) || MOTION_QUEUE_SIZE > 128
+	#error MOTION_QUEUE_SIZE must be a power of 2 and at most 128!
+#endif
+static motion_segment_t motion_queue[MOTION_QUEUE_SIZE];
+static volatile uint8_t motion_queue_head;
+static volatile uint8_t motion_queue_tail;
+
+static void startSegment(motion_segment_t *seg);
+
+/*****************************************************************************/
+// Motion engine:
+
+/**
+ * Returns true if the servo must start braking now.
+ *
+ * Braking from speed v with deceleration a per tick needs the distance
+ * v^2 / 2a + v / 2 (+ v * jerk_time for the S-curve). Multiplied with 2a:
+ *
+ *		v * (v + a * (1 + 2 * jerk_time)) >= 2 * a * distance
+ *
+ * The values are reduced to 8.8 fixed point so the products fit into
+ * 32 bit. j->brake = a * (1 + 2 * jerk_time) is calculated in startMove.
+ */
+static inline uint8_t isBraking(motion_joint_t *j, int32_t distance)
+{
+	uint32_t v = j->speed >> 8;
+	uint32_t d = distance >> 8;
+
+	if(d > 0xFFFFFUL)
+		return 0;	// far away, not braking
+	return v * (v + j->brake) >= 2 * (uint32_t)(j->accel >> 8) * d;
+}
+
+/**
+ * Calculates one tick of the trapezoid or S-curve profile.
+ */
+static inline void profileTick(motion_joint_t *j, int32_t distance)
+{
+	int32_t goal;	// acceleration we want to have
+	uint8_t braking = 0;
+
+	if(j->speed < 0)				// moving away (target has changed)
+		goal = j->accel;
+	else if((braking = isBraking(j, distance)))
+		goal = -j->accel;
+	else if(j->type == MOTION_SCURVE
+	        && j->speed + j->acc * j->jerk_time / 2 >= j->vmax)
+		goal = 0;					// start to reduce the acceleration
+	else if(j->speed < j->vmax)
+		goal = j->accel;
+	else
+		goal = 0;
+
+	if(j->type == MOTION_SCURVE) {	// change acceleration by jerk
+		if(j->acc < goal) {
+			j->acc += j->jerk;
+			if(j->acc > goal)
+				j->acc = goal;
+		}
+		else if(j->acc > goal) {
+			j->acc -= j->jerk;
+			if(j->acc < goal)
+				j->acc = goal;
+		}
+	}
+	else
+		j->acc = goal;
+
+	j->speed += j->acc;
+	if(j->speed > j->vmax)
+		j->speed = j->vmax;
+	// The braking distance is an estimate - never stop before the target:
+	if(braking && j->speed < j->accel)
+		j->speed = j->accel;
+}
+
+/**
+ * Stops the synchronized move and deletes the waypoint queue - used if
+ * a segment could not be finished (stopped, frozen servo...). The
+ * following segments would start at the wrong position.
+ */
+static void abortSync(void)
+{
+	motion_active &= ~motion_sync;
+	motion_sync = 0;
+	sync_segment = NULL;
+	motion_queue_head = motion_queue_tail;
+}
+
+/**
+ * Moves the servos of a synchronized move to the same fraction of their
+ * distance as the master servo. Called by motionTick after the master
+ * servo has moved. When the move has arrived, the next segment of the
+ * waypoint queue is started in the same tick.
+ */
+static inline void syncTick(void)
+{
+	motion_segment_t *seg = sync_segment;
+	motion_joint_t *m = &motion_joint[seg->master];
+	motion_joint_t *j = motion_joint;
+	uint8_t servo, mask, arrived = false;
+	int32_t progress;
+	uint16_t whole;
+	uint8_t fraction;
+
+	if(!(motion_active & (1 << seg->master))) {
+		if(m->pos != (int32_t)m->target << 16) {	// stopped or frozen
+			abortSync();
+			return;
+		}
+		arrived = true;
+	}
+	progress = m->pos - ((int32_t)seg->start[seg->master] << 16);
+	if(m->target < seg->start[seg->master])
+		progress = -progress;
+	if(progress < 0)
+		progress = 0;
+	whole = progress >> 16;
+	fraction = progress >> 8;
+
+	for(servo = 1, mask = 1; servo <= MOTION_SERVOS; servo++, mask <<= 1, j++) {
+		int16_t pos;
+
+		if(!(motion_sync & mask))
+			continue;
+		if(isServoFrozen(servo)) {
+			motion_sync &= ~mask;
+			motion_active &= ~mask;
+			continue;
+		}
+		if(arrived)
+			pos = j->target;
+		else
+			pos = seg->start[servo - 1]
+			      + (int16_t)(((int32_t)whole * seg->ratio[servo - 1]
+			                   + ((fraction * (int32_t)seg->ratio[servo - 1]) >> 8)
+			                   + 0x4000) >> 15);
+		if(pos != (int16_t)(j->pos >> 16)) {
+			j->pos = (int32_t)pos << 16;
+			setServoOffset(servo, pos);
+		}
+	}
+	if(arrived) {
+		motion_active &= ~motion_sync;
+		motion_sync = 0;
+		sync_segment = NULL;
+		if(seg == &motion_queue[motion_queue_tail & MOTION_QUEUE_MASK])
+			motion_queue_tail++;
+		if(motion_queue_head != motion_queue_tail)
+			startSegment(&motion_queue[motion_queue_tail & MOTION_QUEUE_MASK]);
+	}
+}
+
+/**
+ * Moves all active servos one step. Called every millisecond from the
+ * Timer 2 interrupt - don't call it yourself!
+ */
+void motionTick(void)
+{
+	uint8_t servo, mask;
+	motion_joint_t *j = motion_joint;
+
+	if(!motion_active) {
+		// Waypoints queued while other moves were running:
+		if(motion_queue_head != motion_queue_tail && !sync_segment)
+			startSegment(&motion_queue[motion_queue_tail & MOTION_QUEUE_MASK]);
+		return;
+	}
+	for(servo = 1, mask = 1; servo <= MOTION_SERVOS; servo++, mask <<= 1, j++) {
+		int16_t old;
+		int32_t diff, distance;
+		int8_t dir;
+
+		if(!(motion_active & mask) || (motion_sync & mask))
+			continue;
+		if(isServoFrozen(servo)) {	// stopped by the overcurrent protection
+			motion_active &= ~mask;
+			continue;
+		}
+		old = j->pos >> 16;
+		diff = ((int32_t)j->target << 16) - j->pos;
+		dir = (diff < 0) ? -1 : 1;
+		distance = (diff < 0) ? -diff : diff;
+		if(dir != j->dir) {			// speed is relative to the direction
+			j->dir = dir;
+			j->speed = -j->speed;
+			j->acc = -j->acc;
+		}
+
+		if(j->type == MOTION_CONSTANT)
+			j->speed = j->vmax;
+		else
+			profileTick(j, distance);
+
+		if(j->speed >= distance) {	// arrived
+			j->pos = (int32_t)j->target << 16;
+			j->speed = 0;
+			j->acc = 0;
+			motion_active &= ~mask;
+		}
+		else
+			j->pos += (dir > 0) ? j->speed : -j->speed;
+
+		if((int16_t)(j->pos >> 16) != old)
+			setServoOffset(servo, j->pos >> 16);
+	}
+	if(sync_segment)
+		syncTick();
+}
+
+/**
+ * Sets the velocity profile of a servo:
+ *  type  - MOTION_CONSTANT, MOTION_TRAPEZOID or MOTION_SCURVE
+ *  vmax  - top speed for moveToProfile, 16.16 counts per ms
+ *  accel - 16.16 counts per ms^2
+ *  jerk  - 16.16 counts per ms^3 (S-curve only)
+ * Use MOTION_FIX() for the values. They are limited to MOTION_VMAX_MAX,
+ * MOTION_ACCEL_MIN..MOTION_ACCEL_MAX and a jerk time (accel / jerk) of
+ * 1..MOTION_JERK_TIME_MAX ms.
+ */
+void setMotionProfile(uint8_t servo, uint8_t type, int32_t vmax, int32_t accel, int32_t jerk)
+{
+	motion_profile_t *p;
+	int32_t jerk_time;
+
+	if(servo < 1 || servo > MOTION_SERVOS)
+		return;
+	p = &motion_profile[servo - 1];
+	if(vmax < 1) vmax = 1;
+	if(vmax > MOTION_VMAX_MAX) vmax = MOTION_VMAX_MAX;
+	if(accel < MOTION_ACCEL_MIN) accel = MOTION_ACCEL_MIN;
+	if(accel > MOTION_ACCEL_MAX) accel = MOTION_ACCEL_MAX;
+	jerk_time = (jerk > 0) ? accel / jerk : MOTION_JERK_TIME_MAX;
+	if(jerk_time < 1) jerk_time = 1;
+	if(jerk_time > MOTION_JERK_TIME_MAX) jerk_time = MOTION_JERK_TIME_MAX;
+
+	p->type = type;
+	p->vmax = vmax;
+	p->accel = accel;
+	p->jerk_time = jerk_time;
+}
+
+/**
+ * Removes a servo from the synchronized move. If it is the master, the
+ * other servos stop where they are. Call with interrupts disabled.
+ */
+static void leaveSync(uint8_t servo)
+{
+	if(!sync_segment)
+		return;
+	if(servo - 1 == sync_segment->master)
+		abortSync();
+	else
+		motion_sync &= ~(1 << (servo - 1));
+}
+
+/**
+ * Starts a move with the given limits - used by moveTo & co.
+ */
+static void startMove(uint8_t servo, int16_t target, uint8_t type,
+                      int32_t vmax, int32_t accel, uint8_t jerk_time)
+{
+	motion_joint_t *j;
+	uint8_t mask;
+
+	if(servo < 1 || servo > MOTION_SERVOS || isServoFrozen(servo))
+		return;
+	j = &motion_joint[servo - 1];
+	mask = 1 << (servo - 1);
+	if(vmax < 1)
+		vmax = 1;
+	if(accel < 256)
+		accel = 256;	// isBraking needs at least 1 in 8.8
+	if(type != MOTION_SCURVE)
+		jerk_time = 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		leaveSync(servo);
+		if(!(motion_active & mask)) {	// someone may have used Move() meanwhile
+			j->pos = (int32_t)getServoOffset(servo) << 16;
+			j->speed = 0;
+			j->acc = 0;
+		}
+		j->target = target;
+		j->type = type;
+		j->vmax = vmax;
+		j->accel = accel;
+		j->jerk_time = jerk_time;
+		j->jerk = jerk_time ? accel / jerk_time : accel;
+		j->brake = (uint32_t)(accel >> 8) * (1 + 2 * jerk_time);
+		motion_active |= mask;
+	}
+}
+
+/**
+ * Starts to move a servo to target (offset to Start_Position) and returns
+ * immediately. speed is in milliseconds per PWM count like for s_Move,
+ * speed = 0 sets the servo to the target immediately.
+ * If the servo has a trapezoid or S-curve profile, it is used with a top
+ * speed of 1/speed counts per ms (or the profile top speed if lower).
+ * If the servo is already moving, it continues from its current position
+ * to the new target.
+ */
+void moveTo(uint8_t servo, int16_t target, uint16_t speed)
+{
+	motion_profile_t *p;
+	int32_t vmax;
+
+	if(servo < 1 || servo > MOTION_SERVOS)
+		return;
+	if(!speed) {
+		stopServoMotion(servo);
+		setServoOffset(servo, target);
+		return;
+	}
+	p = &motion_profile[servo - 1];
+	vmax = 65536L / speed;
+	if(p->type != MOTION_CONSTANT && p->vmax < vmax)
+		vmax = p->vmax;
+	startMove(servo, target, p->type, vmax, p->accel, p->jerk_time);
+}
+
+/**
+ * Same as moveTo, but uses the top speed of the profile of the servo
+ * (s. setMotionProfile) - this can be faster than 1 count per ms.
+ */
+void moveToProfile(uint8_t servo, int16_t target)
+{
+	motion_profile_t *p;
+
+	if(servo < 1 || servo > MOTION_SERVOS)
+		return;
+	p = &motion_profile[servo - 1];
+	startMove(servo, target, p->type, p->vmax, p->accel, p->jerk_time);
+}
+
+/**
+ * Returns limit * longest / distance (>= limit) without 32 bit overflow.
+ * Converts the limit of a servo to the limit of the master servo.
+ */
+static int32_t scaleLimit(int32_t limit, uint16_t longest, uint16_t distance)
+{
+	uint32_t q = limit / distance;
+	uint32_t r = limit % distance;
+
+	if(q >= 0x3FFFFFFFUL / longest)
+		return 0x3FFFFFFF;
+	return q * longest + r * longest / distance;
+}
+
+/**
+ * Calculates the synchronized move from seg->start to seg->target:
+ * the master servo, its limits and the ratios of the other servos.
+ * Returns false if no servo has to move.
+ */
+static uint8_t planSegment(motion_segment_t *seg, uint16_t speed)
+{
+	uint16_t distance[MOTION_SERVOS];
+	uint16_t longest = 0;
+	int32_t limit;
+	uint8_t i;
+	motion_profile_t *p;
+
+	seg->master = 0;
+	seg->moving = 0;
+	for(i = 0; i < MOTION_SERVOS; i++) {
+		int16_t delta = seg->target[i] - seg->start[i];
+		distance[i] = (delta < 0) ? -delta : delta;
+		if(distance[i]) {
+			seg->moving |= 1 << i;
+			if(distance[i] > longest) {
+				longest = distance[i];
+				seg->master = i;
+			}
+		}
+	}
+	if(!longest)
+		return false;
+
+	seg->type = MOTION_CONSTANT;
+	seg->vmax = MOTION_VMAX_MAX;
+	seg->accel = MOTION_ACCEL_MAX;
+	seg->jerk_time = 0;
+	for(i = 0, p = motion_profile; i < MOTION_SERVOS; i++, p++) {
+		seg->ratio[i] = 0;
+		if(!distance[i])
+			continue;
+		// distance / longest in 1.15, limited to fit into int16:
+		seg->ratio[i] = (distance[i] == longest) ? 32767 : ((int32_t)distance[i] << 15) / longest;
+		if(seg->target[i] < seg->start[i])
+			seg->ratio[i] = -seg->ratio[i];
+
+		limit = speed ? 65536L / speed : p->vmax;
+		if(speed && p->type != MOTION_CONSTANT && p->vmax < limit)
+			limit = p->vmax;
+		limit = scaleLimit(limit, longest, distance[i]);
+		if(limit < seg->vmax)
+			seg->vmax = limit;
+		if(p->type == MOTION_CONSTANT)
+			continue;
+		limit = scaleLimit(p->accel, longest, distance[i]);
+		if(limit < seg->accel)
+			seg->accel = limit;
+		if(p->type > seg->type)
+			seg->type = p->type;
+		if(p->type == MOTION_SCURVE && p->jerk_time > seg->jerk_time)
+			seg->jerk_time = p->jerk_time;
+	}
+	return true;
+}
+
+/**
+ * Starts a planned synchronized move. If a servo is not at the start
+ * position of the segment, the move and the waypoint queue are aborted.
+ * Called from motionTick for queued segments, so this must be fast.
+ */
+static void startSegment(motion_segment_t *seg)
+{
+	motion_joint_t *j = motion_joint;
+	uint8_t i, mask;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		sync_segment = NULL;
+		for(i = 0, mask = 1; i < MOTION_SERVOS; i++, mask <<= 1)
+			if((seg->moving & mask) && getServoOffset(i + 1) != seg->start[i]) {
+				abortSync();
+				return;
+			}
+		startMove(seg->master + 1, seg->target[seg->master], seg->type,
+		          seg->vmax, seg->accel, seg->jerk_time);
+		sync_segment = seg;
+		for(i = 0, mask = 1; i < MOTION_SERVOS; i++, mask <<= 1, j++) {
+			if(i == seg->master || !(seg->moving & mask))
+				continue;
+			j->pos = (int32_t)seg->start[i] << 16;
+			j->target = seg->target[i];
+			j->speed = 0;
+			j->acc = 0;
+			motion_sync |= mask;
+			motion_active |= mask;
+		}
+	}
+}
+
+/**
+ * Moves all six servos to targets[0..5] (offsets to Start_Position) so
+ * that they start and arrive at the same time. Returns immediately.
+ * speed is in milliseconds per PWM count for the servo with the longest
+ * distance, the other servos are slower. With speed = 0 the top speeds
+ * of the profiles (s. setMotionProfile) are used.
+ * The move uses the smoothest profile of all moving servos, and the
+ * acceleration is reduced so that every servo stays within its own
+ * profile. Running moves and the waypoint queue are stopped first,
+ * frozen servos don't move.
+ */
+void moveAllTo(const int16_t *targets, uint16_t speed)
+{
+	uint8_t i;
+
+	stopMotion();
+	for(i = 0; i < MOTION_SERVOS; i++) {
+		sync_direct.start[i] = getServoPosition(i + 1);
+		sync_direct.target[i] = isServoFrozen(i + 1) ? sync_direct.start[i] : targets[i];
+	}
+	if(planSegment(&sync_direct, speed))
+		startSegment(&sync_direct);
+}
+
+/**
+ * Appends a synchronized move (like moveAllTo) to the waypoint queue and
+ * returns immediately. The segment starts at the end of the previous
+ * segment - in the same tick the previous segment arrives, so a path
+ * of waypoints is executed without pauses.
+ * Returns false if the queue is full (s. getMotionQueueFree).
+ *
+ * Example:
+ *
+ *			for(i = 0; i < points; i++)
+ *				while(!queueMove(path[i], 2))
+ *					task_protocol();	// queue full - do something else
+ *
+ * If a segment can not be finished (stopServoMotion, moveTo or Move on a
+ * servo of the segment, overcurrent...) the whole queue is deleted.
+ */
+uint8_t queueMove(const int16_t *targets, uint16_t speed)
+{
+	motion_segment_t *seg;
+	uint8_t i;
+
+	if(!getMotionQueueFree())
+		return false;
+	// Only this function writes to the head - the slot stays free:
+	seg = &motion_queue[motion_queue_head & MOTION_QUEUE_MASK];
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		for(i = 0; i < MOTION_SERVOS; i++) {
+			if(motion_queue_head != motion_queue_tail)	// end of the previous segment
+				seg->start[i] = motion_queue[(motion_queue_head - 1) & MOTION_QUEUE_MASK].target[i];
+			else if(motion_active & (1 << i))
+				seg->start[i] = motion_joint[i].target;
+			else
+				seg->start[i] = getServoOffset(i + 1);
+			seg->target[i] = targets[i];
+		}
+	}
+	if(planSegment(seg, speed))
+		motion_queue_head++;	// started by motionTick
+	return true;
+}
+
+/**
+ * Returns the number of free entries in the waypoint queue.
+ */
+uint8_t getMotionQueueFree(void)
+{
+	return MOTION_QUEUE_SIZE - (uint8_t)(motion_queue_head - motion_queue_tail);
+}
+
+/**
+ * Deletes all waypoints that have not been started yet. The running
+ * segment is finished.
+ */
+void clearMotionQueue(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		motion_queue_head = motion_queue_tail;
+		if(sync_segment == &motion_queue[motion_queue_tail & MOTION_QUEUE_MASK])
+			motion_queue_head++;
+	}
+}
+
+/**
+ * Stops a servo at its current position.
+ */
+void stopServoMotion(uint8_t servo)
+{
+	if(servo < 1 || servo > MOTION_SERVOS)
+		return;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		leaveSync(servo);
+		motion_active &= ~(1 << (servo - 1));
+	}
+}
+
+/**
+ * Stops a servo and the synchronized move it belongs to, including the
+ * waypoint queue - the other servos of the move must not go on without
+ * it. Used by the overcurrent protection (OC_BACKOFF).
+ */
+void abortServoMotion(uint8_t servo)
+{
+	uint8_t mask;
+
+	if(servo < 1 || servo > MOTION_SERVOS)
+		return;
+	mask = 1 << (servo - 1);
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if((motion_sync & mask) || (sync_segment && servo - 1 == sync_segment->master))
+			abortSync();
+		motion_active &= ~mask;
+	}
+}
+
+/**
+ * Stops all servos at their current positions and deletes the waypoint
+ * queue.
+ */
+void stopMotion(void)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		motion_active = 0;
+		motion_sync = 0;
+		sync_segment = NULL;
+		motion_queue_head = motion_queue_tail;
+	}
+}
+
+/**
+ * Returns the current position of a servo (offset to Start_Position).
+ */
+int16_t getServoPosition(uint8_t servo)
+{
+	int16_t pos;
+	if(servo < 1 || servo > MOTION_SERVOS)
+		return 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		pos = getServoOffset(servo);
+	}
+	return pos;
+}
+
+/**
+ * Waits until all servos have arrived at their targets.
+ */
+void waitForMotion(void)
+{
+	while(isMoving()) {
+		task_scheduler();
+		idle();
+	}
+}
+
+/**
+ * Waits until the servo has arrived at its target.
+ */
+void waitForServo(uint8_t servo)
+{
+	while(isServoMoving(servo)) {
+		task_scheduler();
+		idle();
+	}
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ * - v. 1.1 17.10.2026: trapezoid and S-curve velocity profiles
+ * - v. 1.2 17.10.2026: synchronized moves (moveAllTo)
+ * - v. 1.3 17.10.2026: waypoint queue (queueMove)
+ * - v. 1.4 17.10.2026: waitForMotion/waitForServo run the scheduler and sleep
+ * - v. 1.5 17.10.2026: abortServoMotion for the overcurrent protection
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,109 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmMotion.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * Non blocking motion engine for all six servos. Detailled description
+ * of each function can be found in the RobotArmMotion.c file!
+ * This file is included by RobotArmBaseLib.h.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMMOTION_H
+#define ROBOTARMMOTION_H
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// Motion engine
+
+#define MOTION_SERVOS 6
+
+// Velocity profiles:
+#define MOTION_CONSTANT		0	// constant speed like s_Move (default)
+#define MOTION_TRAPEZOID	1	// acceleration limited
+#define MOTION_SCURVE		2	// acceleration and jerk limited
+
+// 16.16 fixed point constant, e.g. MOTION_FIX(0.05). Use this for
+// constants only - the compiler calculates it, no float code is used!
+#define MOTION_FIX(__X__) ((int32_t)((__X__) * 65536.0 + 0.5))
+
+// Limits of the profile parameters (16.16 fixed point):
+#define MOTION_VMAX_MAX		MOTION_FIX(64)		// counts/ms
+#define MOTION_ACCEL_MIN	MOTION_FIX(0.004)	// counts/ms^2
+#define MOTION_ACCEL_MAX	MOTION_FIX(4)
+#define MOTION_JERK_TIME_MAX 100				// accel / jerk in ms
+
+typedef struct {
+	uint8_t type;		// MOTION_xxx
+	int32_t vmax;		// 16.16 counts per ms
+	int32_t accel;		// 16.16 counts per ms^2
+	uint8_t jerk_time;	// accel / jerk in ms (S-curve only)
+} motion_profile_t;
+
+typedef struct {
+	int32_t pos;		// 16.16 fixed point offset to Start_Position
+	int32_t speed;		// 16.16 counts per ms in direction of the target
+	int32_t acc;		// 16.16 counts per ms^2 in direction of the target
+	int32_t vmax;		// limits of the current move
+	int32_t accel;
+	int32_t jerk;
+	uint32_t brake;		// factor for the braking distance, s. isBraking
+	int16_t target;		// offset to Start_Position
+	int8_t dir;			// +1 / -1
+	uint8_t jerk_time;
+	uint8_t type;
+} motion_joint_t;
+
+// Synchronized move from start to target, s. moveAllTo and queueMove:
+typedef struct {
+	int16_t start[MOTION_SERVOS];
+	int16_t target[MOTION_SERVOS];
+	int16_t ratio[MOTION_SERVOS];	// distance / master distance, 1.15
+	int32_t vmax;			// limits of the master servo
+	int32_t accel;
+	uint8_t master;			// 0..5, servo with the longest distance
+	uint8_t moving;			// bit 0 = servo 1 moves
+	uint8_t type;
+	uint8_t jerk_time;
+} motion_segment_t;
+
+// Number of waypoints (power of 2), every entry needs 48 bytes RAM:
+#ifndef MOTION_QUEUE_SIZE
+	#define MOTION_QUEUE_SIZE 8
+#endif
+
+extern volatile uint8_t motion_active;	// bit 0 = servo 1 is moving
+
+void motionTick(void);
+
+void setMotionProfile(uint8_t servo, uint8_t type, int32_t vmax, int32_t accel, int32_t jerk);
+void moveTo(uint8_t servo, int16_t target, uint16_t speed);
+void moveToProfile(uint8_t servo, int16_t target);
+void moveAllTo(const int16_t *targets, uint16_t speed);
+uint8_t queueMove(const int16_t *targets, uint16_t speed);
+uint8_t getMotionQueueFree(void);
+void clearMotionQueue(void);
+void stopServoMotion(uint8_t servo);
+void abortServoMotion(uint8_t servo);
+void stopMotion(void);
+int16_t getServoPosition(uint8_t servo);
+
+#define isMoving() (motion_active)
+#define isServoMoving(__SERVO__) (motion_active & (1 << ((__SERVO__) - 1)))
+
+void waitForMotion(void);
+void waitForServo(uint8_t servo);
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,167 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmPins.cpp
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz (avr-g++ -std=gnu++11)
+ * ****************************************************************************
+ * Description:
+ * The pin functions of the C API (LEDs, servo power, port init),
+ * implemented with the templates of RobotArmPins.hpp. The prototypes are
+ * in RobotArmBaseLib.h, nothing changes for C programs - except that
+ * every function is now a single atomic port access.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmPins.hpp"
+
+using namespace robotarm;
+
+extern "C" {
+void initPorts(void);
+void setLEDs(uint8_t leds);
+void setLED1(uint8_t led);
+void setLED2(uint8_t led);
+void setLED3(uint8_t led);
+void setLED4(uint8_t led);
+void PowerLEDred(void);
+void PowerLEDgreen(void);
+void PowerLEDorange(void);
+void PowerLEDoff(void);
+void Power_Servos(void);
+void Power_Off_Servos(void);
+}
+
+/*****************************************************************************/
+// Port init:
+
+/**
+ * Sets direction and initial value of all ports for the board revision
+ * the library is built for (portInit_v3() or portInit()).
+ */
+void initPorts(void)
+{
+#if ROBOT_ARM_V3
+	initPort<PortA>(INIT_DDRA_v3, INIT_PRTA_v3);
+	initPort<PortB>(INIT_DDRB_v3, INIT_PRTB_v3);
+	initPort<PortC>(INIT_DDRC_v3, INIT_PRTC_v3);
+	initPort<PortD>(INIT_DDRD_v3, INIT_PRTD_v3);
+	initPort<PortE>(INIT_DDRE_v3, INIT_PRTE_v3);
+	initPort<PortF>(INIT_DDRF_v3, INIT_PRTF_v3);
+	initPort<PortG>(INIT_DDRG_v3, INIT_PRTG_v3);
+#else
+	initPort<PortA>(INIT_DDRA, INIT_PRTA);
+	initPort<PortB>(INIT_DDRB, INIT_PRTB);
+	initPort<PortC>(INIT_DDRC, INIT_PRTC);
+	initPort<PortD>(INIT_DDRD, INIT_PRTD);
+	initPort<PortE>(INIT_DDRE, INIT_PRTE);
+	initPort<PortF>(INIT_DDRF, INIT_PRTF);
+	initPort<PortG>(INIT_DDRG, INIT_PRTG);
+#endif
+}
+
+/*****************************************************************************/
+// 4 blue Status LEDs (SL1 - SL4) for Robot Arm v3:
+
+/**
+ * Set the 4 Status LEDs that are connected to the Microcontroller
+ *
+ * Example:
+ *  setLEDs(0b1111); // All LEDs on
+ *  setLEDs(0b0011); // LED1 + 2 on, LED3 + 4 off
+ */
+void setLEDs(uint8_t leds)
+{
+	StatusLEDs::write(leds);
+}
+
+/**
+ * Set ONLY LED1, don't change anything for the other LEDs.
+ */
+void setLED1(uint8_t led)
+{
+	StatusLED1::write(led);
+}
+
+/**
+ * Set ONLY LED2, don't change anything for the other LEDs.
+ */
+void setLED2(uint8_t led)
+{
+	StatusLED2::write(led);
+}
+
+/**
+ * Set ONLY LED3, don't change anything for the other LEDs.
+ */
+void setLED3(uint8_t led)
+{
+	StatusLED3::write(led);
+}
+
+/**
+ * Set ONLY LED4, don't change anything for the other LEDs.
+ */
+void setLED4(uint8_t led)
+{
+	StatusLED4::write(led);
+}
+
+/*****************************************************************************/
+// Duo LED red+green for old Robot Arm PCBs:
+
+void PowerLEDred(void)
+{
+	PowerLED::write(0b01);
+}
+
+void PowerLEDgreen(void)
+{
+	PowerLED::write(0b10);
+}
+
+void PowerLEDorange(void)
+{
+	PowerLED::write(0b11);
+}
+
+void PowerLEDoff(void)
+{
+	PowerLED::write(0b00);
+}
+
+/*****************************************************************************/
+// Servo power:
+
+void Power_Servos(void)
+{
+	ServoPower::on();
+}
+
+void Power_Off_Servos(void)
+{
+	ServoPower::off();
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
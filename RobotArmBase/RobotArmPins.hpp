@@ -0,0 +1,239 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmPins.hpp
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz (avr-g++ -std=gnu++11)
+ * ****************************************************************************
+ * Description:
+ * Header only C++ types for the I/O ports and pins of the board. All
+ * port addresses and bit masks are template parameters, so every access
+ * compiles to the same instructions as the hand written C code - or
+ * better:
+ *
+ *  - A single pin on PORTA..PORTE is set with one sbi/cbi instruction.
+ *  - A PinGroup changes several pins of one port with a single
+ *    read-modify-write, with disabled interrupts if it can not be done
+ *    in one instruction (PORTF, PORTG or more than one pin). So an
+ *    interrupt can not lose or see half of an update.
+ *  - Pins can be active low, on()/off() know the polarity.
+ *
+ * Example:
+ *
+ *		using namespace robotarm;
+ *		StatusLED2::on();				// sbi/cbi or atomic RMW
+ *		StatusLEDs::write(0b0101);		// LED1 + 3 on, 2 + 4 off at once
+ *		if(ExtIn1::read())
+ *			ExtOut1::toggle();
+ *
+ * The C functions of the library (setLEDs, Power_Servos, ...) are thin
+ * wrappers around these types, s. RobotArmPins.cpp.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMPINS_HPP
+#define ROBOTARMPINS_HPP
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+#include "RobotArmBase.h"
+
+namespace robotarm {
+
+/*****************************************************************************/
+// Helpers:
+
+/**
+ * Disables the interrupts until the end of the scope, then restores the
+ * I bit (like ATOMIC_BLOCK(ATOMIC_RESTORESTATE) in C).
+ */
+class AtomicSection {
+public:
+	AtomicSection() : sreg(SREG) { cli(); }
+	~AtomicSection() { SREG = sreg; }
+private:
+	uint8_t sreg;
+};
+
+template<class T1, class T2> struct IsSame { static const bool value = false; };
+template<class T> struct IsSame<T, T> { static const bool value = true; };
+
+/*****************************************************************************/
+// Ports:
+
+// BIT_ACCESS: PORTx and DDRx are in the lower I/O space, so sbi/cbi work.
+#define ROBOTARM_PORT(__NAME__, __LETTER__, __BIT_ACCESS__) \
+	struct __NAME__ { \
+		static volatile uint8_t &port() { return PORT##__LETTER__; } \
+		static volatile uint8_t &ddr() { return DDR##__LETTER__; } \
+		static volatile uint8_t &pin() { return PIN##__LETTER__; } \
+		static const bool bitAccess = __BIT_ACCESS__; \
+	}
+
+ROBOTARM_PORT(PortA, A, true);
+ROBOTARM_PORT(PortB, B, true);
+ROBOTARM_PORT(PortC, C, true);
+ROBOTARM_PORT(PortD, D, true);
+ROBOTARM_PORT(PortE, E, true);
+ROBOTARM_PORT(PortF, F, false);
+ROBOTARM_PORT(PortG, G, false);
+
+/**
+ * Writes the bits of MASK in a register and keeps all others. bits must
+ * not have bits outside of MASK. The MASK is constant, so only one
+ * of the three cases is compiled.
+ */
+template<bool BIT_ACCESS, uint8_t MASK>
+static inline void writeMasked(volatile uint8_t &reg, uint8_t bits)
+{
+	if(MASK == 0xFF)
+		reg = bits;
+	else if(BIT_ACCESS && (MASK & (MASK - 1)) == 0) {
+		if(bits)
+			reg |= MASK;		// sbi
+		else
+			reg &= ~MASK;		// cbi
+	}
+	else {
+		AtomicSection atomic;
+		reg = (reg & ~MASK) | bits;
+	}
+}
+
+/**
+ * Sets all pins of a port at once: output value (or pull-up for inputs)
+ * first, then the direction - like portInit().
+ */
+template<class PORT>
+static inline void initPort(uint8_t ddr, uint8_t port)
+{
+	PORT::port() = port;
+	PORT::ddr() = ddr;
+}
+
+/*****************************************************************************/
+// Pins:
+
+template<class PORT, uint8_t BIT, bool ACTIVE_LOW = false>
+struct Pin {
+	typedef PORT Port;
+	static const uint8_t mask = 1 << BIT;
+	static const uint8_t onBits = ACTIVE_LOW ? 0 : mask;	// PORTx bits for on
+	static const uint8_t offBits = ACTIVE_LOW ? mask : 0;
+
+	static void set() { writeMasked<PORT::bitAccess, mask>(PORT::port(), mask); }
+	static void clear() { writeMasked<PORT::bitAccess, mask>(PORT::port(), 0); }
+	static void on() { writeMasked<PORT::bitAccess, mask>(PORT::port(), onBits); }
+	static void off() { writeMasked<PORT::bitAccess, mask>(PORT::port(), offBits); }
+	static void write(bool state) { if(state) on(); else off(); }
+
+	static void toggle()
+	{
+		AtomicSection atomic;
+		PORT::port() ^= mask;	// the ATmega64 can not toggle with PINx
+	}
+
+	static bool read() { return ((PORT::pin() & mask) != 0) != ACTIVE_LOW; }
+
+	static void output() { writeMasked<PORT::bitAccess, mask>(PORT::ddr(), mask); }
+	static void input() { writeMasked<PORT::bitAccess, mask>(PORT::ddr(), 0); }
+};
+
+/*****************************************************************************/
+// Pin groups:
+
+template<class PORT, class... PINS> struct OnPort {
+	static const bool value = true;
+};
+template<class PORT, class FIRST, class... REST> struct OnPort<PORT, FIRST, REST...> {
+	static const bool value = IsSame<PORT, typename FIRST::Port>::value
+		&& OnPort<PORT, REST...>::value;
+};
+
+template<class... PINS> struct PinBits {
+	static const uint8_t mask = 0;
+	static uint8_t bits(uint8_t) { return 0; }
+	static uint8_t value(uint8_t) { return 0; }
+};
+template<class FIRST, class... REST> struct PinBits<FIRST, REST...> {
+	static const uint8_t mask = FIRST::mask | PinBits<REST...>::mask;
+	// bit 0 of value is FIRST, bit 1 the next pin ...
+	static uint8_t bits(uint8_t value)
+	{
+		return ((value & 1) ? FIRST::onBits : FIRST::offBits)
+			| PinBits<REST...>::bits(value >> 1);
+	}
+	static uint8_t value(uint8_t pins)
+	{
+		return (((pins & FIRST::mask) == FIRST::onBits) ? 1 : 0)
+			| (PinBits<REST...>::value(pins) << 1);
+	}
+};
+
+/**
+ * Several pins of one port that are always written together. Bit 0 of
+ * a value is the first pin, bit 1 the second and so on.
+ */
+template<class FIRST, class... REST>
+struct PinGroup {
+	typedef typename FIRST::Port Port;
+	typedef PinBits<FIRST, REST...> Bits;
+	static const uint8_t mask = Bits::mask;
+
+	static_assert(OnPort<Port, REST...>::value, "all pins of a PinGroup must be on the same port");
+
+	static void write(uint8_t value) { writeMasked<Port::bitAccess, mask>(Port::port(), Bits::bits(value)); }
+	static void allOn() { write(0xFF); }
+	static void allOff() { write(0); }
+	static uint8_t read() { return Bits::value(Port::pin()); }
+	static void output() { writeMasked<Port::bitAccess, mask>(Port::ddr(), mask); }
+	static void input() { writeMasked<Port::bitAccess, mask>(Port::ddr(), 0); }
+};
+
+/*****************************************************************************/
+// Pins of the board (s. RobotArmBase.h):
+
+typedef Pin<PortB, PINB5> Servo1PWM;
+typedef Pin<PortB, PINB6> Servo2PWM;
+typedef Pin<PortB, PINB7> Servo3PWM;
+typedef Pin<PortE, PINE3> Servo4PWM;
+typedef Pin<PortE, PINE4> Servo5PWM;
+typedef Pin<PortE, PINE5> Servo6PWM;
+
+// SLED1..4 - on the old PCBs PG3 is the servo power instead:
+typedef Pin<PortG, PING0> StatusLED1;
+typedef Pin<PortG, PING1> StatusLED2;
+typedef Pin<PortG, PING2> StatusLED3;
+typedef Pin<PortG, PING3> StatusLED4;
+typedef PinGroup<StatusLED1, StatusLED2, StatusLED3, StatusLED4> StatusLEDs;
+
+#if ROBOT_ARM_V3
+typedef Pin<PortG, PING4> ServoPower;
+
+typedef Pin<PortA, PINA0> ExtOut1;
+typedef Pin<PortA, PINA1> ExtOut2;
+typedef Pin<PortA, PINA2> ExtOut3;
+typedef Pin<PortA, PINA3> ExtOut4;
+typedef Pin<PortA, PINA4> ExtIn1;
+typedef Pin<PortA, PINA5> ExtIn2;
+typedef Pin<PortA, PINA6> ExtIn3;
+typedef Pin<PortA, PINA7> ExtIn4;
+#else
+typedef Pin<PortG, PING3, true> ServoPower;		// low = power on
+#endif
+
+// Duo LED red + green of the old PCBs, the same pins as StatusLED1 + 2:
+typedef Pin<PortG, PING0> PowerLEDRed;
+typedef Pin<PortG, PING1> PowerLEDGreen;
+typedef PinGroup<PowerLEDRed, PowerLEDGreen> PowerLED;
+
+}
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,387 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmPoses.c
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * Pose library. The EEPROM holds POSES named poses and SEQUENCES named
+ * sequences of poses (s. RobotArmEEPROM.c), so the arm can run a work
+ * cycle on its own instead of receiving every pose from the host.
+ *
+ * A pose is the servo pulse of all six servos (Pos_Servo_1..6), not the
+ * offset to Start_Position - it stays the same physical pose when the
+ * servos are calibrated again.
+ *
+ * Teach mode: move the arm to the pose (moveTo, s_Move, MSG_MOVE_REL ...)
+ * and store where it is now:
+ *
+ *			teachPose(0, "home");
+ *			s_Move(2, 300, 2);
+ *			teachPose(1, "pick");
+ *
+ * A sequence is a list of up to SEQUENCE_STEPS poses, each with its own
+ * speed (ms per count like moveAllTo) and a dwell time after the arrival.
+ * Playback feeds the steps into the waypoint queue of the motion engine
+ * (queueMove), so the arm moves through steps without dwell time without
+ * stopping:
+ *
+ * Example:
+ *
+ *			pose_sequence_t s = {"cycle", 3, {
+ *				{1, 2, 50},		// "pick" with 2ms per count, wait 0.5s
+ *				{0, 0, 0},		// "home" with the motion profiles
+ *				{2, 3, 0}}};
+ *			saveSequence(0, &s);
+ *			...
+ *			playSequence(findSequence("cycle"), 10, 0);	// 10 times
+ *			while(isPlaying())
+ *				mSleep(10);
+ *
+ * The speed of playSequence overrides the speed of all steps, so a cycle
+ * can be tested slowly first. Playback runs in task_playback, which
+ * playSequence adds to the scheduler (s. RobotArmScheduler.c) - it only
+ * runs while your program calls task_scheduler, mSleep, waitForMotion...
+ * playSequence reads all poses of the sequence from the EEPROM, so the
+ * playback never waits for the EEPROM and poses that are changed in the
+ * meantime are used the next time the sequence is started.
+ *
+ * Poses and sequences are written in the background like the
+ * calibration. They only have one EEPROM slot each: if the power fails
+ * while one is saved, this one is lost (EE_NOT_FOUND), all others
+ * are still valid.
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+
+_Static_assert(sizeof(pose_t) == EE_POSE_SIZE, "EE_POSE_SIZE must be sizeof(pose_t)!");
+_Static_assert(sizeof(pose_sequence_t) == EE_SEQUENCE_SIZE, "EE_SEQUENCE_SIZE must be sizeof(pose_sequence_t)!");
+
+/*****************************************************************************/
+// Variables:
+
+#define PLAY_OFF		0
+#define PLAY_QUEUE		1	// steps are appended to the waypoint queue
+#define PLAY_ARRIVE		2	// waiting for the arrival before a dwell time
+#define PLAY_DWELL		3
+#define PLAY_FINISH		4	// all steps queued, waiting for the arrival
+
+static pose_sequence_t play_sequence;
+static int16_t play_targets[SEQUENCE_STEPS][MOTION_SERVOS];	// of each step
+static uint8_t play_state;
+static uint8_t play_step;		// next step to queue
+static uint8_t play_repeat;		// runs left, 0 = endless
+static uint16_t play_speed;
+static uint8_t play_dwell;
+static uint16_t play_time;
+static uint8_t play_task = NO_TASK;
+
+/*****************************************************************************/
+// Poses:
+
+/**
+ * Loads a pose. Returns EE_OK, EE_NOT_FOUND or EE_BAD_PARAM.
+ */
+uint8_t loadPose(uint8_t pose, pose_t *p)
+{
+	if(pose >= POSES)
+		return EE_BAD_PARAM;
+	return loadRecord(EE_AREA_POSE(pose), p, sizeof(pose_t));
+}
+
+/**
+ * Saves a pose. Waits until the previous record is written, then the
+ * pose is written in the background. Returns EE_OK or EE_BAD_PARAM.
+ */
+uint8_t savePose(uint8_t pose, const pose_t *p)
+{
+	if(pose >= POSES)
+		return EE_BAD_PARAM;
+	waitEEStore();
+	return saveRecord(EE_AREA_POSE(pose), p, sizeof(pose_t));
+}
+
+/**
+ * Teach mode: saves the current position of all servos as pose.
+ * name has up to POSE_NAME_LENGTH characters.
+ *
+ * Example:
+ *
+ *			teachPose(3, "drop");
+ *
+ */
+uint8_t teachPose(uint8_t pose, const char *name)
+{
+	pose_t p;
+	uint8_t i;
+
+	for(i = 0; i < POSE_NAME_LENGTH; i++)		// 0 padded
+		p.name[i] = *name ? *name++ : 0;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {		// changed by the motion engine
+		p.pos[0] = Pos_Servo_1;
+		p.pos[1] = Pos_Servo_2;
+		p.pos[2] = Pos_Servo_3;
+		p.pos[3] = Pos_Servo_4;
+		p.pos[4] = Pos_Servo_5;
+		p.pos[5] = Pos_Servo_6;
+	}
+	return savePose(pose, &p);
+}
+
+/**
+ * Returns the number of the pose with this name or POSE_NONE.
+ */
+uint8_t findPose(const char *name)
+{
+	pose_t p;
+	uint8_t pose;
+
+	for(pose = 0; pose < POSES; pose++)
+		if(loadPose(pose, &p) == EE_OK && !strncmp(p.name, name, POSE_NAME_LENGTH))
+			return pose;
+	return POSE_NONE;
+}
+
+/**
+ * Loads a pose as offsets to Start_Position for the motion engine.
+ */
+static uint8_t getPoseTargets(uint8_t pose, int16_t *targets)
+{
+	pose_t p;
+	uint8_t result, i;
+
+	result = loadPose(pose, &p);
+	if(result != EE_OK)
+		return result;
+	for(i = 0; i < MOTION_SERVOS; i++)
+		targets[i] = p.pos[i] - Start_Position[i + 1];
+	return EE_OK;
+}
+
+/**
+ * Moves all servos to the pose, they arrive at the same time (s. moveAllTo
+ * in RobotArmMotion.c). Returns EE_OK, EE_NOT_FOUND, EE_BAD_PARAM or
+ * EE_BUSY while a sequence is played.
+ */
+uint8_t moveToPose(uint8_t pose, uint16_t speed)
+{
+	int16_t targets[MOTION_SERVOS];
+	uint8_t result;
+
+	if(play_state != PLAY_OFF)
+		return EE_BUSY;
+	result = getPoseTargets(pose, targets);
+	if(result == EE_OK)
+		moveAllTo(targets, speed);
+	return result;
+}
+
+/*****************************************************************************/
+// Sequences:
+
+/**
+ * Returns true if the sequence has 1..SEQUENCE_STEPS steps and all pose
+ * numbers are valid - the poses themselves don't need to exist.
+ */
+static uint8_t isSequenceValid(const pose_sequence_t *s)
+{
+	uint8_t i;
+
+	if(!s->steps || s->steps > SEQUENCE_STEPS)
+		return false;
+	for(i = 0; i < s->steps; i++)
+		if(s->step[i].pose >= POSES)
+			return false;
+	return true;
+}
+
+/**
+ * Loads a sequence. Returns EE_OK, EE_NOT_FOUND or EE_BAD_PARAM.
+ * A record with an invalid step count or pose number (written by
+ * another program) is EE_NOT_FOUND, so playSequence can rely on it.
+ */
+uint8_t loadSequence(uint8_t sequence, pose_sequence_t *s)
+{
+	uint8_t result;
+
+	if(sequence >= SEQUENCES)
+		return EE_BAD_PARAM;
+	result = loadRecord(EE_AREA_SEQUENCE(sequence), s, sizeof(pose_sequence_t));
+	if(result == EE_OK && !isSequenceValid(s))
+		result = EE_NOT_FOUND;
+	return result;
+}
+
+/**
+ * Saves a sequence, like savePose. Returns EE_BAD_PARAM if it has no or
+ * more than SEQUENCE_STEPS steps or a pose number is too high - the poses
+ * themselves don't need to exist yet.
+ */
+uint8_t saveSequence(uint8_t sequence, const pose_sequence_t *s)
+{
+	if(sequence >= SEQUENCES || !isSequenceValid(s))
+		return EE_BAD_PARAM;
+	waitEEStore();
+	return saveRecord(EE_AREA_SEQUENCE(sequence), s, sizeof(pose_sequence_t));
+}
+
+/**
+ * Returns the number of the sequence with this name or POSE_NONE.
+ */
+uint8_t findSequence(const char *name)
+{
+	pose_sequence_t s;
+	uint8_t sequence;
+
+	for(sequence = 0; sequence < SEQUENCES; sequence++)
+		if(loadSequence(sequence, &s) == EE_OK && !strncmp(s.name, name, POSE_NAME_LENGTH))
+			return sequence;
+	return POSE_NONE;
+}
+
+/*****************************************************************************/
+// Playback:
+
+static uint8_t isMotionDone(void)
+{
+	return getMotionQueueFree() == MOTION_QUEUE_SIZE && !isMoving();
+}
+
+static void endPlayback(void)
+{
+	removeTask(play_task);
+	play_task = NO_TASK;
+	play_state = PLAY_OFF;
+}
+
+/**
+ * Plays a sequence repeat times (0 = until stopPlayback). With speed = 0
+ * each step uses its own speed, otherwise speed is used for all steps.
+ * A sequence that is played right now is stopped first.
+ * Returns EE_OK, EE_NOT_FOUND (the sequence or one of its poses does not
+ * exist), EE_BAD_PARAM or EE_BUSY (no free scheduler task).
+ *
+ * Example:
+ *
+ *			playSequence(0, 1, 5);	// once, slowly
+ *
+ */
+uint8_t playSequence(uint8_t sequence, uint8_t repeat, uint16_t speed)
+{
+	uint8_t result, i;
+
+	stopPlayback();
+	result = loadSequence(sequence, &play_sequence);
+	for(i = 0; result == EE_OK && i < play_sequence.steps; i++)
+		result = getPoseTargets(play_sequence.step[i].pose, play_targets[i]);
+	if(result != EE_OK)
+		return result;
+
+	play_task = addTask(task_playback, PLAYBACK_PERIOD, 0);
+	if(play_task == NO_TASK)
+		return EE_BUSY;
+	play_step = 0;
+	play_repeat = repeat;
+	play_speed = speed;
+	play_state = PLAY_QUEUE;
+	return EE_OK;
+}
+
+/**
+ * Stops the playback and all servos at their current position.
+ */
+void stopPlayback(void)
+{
+	if(play_state == PLAY_OFF)
+		return;
+	endPlayback();
+	stopMotion();
+}
+
+/**
+ * Returns true until the last step of the sequence has arrived.
+ */
+uint8_t isPlaying(void)
+{
+	return play_state != PLAY_OFF;
+}
+
+/**
+ * Appends the steps of the sequence to the waypoint queue and waits for
+ * the dwell times. Added to the scheduler by playSequence, every
+ * PLAYBACK_PERIOD ms.
+ */
+void task_playback(void)
+{
+	pose_step_t *step;
+
+	switch(play_state) {
+		case PLAY_OFF:
+			return;
+		case PLAY_FINISH:
+			if(isMotionDone())
+				endPlayback();
+			return;
+		case PLAY_ARRIVE:
+			if(!isMotionDone())
+				return;
+			play_time = getMsTicks();
+			play_state = PLAY_DWELL;
+			// no break
+		case PLAY_DWELL:
+			if((uint16_t)(getMsTicks() - play_time) < play_dwell * PLAYBACK_PERIOD)
+				return;
+			play_state = PLAY_QUEUE;
+			break;
+	}
+
+	while(getMotionQueueFree()) {
+		if(play_step >= play_sequence.steps) {
+			if(play_repeat == 1) {
+				play_state = PLAY_FINISH;
+				return;
+			}
+			if(play_repeat)
+				play_repeat--;
+			play_step = 0;
+		}
+		step = &play_sequence.step[play_step];
+		queueMove(play_targets[play_step++], play_speed ? play_speed : step->speed);
+		if(step->dwell) {
+			play_dwell = step->dwell;
+			play_state = PLAY_ARRIVE;
+			return;
+		}
+	}
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ * - v. 1.1 17.10.2026: playSequence reads the poses of all steps once,
+ *                      task_playback no longer waits while the EEPROM
+ *                      is written
+ * - v. 1.2 17.10.2026: loadSequence checks the steps and pose numbers
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,73 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmPoses.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * Pose library with teach mode and sequence playback. Detailled
+ * description of each function can be found in the RobotArmPoses.c file!
+ * This file is included by RobotArmBaseLib.h.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMPOSES_H
+#define ROBOTARMPOSES_H
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+#include "RobotArmEEPROM.h"
+
+/*****************************************************************************/
+// Pose library
+
+#define POSES				EE_POSES
+#define SEQUENCES			EE_SEQUENCES
+#define POSE_NAME_LENGTH	8		// no 0 at the end if all 8 are used
+#define SEQUENCE_STEPS		12
+#define POSE_NONE			0xFF	// returned by findPose/findSequence
+
+// Period of task_playback in ms, also the resolution of the dwell time:
+#define PLAYBACK_PERIOD		10
+
+typedef struct {
+	char name[POSE_NAME_LENGTH];
+	uint16_t pos[6];	// Pos_Servo_1..6, servo pulse in us
+} pose_t;
+
+typedef struct {
+	uint8_t pose;		// 0..POSES-1
+	uint8_t speed;		// ms per count of the longest move, 0 = profiles
+	uint8_t dwell;		// wait after arrival in PLAYBACK_PERIOD ms
+} pose_step_t;
+
+typedef struct {
+	char name[POSE_NAME_LENGTH];
+	uint8_t steps;		// used entries of step
+	pose_step_t step[SEQUENCE_STEPS];
+} pose_sequence_t;
+
+uint8_t loadPose(uint8_t pose, pose_t *p);
+uint8_t savePose(uint8_t pose, const pose_t *p);
+uint8_t teachPose(uint8_t pose, const char *name);
+uint8_t findPose(const char *name);
+uint8_t moveToPose(uint8_t pose, uint16_t speed);
+
+uint8_t loadSequence(uint8_t sequence, pose_sequence_t *s);
+uint8_t saveSequence(uint8_t sequence, const pose_sequence_t *s);
+uint8_t findSequence(const char *name);
+
+uint8_t playSequence(uint8_t sequence, uint8_t repeat, uint16_t speed);
+void stopPlayback(void);
+uint8_t isPlaying(void);
+void task_playback(void);
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,635 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmProtocol.c
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * Binary command protocol. Instead of parsing ASCII text the host sends
+ * small COBS encoded and CRC protected frames (s. RobotArmProtocolDefs.h).
+ * A complete setpoint for all six servos is only 15 bytes on the wire.
+ *
+ * Call task_protocol() frequently from your main loop - it reads the
+ * characters from the UART receive buffer, executes complete frames and
+ * sends the answers. It never waits for data.
+ *
+ * Example:
+ *
+ *			int main(void)
+ *			{
+ *				initRobotBase();
+ *				Servo_Power_And_Start();
+ *				while(true)
+ *					task_protocol();
+ *			}
+ *
+ * ASCII output with writeString etc. can still be used, the host library
+ * simply ignores everything that is not a valid frame.
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmProtocol.h"
+
+#if FAULT_GLOBAL != OC_FAULT_GLOBAL
+#error "FAULT_GLOBAL must match OC_FAULT_GLOBAL!"
+#endif
+
+#if BAUD_CODE_38400 != UART_BAUD_38400 || BAUD_CODE_250K != UART_BAUD_250K \
+ || BAUD_CODE_500K != UART_BAUD_500K || BAUD_CODE_1M != UART_BAUD_1M
+#error "BAUD_CODE_xxx must match UART_BAUD_xxx!"
+#endif
+
+#if PROTOCOL_NAME_LENGTH != POSE_NAME_LENGTH \
+ || SEQUENCE_HEADER_SIZE + SEQUENCE_STEPS * SEQUENCE_STEP_SIZE > PROTOCOL_MAX_PAYLOAD
+#error "MSG_SET_POSE / MSG_SET_SEQUENCE do not fit the pose library!"
+#endif
+
+/*****************************************************************************/
+// Variables:
+
+static uint8_t rx_frame[PROTOCOL_MAX_ENCODED];
+static uint8_t rx_length;
+static uint8_t rx_overlong;
+
+static uint8_t tx_frame[PROTOCOL_MAX_FRAME];
+
+// Last frame that was accepted - used to detect retransmissions:
+static uint8_t last_type;
+static uint8_t last_seq;
+// Info byte of the ACK (s. MSG_ACK), repeated for retransmissions:
+static uint8_t ack_info;
+
+// Baudrate change requested by MSG_SET_BAUD, done after the ACK is sent:
+static uint8_t pending_baud = 0xFF;
+
+uint16_t protocol_frames_ok;
+uint16_t protocol_frames_bad;
+
+/*****************************************************************************/
+// Framing:
+
+/**
+ * Decodes a COBS encoded frame (without the 0x00 delimiter) in place.
+ * Returns the decoded length or 0 if the data is not valid COBS.
+ */
+static uint8_t decodeCOBS(uint8_t *buf, uint8_t length)
+{
+	uint8_t in = 0, out = 0;
+	while(in < length) {
+		uint8_t code = buf[in++], n;
+		if(code == 0 || code - 1 > length - in)
+			return 0;
+		for(n = code; --n;)
+			buf[out++] = buf[in++];
+		if(code != 0xFF && in < length)
+			buf[out++] = 0;
+	}
+	return out;
+}
+
+/**
+ * Writes data COBS encoded to the UART with a 0x00 before and after the
+ * frame. The leading 0x00 ends anything else the program wrote to the
+ * UART (e.g. writeString), the host discards that as a bad frame.
+ */
+static void writeCOBS(const uint8_t *data, uint8_t length)
+{
+	uint8_t start = 0, end;
+	writeChar(PROTOCOL_DELIMITER);
+	for(;;) {
+		for(end = start; end < length && data[end] && end - start < 254; end++);
+		writeChar(end - start + 1);
+		while(start < end)
+			writeChar(data[start++]);
+		if(end >= length)
+			break;
+		if(data[end] == 0)
+			start++;
+	}
+	writeChar(PROTOCOL_DELIMITER);
+}
+
+/**
+ * Sends a frame to the host. Answers use the sequence number of the
+ * frame they answer.
+ *
+ * Example:
+ *
+ *			uint8_t info[2] = {seq, 0};
+ *			sendFrame(MSG_ACK, seq, info, 2);
+ */
+void sendFrame(uint8_t type, uint8_t seq, const uint8_t *payload, uint8_t length)
+{
+	uint16_t crc = 0xFFFF;
+	uint8_t i;
+
+	if(length > PROTOCOL_MAX_PAYLOAD)
+		length = PROTOCOL_MAX_PAYLOAD;
+	tx_frame[0] = type;
+	tx_frame[1] = seq;
+	memcpy(&tx_frame[PROTOCOL_HEADER_SIZE], payload, length);
+	length += PROTOCOL_HEADER_SIZE;
+	for(i = 0; i < length; i++)
+		crc = protocolCRC16(crc, tx_frame[i]);
+	tx_frame[length++] = crc & 0xFF;
+	tx_frame[length++] = crc >> 8;
+	writeCOBS(tx_frame, length);
+}
+
+static void sendAck(uint8_t seq, uint8_t info)
+{
+	uint8_t payload[2] = {seq, info};
+	sendFrame(MSG_ACK, seq, payload, 2);
+}
+
+static void sendNak(uint8_t seq, uint8_t error)
+{
+	uint8_t payload[2] = {seq, error};
+	protocol_frames_bad++;
+	sendFrame(MSG_NAK, seq, payload, 2);
+}
+
+/*****************************************************************************/
+// Commands:
+
+static uint8_t cmdSetAll(const uint8_t *payload, uint8_t length)
+{
+	int16_t joints[PROTOCOL_JOINTS];
+	uint8_t i;
+
+	if(length != PROTOCOL_PACKED_JOINTS)
+		return NAK_BAD_PARAM;
+	unpackJoints(payload, joints);
+	for(i = 0; i < PROTOCOL_JOINTS; i++)
+		Move(i + 1, joints[i]);
+	return 0;
+}
+
+static uint8_t cmdMoveSync(const uint8_t *payload, uint8_t length)
+{
+	int16_t joints[PROTOCOL_JOINTS];
+
+	if(length != MOVE_SYNC_SIZE)
+		return NAK_BAD_PARAM;
+	unpackJoints(payload, joints);
+	moveAllTo(joints, payload[PROTOCOL_PACKED_JOINTS]
+	                  | (payload[PROTOCOL_PACKED_JOINTS + 1] << 8));
+	return 0;
+}
+
+static uint8_t cmdQueueMove(const uint8_t *payload, uint8_t length)
+{
+	int16_t joints[PROTOCOL_JOINTS];
+
+	if(length != MOVE_SYNC_SIZE)
+		return NAK_BAD_PARAM;
+	unpackJoints(payload, joints);
+	if(!queueMove(joints, payload[PROTOCOL_PACKED_JOINTS]
+	                      | (payload[PROTOCOL_PACKED_JOINTS + 1] << 8)))
+		return NAK_BUSY;
+	ack_info = getMotionQueueFree();
+	return 0;
+}
+
+static uint8_t cmdMoveRelative(const uint8_t *payload, uint8_t length)
+{
+	uint8_t mask, servo, count = 0;
+
+	if(length < 1)
+		return NAK_BAD_PARAM;
+	mask = payload[0];
+	for(servo = 0; servo < PROTOCOL_JOINTS; servo++)
+		if(mask & (1 << servo))
+			count++;
+	if((mask >> PROTOCOL_JOINTS) || length != 1 + 2 * count)
+		return NAK_BAD_PARAM;
+
+	payload++;
+	for(servo = 1; servo <= PROTOCOL_JOINTS; servo++, mask >>= 1) {
+		if(mask & 1) {
+			int16_t delta = payload[0] | (payload[1] << 8);
+			Move(servo, getServoOffset(servo) + delta);
+			payload += 2;
+		}
+	}
+	return 0;
+}
+
+static void sendState(uint8_t seq)
+{
+	uint8_t state[STATE_SIZE];
+	uint8_t *p = state;
+	uint8_t servo;
+	overcurrent_fault_t fault;
+	uint16_t current[PROTOCOL_JOINTS] = {Current_1, Current_2, Current_3,
+	                                     Current_4, Current_5, Current_6};
+
+	for(servo = 1; servo <= PROTOCOL_JOINTS; servo++) {
+		int16_t offset = getServoOffset(servo);
+		*p++ = offset & 0xFF;
+		*p++ = offset >> 8;
+	}
+	for(servo = 0; servo < PROTOCOL_JOINTS; servo++) {
+		*p++ = current[servo] & 0xFF;
+		*p++ = current[servo] >> 8;
+	}
+#if ROBOT_ARM_V3
+	*p = (PORTG & SERVO_POWER_v3) ? STATE_SERVO_POWER : 0;
+#else
+	*p = (PORTG & SERVO_POWER) ? 0 : STATE_SERVO_POWER;	// low = power on
+#endif
+	getOvercurrentFault(&fault);
+	if(fault.active)		// also OC_POWER_OFF without frozen servos
+		*p |= STATE_FAULT;
+	if(stack_fault)
+		*p |= STATE_STACK_FAULT;
+	if(isPlaying())
+		*p |= STATE_PLAYING;
+	*++p = getMotionQueueFree();
+	sendFrame(MSG_STATE, seq, state, STATE_SIZE);
+}
+
+static uint8_t cmdStop(const uint8_t *payload, uint8_t length)
+{
+	if(length > 1)
+		return NAK_BAD_PARAM;
+	stopPlayback();
+	stopMotion();
+	if(length && payload[0] == STOP_POWER_OFF)
+		Power_Off_Servos();
+	return 0;
+}
+
+static uint8_t cmdSetBaud(const uint8_t *payload, uint8_t length)
+{
+	if(length != 1 || !isUARTBaudrateSupported(payload[0]))
+		return NAK_BAD_PARAM;
+	pending_baud = payload[0];
+	return 0;
+}
+
+static uint8_t cmdBaudConfirm(const uint8_t *payload, uint8_t length)
+{
+	if(length)
+		return NAK_BAD_PARAM;
+	confirmUARTBaudrate();
+	return 0;
+}
+
+static uint8_t *putWord(uint8_t *p, uint16_t value)
+{
+	*p++ = value & 0xFF;
+	*p++ = value >> 8;
+	return p;
+}
+
+static uint16_t getWord(const uint8_t *p)
+{
+	return p[0] | (p[1] << 8);
+}
+
+static void sendUARTStats(uint8_t seq)
+{
+	uint8_t stats[UART_STATS_SIZE];
+	uint8_t *p = stats;
+	uint32_t count = getUARTTransmitCount();
+
+	p = putWord(p, count);
+	p = putWord(p, count >> 16);
+	count = getUARTReceiveCount();
+	p = putWord(p, count);
+	p = putWord(p, count >> 16);
+	p = putWord(p, uart_rx_overflows);
+	p = putWord(p, uart_rx_overruns);
+	p = putWord(p, uart_rx_frame_errors);
+	p = putWord(p, uart_tx_dropped);
+	*p = getUARTBaudrate();
+	sendFrame(MSG_UART_STATS, seq, stats, UART_STATS_SIZE);
+}
+
+static void sendFault(uint8_t seq)
+{
+	uint8_t payload[FAULT_SIZE];
+	uint8_t *p = payload;
+	overcurrent_fault_t fault;
+
+	getOvercurrentFault(&fault);
+	*p++ = fault.active;
+	*p++ = fault.joint;
+	p = putWord(p, fault.current);
+	p = putWord(p, fault.limit);
+	p = putWord(p, fault.adc_seq);
+	putWord(p, fault.trips);
+	sendFrame(MSG_FAULT, seq, payload, FAULT_SIZE);
+}
+
+#ifdef ISR_STATS
+static void sendISRStats(uint8_t seq, const uint8_t *payload, uint8_t length)
+{
+	uint8_t stats[ISR_STATS_SIZE];
+	uint8_t *p = stats;
+	isr_stat_t s;
+
+	if(length != 2 || payload[0] >= ISR_STAT_COUNT) {
+		sendNak(seq, NAK_BAD_PARAM);
+		return;
+	}
+	getISRStats(payload[0], &s);
+	if(payload[1] & ISR_STATS_RESET)
+		resetISRStats();
+	*p++ = payload[0];
+	p = putWord(p, s.count);
+	p = putWord(p, s.count >> 16);
+	p = putWord(p, s.min);
+	p = putWord(p, s.count ? s.sum / s.count : 0);
+	p = putWord(p, s.max);
+	*p++ = s.count ? s.latency_sum / s.count : 0;
+	*p = s.latency_max;
+	sendFrame(MSG_ISR_STATS, seq, stats, ISR_STATS_SIZE);
+}
+#endif
+
+static void sendMemory(uint8_t seq)
+{
+	uint8_t payload[MEMORY_SIZE];
+	uint8_t *p = payload;
+
+	p = putWord(p, getStaticRAM());
+	p = putWord(p, getHeapRAM());
+	p = putWord(p, getStackMaxUsed());
+	p = putWord(p, getStackUnused());
+	p = putWord(p, getFreeRAM());
+	*p = stack_fault;
+	sendFrame(MSG_MEMORY, seq, payload, MEMORY_SIZE);
+}
+
+static uint8_t cmdClearFault(const uint8_t *payload, uint8_t length)
+{
+	if(length)
+		return NAK_BAD_PARAM;
+	clearOvercurrentFault();
+	return 0;
+}
+
+/**
+ * NAK code for the result of the pose library. The pose library waits
+ * until a record is written to the EEPROM, so the pose commands check
+ * isEEStoreBusy() first and answer NAK_BUSY instead of blocking.
+ */
+static uint8_t poseError(uint8_t result)
+{
+	switch(result) {
+		case EE_OK: return 0;
+		case EE_BUSY: return NAK_BUSY;
+		default: return NAK_BAD_PARAM;
+	}
+}
+
+static uint8_t cmdTeachPose(const uint8_t *payload, uint8_t length)
+{
+	char name[PROTOCOL_NAME_LENGTH + 1];
+
+	if(length < 1 || length > 1 + PROTOCOL_NAME_LENGTH)
+		return NAK_BAD_PARAM;
+	if(isEEStoreBusy())
+		return NAK_BUSY;
+	memset(name, 0, sizeof(name));
+	memcpy(name, &payload[1], length - 1);
+	return poseError(teachPose(payload[0], name));
+}
+
+static uint8_t cmdSetPose(const uint8_t *payload, uint8_t length)
+{
+	pose_t pose;
+	uint8_t i;
+
+	if(length != POSE_SIZE)
+		return NAK_BAD_PARAM;
+	if(isEEStoreBusy())
+		return NAK_BUSY;
+	memcpy(pose.name, &payload[1], PROTOCOL_NAME_LENGTH);
+	for(i = 0; i < PROTOCOL_JOINTS; i++)
+		pose.pos[i] = getWord(&payload[1 + PROTOCOL_NAME_LENGTH + 2 * i]);
+	return poseError(savePose(payload[0], &pose));
+}
+
+static void sendPose(uint8_t seq, const uint8_t *payload, uint8_t length)
+{
+	uint8_t answer[POSE_SIZE];
+	uint8_t *p = answer;
+	pose_t pose;
+	uint8_t i;
+
+	if(length == 1 && isEEStoreBusy()) {
+		sendNak(seq, NAK_BUSY);
+		return;
+	}
+	if(length != 1 || loadPose(payload[0], &pose) != EE_OK) {
+		sendNak(seq, NAK_BAD_PARAM);
+		return;
+	}
+	*p++ = payload[0];
+	memcpy(p, pose.name, PROTOCOL_NAME_LENGTH);
+	p += PROTOCOL_NAME_LENGTH;
+	for(i = 0; i < PROTOCOL_JOINTS; i++)
+		p = putWord(p, pose.pos[i]);
+	sendFrame(MSG_POSE, seq, answer, POSE_SIZE);
+}
+
+static uint8_t cmdSetSequence(const uint8_t *payload, uint8_t length)
+{
+	pose_sequence_t sequence;
+	const uint8_t *p = &payload[SEQUENCE_HEADER_SIZE];
+	uint8_t i;
+
+	if(length < SEQUENCE_HEADER_SIZE
+	   || length != SEQUENCE_HEADER_SIZE + payload[SEQUENCE_HEADER_SIZE - 1] * SEQUENCE_STEP_SIZE)
+		return NAK_BAD_PARAM;
+	if(isEEStoreBusy())
+		return NAK_BUSY;
+	memset(&sequence, 0, sizeof(sequence));
+	memcpy(sequence.name, &payload[1], PROTOCOL_NAME_LENGTH);
+	sequence.steps = payload[SEQUENCE_HEADER_SIZE - 1];
+	for(i = 0; i < sequence.steps; i++) {
+		sequence.step[i].pose = *p++;
+		sequence.step[i].speed = *p++;
+		sequence.step[i].dwell = *p++;
+	}
+	return poseError(saveSequence(payload[0], &sequence));
+}
+
+static uint8_t cmdPlaySequence(const uint8_t *payload, uint8_t length)
+{
+	if(length != PLAY_SEQUENCE_SIZE)
+		return NAK_BAD_PARAM;
+	if(isEEStoreBusy())
+		return NAK_BUSY;
+	return poseError(playSequence(payload[0], payload[1], getWord(&payload[2])));
+}
+
+/**
+ * Checks and executes one decoded frame.
+ */
+static void handleFrame(uint8_t *frame, uint8_t length)
+{
+	uint16_t crc = 0xFFFF;
+	uint8_t i, type, seq, error;
+	uint8_t *payload = &frame[PROTOCOL_HEADER_SIZE];
+
+	if(length < PROTOCOL_HEADER_SIZE + PROTOCOL_CRC_SIZE) {
+		sendNak(0, NAK_LENGTH);
+		return;
+	}
+	length -= PROTOCOL_CRC_SIZE;
+	for(i = 0; i < length; i++)
+		crc = protocolCRC16(crc, frame[i]);
+	type = frame[0];
+	seq = frame[1];
+	if(frame[length] != (crc & 0xFF) || frame[length + 1] != (crc >> 8)) {
+		sendNak(seq, NAK_CRC);
+		return;
+	}
+	length -= PROTOCOL_HEADER_SIZE;
+
+	if(type == MSG_QUERY_STATE) {	// answered with the state instead of ACK
+		protocol_frames_ok++;
+		sendState(seq);
+		return;
+	}
+	if(type == MSG_QUERY_UART_STATS) {
+		protocol_frames_ok++;
+		sendUARTStats(seq);
+		return;
+	}
+	if(type == MSG_QUERY_FAULT) {
+		protocol_frames_ok++;
+		sendFault(seq);
+		return;
+	}
+	if(type == MSG_QUERY_MEMORY) {
+		protocol_frames_ok++;
+		sendMemory(seq);
+		return;
+	}
+	if(type == MSG_QUERY_POSE) {
+		protocol_frames_ok++;
+		sendPose(seq, payload, length);
+		return;
+	}
+#ifdef ISR_STATS
+	if(type == MSG_QUERY_ISR_STATS) {
+		protocol_frames_ok++;
+		sendISRStats(seq, payload, length);
+		return;
+	}
+#endif
+	if(type == last_type && seq == last_seq) { // retransmission
+		sendAck(seq, ack_info);
+		return;
+	}
+
+	ack_info = 0;
+	switch(type) {
+		case MSG_SET_ALL: error = cmdSetAll(payload, length); break;
+		case MSG_MOVE_REL: error = cmdMoveRelative(payload, length); break;
+		case MSG_STOP: error = cmdStop(payload, length); break;
+		case MSG_SET_BAUD: error = cmdSetBaud(payload, length); break;
+		case MSG_BAUD_CONFIRM: error = cmdBaudConfirm(payload, length); break;
+		case MSG_CLEAR_FAULT: error = cmdClearFault(payload, length); break;
+		case MSG_MOVE_SYNC: error = cmdMoveSync(payload, length); break;
+		case MSG_QUEUE_MOVE: error = cmdQueueMove(payload, length); break;
+		case MSG_TEACH_POSE: error = cmdTeachPose(payload, length); break;
+		case MSG_SET_POSE: error = cmdSetPose(payload, length); break;
+		case MSG_SET_SEQUENCE: error = cmdSetSequence(payload, length); break;
+		case MSG_PLAY_SEQUENCE: error = cmdPlaySequence(payload, length); break;
+		default: error = NAK_UNKNOWN_TYPE; break;
+	}
+	if(error) {
+		sendNak(seq, error);
+		return;
+	}
+	last_type = type;
+	last_seq = seq;
+	protocol_frames_ok++;
+	sendAck(seq, ack_info);
+
+	if(pending_baud != 0xFF) {
+		setUARTBaudrateTimed(pending_baud, BAUD_CONFIRM_TIMEOUT);
+		pending_baud = 0xFF;
+	}
+}
+
+/**
+ * Reads received characters from the UART receive buffer and executes
+ * at most one complete frame per call. Returns immediately if there is
+ * no complete frame.
+ */
+void task_protocol(void)
+{
+	while(getBufferLength()) {
+		uint8_t c = readChar();
+		if(c != PROTOCOL_DELIMITER) {
+			if(rx_length < sizeof(rx_frame))
+				rx_frame[rx_length++] = c;
+			else
+				rx_overlong = true;
+			continue;
+		}
+		if(rx_overlong)
+			sendNak(0, NAK_LENGTH);
+		else if(rx_length) {
+			uint8_t length = decodeCOBS(rx_frame, rx_length);
+			if(length)
+				handleFrame(rx_frame, length);
+			else
+				sendNak(0, NAK_CRC);
+		}
+		rx_length = 0;
+		rx_overlong = false;
+		return;
+	}
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ * - v. 1.1 17.10.2026: MSG_SET_BAUD, MSG_BAUD_CONFIRM, MSG_QUERY_UART_STATS
+ * - v. 1.2 17.10.2026: MSG_QUERY_FAULT, MSG_CLEAR_FAULT
+ * - v. 1.3 17.10.2026: MSG_STOP stops the motion engine
+ * - v. 1.4 17.10.2026: MSG_MOVE_SYNC
+ * - v. 1.5 17.10.2026: MSG_QUEUE_MOVE, free queue entries in MSG_STATE
+ * - v. 1.6 17.10.2026: MSG_QUERY_ISR_STATS (only with ISR_STATS)
+ * - v. 1.7 17.10.2026: MSG_QUERY_MEMORY, STATE_STACK_FAULT
+ * - v. 1.8 17.10.2026: pose library (MSG_TEACH_POSE, MSG_SET_POSE,
+ *                      MSG_QUERY_POSE, MSG_SET_SEQUENCE, MSG_PLAY_SEQUENCE),
+ *                      STATE_PLAYING, max. payload 48 bytes
+ * - v. 1.9 17.10.2026: STATE_FAULT from the overcurrent fault record, it
+ *                      was missing for a global overload (OC_POWER_OFF)
+ * - v. 1.10 17.10.2026: STATE_SERVO_POWER for board revision 2
+ * - v. 1.11 17.10.2026: 0x00 before every frame to the host
+ * - v. 1.12 17.10.2026: pose commands answer NAK_BUSY while the EEPROM
+ *                      is written instead of waiting for it
+ * - v. 1.13 17.10.2026: MSG_SET_BAUD: NAK_BAD_PARAM for baudrates the
+ *                      crystal of the board can not generate
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
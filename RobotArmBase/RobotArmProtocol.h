@@ -0,0 +1,38 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmProtocol.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * Binary command protocol over USART1. The message definitions can be
+ * found in RobotArmProtocolDefs.h, detailled description of each function
+ * in the RobotArmProtocol.c file!
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMPROTOCOL_H
+#define ROBOTARMPROTOCOL_H
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+#include "RobotArmProtocolDefs.h"
+
+/*****************************************************************************/
+// Protocol
+
+extern uint16_t protocol_frames_ok;
+extern uint16_t protocol_frames_bad;
+
+void task_protocol(void);
+void sendFrame(uint8_t type, uint8_t seq, const uint8_t *payload, uint8_t length);
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,276 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmProtocolDefs.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz and host PC (C and C++)
+ * ****************************************************************************
+ * Description:
+ * Message definitions of the binary command protocol. This file is shared
+ * by the firmware (RobotArmProtocol.c) and the host library
+ * (host/RobotArmProtocol.hpp), so it must not include any AVR headers
+ * and only use plain C that also compiles as C++.
+ *
+ * Frame layout before encoding:
+ *
+ *   [type][seq][payload 0..PROTOCOL_MAX_PAYLOAD][crc low][crc high]
+ *
+ * The CRC is CRC-16/CCITT-FALSE (polynomial 0x1021, start value 0xFFFF)
+ * over type, seq and payload. The frame is COBS encoded (so it does not
+ * contain any 0x00 bytes) and terminated by a single 0x00 byte. The
+ * firmware sends a 0x00 before each frame as well, so text or noise on
+ * the line before it cannot corrupt the frame - empty frames between two
+ * 0x00 bytes are ignored by both sides.
+ * All multi byte values are little endian.
+ *
+ * Example - MSG_SET_ALL on the wire:
+ *   1 COBS code + 2 header + 9 payload + 2 CRC + 1 delimiter = 15 bytes
+ *
+ * Every frame from the host is answered with MSG_ACK or MSG_NAK carrying
+ * the sequence number of the host frame. A frame with the same type and
+ * sequence number as the previously accepted frame is a retransmission:
+ * it is acknowledged again but NOT executed twice.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMPROTOCOLDEFS_H
+#define ROBOTARMPROTOCOLDEFS_H
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// Frame sizes:
+
+#define PROTOCOL_DELIMITER		0x00
+#define PROTOCOL_HEADER_SIZE	2		// type + seq
+#define PROTOCOL_CRC_SIZE		2
+#define PROTOCOL_MAX_PAYLOAD	48		// MSG_SET_SEQUENCE with 12 steps
+#define PROTOCOL_MAX_FRAME		(PROTOCOL_HEADER_SIZE + PROTOCOL_MAX_PAYLOAD + PROTOCOL_CRC_SIZE)
+// COBS adds one byte per started 254 byte block:
+#define PROTOCOL_MAX_ENCODED	(PROTOCOL_MAX_FRAME + 1 + PROTOCOL_MAX_FRAME / 254)
+
+#define PROTOCOL_JOINTS			6
+#define PROTOCOL_PACKED_JOINTS	9		// 6 * 12 bit
+#define PROTOCOL_NAME_LENGTH	8		// pose and sequence names
+
+/*****************************************************************************/
+// Message types host -> arm:
+
+// Set all six servos at once.
+// payload: 6 * 12 bit signed offsets to Start_Position, packed with
+//          packJoints() (9 bytes)
+#define MSG_SET_ALL				0x01
+
+// Move some servos relative to their current position.
+// payload: [joint mask (bit0 = servo 1)][int16 delta] for every set bit
+#define MSG_MOVE_REL			0x02
+
+// Request a MSG_STATE answer.
+// payload: none
+#define MSG_QUERY_STATE			0x03
+
+// Stop all motion and hold the current position.
+// payload: none or [STOP_HOLD / STOP_POWER_OFF]
+#define MSG_STOP				0x04
+#define STOP_HOLD				0
+#define STOP_POWER_OFF			1
+
+// Change the baudrate. The ACK is still sent with the old baudrate, then
+// the arm switches. The host must send MSG_BAUD_CONFIRM with the new
+// baudrate within BAUD_CONFIRM_TIMEOUT ms, otherwise the arm falls back
+// to 38.4 kBaud. Arms with the older PCB (16.384MHz) only support
+// 38.4 kBaud, the other baudrates get NAK_BAD_PARAM.
+// payload: [BAUD_CODE_xxx]
+#define MSG_SET_BAUD			0x05
+#define BAUD_CODE_38400			0
+#define BAUD_CODE_250K			1
+#define BAUD_CODE_500K			2
+#define BAUD_CODE_1M			3
+#define BAUD_CONFIRM_TIMEOUT	1000
+
+// Keep the new baudrate.
+// payload: none
+#define MSG_BAUD_CONFIRM		0x06
+
+// Request a MSG_UART_STATS answer.
+// payload: none
+#define MSG_QUERY_UART_STATS	0x07
+
+// Request a MSG_FAULT answer (overcurrent protection).
+// payload: none
+#define MSG_QUERY_FAULT			0x08
+
+// Clear the overcurrent fault and unfreeze all servos.
+// payload: none
+#define MSG_CLEAR_FAULT			0x09
+
+// Move all six servos so that they arrive at the same time (moveAllTo).
+// payload: 6 * 12 bit offsets like MSG_SET_ALL (9 bytes),
+//          uint16 ms per count of the longest move (0 = profile speed)
+#define MSG_MOVE_SYNC			0x0A
+#define MOVE_SYNC_SIZE			(PROTOCOL_PACKED_JOINTS + 2)
+
+// Append a synchronized move to the waypoint queue (queueMove). The ACK
+// info is the number of free queue entries, NAK_BUSY if it is full.
+// payload: same as MSG_MOVE_SYNC
+#define MSG_QUEUE_MOVE			0x0B
+
+// Request a MSG_ISR_STATS answer. Only supported if the firmware is built
+// with ISR_STATS (s. RobotArmIsrStats.c), NAK_UNKNOWN_TYPE otherwise.
+// payload: [ISR_STAT_xxx][ISR_STATS_RESET or 0]
+#define MSG_QUERY_ISR_STATS		0x0C
+#define ISR_STATS_RESET			1	// clear all statistics after reading
+#define ISR_STAT_TIMER2			0
+#define ISR_STAT_ADC			1
+#define ISR_STAT_UART_RX		2
+#define ISR_STAT_UART_TX		3
+#define ISR_STAT_COUNT			4
+
+// Request a MSG_MEMORY answer.
+// payload: none
+#define MSG_QUERY_MEMORY		0x0D
+
+// The pose messages are answered with NAK_BUSY while the arm writes a
+// pose or sequence to its EEPROM (up to ~0.5s) - send them again later.
+
+// Save the current position of all servos as pose (teach mode).
+// payload: [pose number][name, up to PROTOCOL_NAME_LENGTH characters]
+#define MSG_TEACH_POSE			0x0E
+
+// Save a pose, e.g. to restore a backup made with MSG_QUERY_POSE.
+// payload: [pose number][name, PROTOCOL_NAME_LENGTH bytes, 0 padded],
+//          6 * uint16 servo pulse in us
+#define MSG_SET_POSE			0x0F
+#define POSE_SIZE				(1 + PROTOCOL_NAME_LENGTH + 12)
+
+// Request a MSG_POSE answer, NAK_BAD_PARAM if the pose does not exist.
+// payload: [pose number]
+#define MSG_QUERY_POSE			0x10
+
+// Save a sequence of poses.
+// payload: [sequence number][name, PROTOCOL_NAME_LENGTH bytes, 0 padded]
+//          [number of steps], for every step:
+//          [pose number][ms per count, 0 = profile speed][dwell in 10ms]
+#define MSG_SET_SEQUENCE		0x11
+#define SEQUENCE_HEADER_SIZE	(1 + PROTOCOL_NAME_LENGTH + 1)
+#define SEQUENCE_STEP_SIZE		3
+
+// Play a sequence. MSG_STOP stops it, MSG_STATE shows STATE_PLAYING.
+// payload: [sequence number][repeat, 0 = endless],
+//          uint16 ms per count for all steps (0 = speed of each step)
+#define MSG_PLAY_SEQUENCE		0x12
+#define PLAY_SEQUENCE_SIZE		4
+
+/*****************************************************************************/
+// Message types arm -> host:
+
+// payload: [acknowledged seq][info, depends on the acknowledged type]
+//          info: MSG_QUEUE_MOVE: free waypoint queue entries, others: 0
+#define MSG_ACK					0x80
+
+// payload: [seq of the rejected frame][NAK_xxx error code]
+#define MSG_NAK					0x81
+
+// payload: 6 * int16 servo offsets to Start_Position,
+//          6 * uint16 Current_1..6 ADC values,
+//          [STATE_xxx flags], [free waypoint queue entries]
+#define MSG_STATE				0x83
+#define STATE_SIZE				26
+#define STATE_SERVO_POWER		1
+#define STATE_FAULT				2
+#define STATE_STACK_FAULT		4	// stack reached the guard zone
+#define STATE_PLAYING			8	// a sequence is played
+
+// payload: uint32 characters sent, uint32 characters received,
+//          uint16 receive buffer overflows, uint16 receive overruns,
+//          uint16 framing errors, uint16 dropped transmit characters,
+//          [BAUD_CODE_xxx]
+#define MSG_UART_STATS			0x84
+#define UART_STATS_SIZE			17
+
+// payload: [tripped servos, bit 0 = servo 1, bit 7 = global overload]
+//          [first tripped servo 1..6, 0 = global], uint16 current,
+//          uint16 limit, uint16 ADC scan number, uint16 trip counter
+#define MSG_FAULT				0x85
+#define FAULT_SIZE				10
+#define FAULT_GLOBAL			0x80
+
+// Times in Timer 2 counts (0.5us = 8 CPU cycles).
+// payload: [ISR_STAT_xxx], uint32 calls, uint16 min, uint16 average,
+//          uint16 max run time, [average latency], [max latency]
+//          (latency only for ISR_STAT_TIMER2, 0 for the others)
+#define MSG_ISR_STATS			0x86
+#define ISR_STATS_SIZE			13
+
+// SRAM usage in bytes.
+// payload: uint16 static variables, uint16 heap, uint16 max stack size,
+//          uint16 never used, uint16 free right now, [stack fault]
+#define MSG_MEMORY				0x87
+#define MEMORY_SIZE				11
+
+// payload: same as MSG_SET_POSE
+#define MSG_POSE				0x88
+
+/*****************************************************************************/
+// NAK error codes:
+
+#define NAK_CRC					1	// CRC or COBS error
+#define NAK_LENGTH				2	// frame too short / too long
+#define NAK_UNKNOWN_TYPE		3	// message type not supported
+#define NAK_BAD_PARAM			4	// payload does not fit the type
+#define NAK_BUSY				5	// can not be executed right now
+
+/*****************************************************************************/
+// Helpers shared by firmware and host:
+
+/**
+ * CRC-16/CCITT-FALSE update for one byte. Start with 0xFFFF.
+ */
+static inline uint16_t protocolCRC16(uint16_t crc, uint8_t data)
+{
+	uint8_t i;
+	crc ^= (uint16_t)data << 8;
+	for(i = 0; i < 8; i++)
+		crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+	return crc;
+}
+
+/**
+ * Packs six signed 12 bit values (-2048..2047) into 9 bytes.
+ * Two values share three bytes: a[7:0], b[3:0]a[11:8], b[11:4].
+ * Values outside the range are clipped.
+ */
+static inline void packJoints(const int16_t *joints, uint8_t *out)
+{
+	uint8_t i;
+	for(i = 0; i < PROTOCOL_JOINTS; i += 2) {
+		int16_t a = joints[i], b = joints[i + 1];
+		if(a > 2047) a = 2047; else if(a < -2048) a = -2048;
+		if(b > 2047) b = 2047; else if(b < -2048) b = -2048;
+		*out++ = (uint8_t)a;
+		*out++ = (uint8_t)(((uint16_t)a >> 8) & 0x0F) | (uint8_t)(((uint16_t)b & 0x0F) << 4);
+		*out++ = (uint8_t)((uint16_t)b >> 4);
+	}
+}
+
+/**
+ * Reverse of packJoints().
+ */
+static inline void unpackJoints(const uint8_t *in, int16_t *joints)
+{
+	uint8_t i;
+	for(i = 0; i < PROTOCOL_JOINTS; i += 2) {
+		uint16_t a = in[0] | ((uint16_t)(in[1] & 0x0F) << 8);
+		uint16_t b = (in[1] >> 4) | ((uint16_t)in[2] << 4);
+		joints[i] = (int16_t)(a << 4) >> 4;		// sign extend 12 bit
+		joints[i + 1] = (int16_t)(b << 4) >> 4;
+		in += 3;
+	}
+}
+
+#endif
+
+/*****************************************************************************/
+// EOF
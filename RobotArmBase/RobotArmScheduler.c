@@ -0,0 +1,339 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmScheduler.c
+ * Version: 1.2
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * Cooperative task scheduler. A task is a normal function that is called
+ * periodically or once after a delay. It must return quickly - there is
+ * no preemption, the next task can only run when the current one has
+ * returned.
+ *
+ * Example:
+ *
+ *			void blink(void)
+ *			{
+ *				static uint8_t leds;
+ *				setLEDs(leds ^= 1);
+ *			}
+ *
+ *			int main(void)
+ *			{
+ *				initRobotBase();
+ *				addTask(task_protocol, 1, 0);	// every ms
+ *				addTask(blink, 500, 0);			// every 500 ms
+ *				while(true) {
+ *					task_scheduler();
+ *					// ...
+ *					mSleep(100);	// the tasks keep running!
+ *				}
+ *			}
+ *
+ * sleep() and mSleep() call task_scheduler() while they wait (yieldTicks
+ * and yieldFor), so the tasks also run during delays in your program and
+ * in library functions like Start_position() or readADC().
+ * A task may also call mSleep - the other tasks run in the meantime, the
+ * task itself is not called again until it has returned.
+ *
+ * A deadline is the allowed delay of a task. If the task starts later,
+ * it counts as a missed deadline (getTaskMisses). Periodic tasks that
+ * have missed complete periods are not called several times to catch up.
+ *
+ * When there is nothing to do, the wait loops (yieldTicks, waitForServo,
+ * waitUntilReceptionComplete) call idle(). It stops the CPU in idle sleep
+ * mode until the next interrupt - at the latest the 100us Timer 2
+ * interrupt - which saves power. getIdlePercent() returns the idle time
+ * of the last second, so you can see how much CPU time is left:
+ *
+ *			writeInteger(getIdlePercent(), DEC);	// e.g. 93
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+
+/*****************************************************************************/
+// Variables:
+
+#define TASK_ACTIVE		1	// waiting to be called
+#define TASK_RUNNING	2	// called right now, don't call it again
+
+static task_t tasks[SCHEDULER_TASKS];
+
+volatile uint32_t ms_ticks;	// incremented in the Timer 2 interrupt
+
+volatile uint8_t cpu_idle;
+volatile uint16_t idle_start;
+volatile uint32_t idle_time;
+volatile uint16_t idle_window;
+volatile uint8_t idle_percent;
+
+/*****************************************************************************/
+// Scheduler:
+
+/**
+ * Returns the milliseconds since initRobotBase(). 16 bit - it wraps
+ * around after 65.5 seconds, so only use differences:
+ *
+ *			uint16_t start = getMsTicks();
+ *			...
+ *			if((uint16_t)(getMsTicks() - start) >= 200)
+ *
+ * This is faster than millis32() and good enough for short times.
+ */
+uint16_t getMsTicks(void)
+{
+	uint16_t ticks;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ticks = ms_ticks;
+	}
+	return ticks;
+}
+
+/**
+ * Returns the milliseconds since initRobotBase(). 32 bit - it wraps
+ * around after 49.7 days. Can also be called in interrupt routines.
+ */
+uint32_t millis32(void)
+{
+	uint32_t ticks;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ticks = ms_ticks;
+	}
+	return ticks;
+}
+
+/**
+ * Returns the microseconds since initRobotBase() with 0.5us resolution
+ * (Timer 2 counts with 2MHz, 2.048MHz on the older PCBs). 32 bit - it wraps around after 71.5
+ * minutes, so use differences for long measurements:
+ *
+ *			uint32_t start = micros32();
+ *			task_protocol();
+ *			uint32_t duration = micros32() - start;
+ *
+ * Can also be called in interrupt routines. In the Timer 2 interrupt
+ * itself (e.g. in software timer functions) the result is the time
+ * of the last full millisecond plus the time spent in the interrupt.
+ */
+uint32_t micros32(void)
+{
+	uint32_t ms;
+	uint8_t ticks, count;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		ms = ms_ticks;
+		ticks = ms_timer;
+		count = TCNT2;
+		// Compare match while the interrupts are disabled? Then TCNT2
+		// has already started again but ms_timer is not incremented yet.
+		// A high count means the match was after we read TCNT2.
+		if((TIFR & (1 << OCF2)) && count < TIMER2_COUNTS / 2)
+			ticks++;
+	}
+	return ms * 1000 + TIMER2_US(TIMER2_TICK_START(ticks) + count);
+}
+
+/**
+ * Adds a task. The function func is called first after delay ms and
+ * then every period ms. With period = 0 it is only called once.
+ * Returns the task number or NO_TASK if all SCHEDULER_TASKS entries
+ * are used.
+ */
+uint8_t addTask(task_func_t func, uint16_t period, uint16_t delay)
+{
+	uint8_t i;
+
+	for(i = 0; i < SCHEDULER_TASKS; i++) {
+		task_t *t = &tasks[i];
+		if(t->flags)
+			continue;
+		t->func = func;
+		t->period = period;
+		t->due = getMsTicks() + delay;
+		t->deadline = 0;
+		t->misses = 0;
+		t->flags = TASK_ACTIVE;
+		return i;
+	}
+	return NO_TASK;
+}
+
+/**
+ * Removes a task. It is also possible to remove the task that is
+ * running right now.
+ */
+void removeTask(uint8_t task)
+{
+	if(task < SCHEDULER_TASKS)
+		tasks[task].flags &= ~TASK_ACTIVE;
+}
+
+/**
+ * Sets the allowed delay of a task in ms (0 = no deadline).
+ */
+void setTaskDeadline(uint8_t task, uint16_t deadline)
+{
+	if(task < SCHEDULER_TASKS)
+		tasks[task].deadline = deadline;
+}
+
+/**
+ * Returns how often the task has missed its deadline.
+ */
+uint16_t getTaskMisses(uint8_t task)
+{
+	return (task < SCHEDULER_TASKS) ? tasks[task].misses : 0;
+}
+
+/**
+ * Calls all tasks that are due. Call it frequently from your main loop!
+ */
+void task_scheduler(void)
+{
+	uint16_t now = getMsTicks();
+	uint8_t i;
+
+	for(i = 0; i < SCHEDULER_TASKS; i++) {
+		task_t *t = &tasks[i];
+		uint16_t late;
+
+		if(t->flags != TASK_ACTIVE || (int16_t)(now - t->due) < 0)
+			continue;
+		late = now - t->due;
+		if(t->deadline && late > t->deadline)
+			t->misses++;
+		if(t->period) {
+			t->due += t->period;
+			if(late >= t->period)	// skip the missed periods
+				t->due = now + t->period;
+			t->flags = TASK_ACTIVE | TASK_RUNNING;
+		}
+		else
+			t->flags = TASK_RUNNING;
+		t->func();
+		t->flags &= ~TASK_RUNNING;
+	}
+}
+
+/**
+ * Waits for ticks * 100us and calls task_scheduler() in the meantime.
+ */
+void yieldTicks(uint16_t ticks)
+{
+	uint16_t start, now;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		start = delay_timer;
+	}
+	for(;;) {
+		task_scheduler();
+		ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+			now = delay_timer;
+		}
+		if((uint16_t)(now - start) >= ticks)
+			break;
+		idle();
+	}
+}
+
+/**
+ * Waits for ms milliseconds and calls task_scheduler() in the meantime.
+ */
+void yieldFor(uint16_t ms)
+{
+	while(ms > 6000) {
+		yieldTicks(60000);
+		ms -= 6000;
+	}
+	yieldTicks(ms * 10);
+}
+
+/*****************************************************************************/
+// Idle:
+
+/**
+ * Time in Timer 2 counts (0.5us), 16 bit - like isrStatsClock in
+ * RobotArmIsrStats.h. Interrupts must be disabled.
+ */
+static uint16_t idleClock(void)
+{
+	uint16_t ticks = delay_timer;
+	uint8_t count = TCNT2;
+	// Compare match after the interrupts were disabled?
+	if((TIFR & (1 << OCF2)) && count < TIMER2_COUNTS / 2)
+		ticks++;
+	return ticks * TIMER2_COUNTS + count;
+}
+
+/**
+ * Stops the CPU in idle sleep mode until the next interrupt. Timers,
+ * UART and ADC keep running. Does nothing if the interrupts are disabled,
+ * because then the CPU would never wake up again.
+ *
+ * The time asleep is added to idle_time for getIdlePercent(): from here
+ * to the start of the Timer 2 interrupt if that one wakes the CPU up
+ * (it ends the measurement itself), else until the CPU runs here again.
+ */
+void idle(void)
+{
+	if(!(SREG & (1 << SREG_I)))
+		return;
+	set_sleep_mode(SLEEP_MODE_IDLE);
+	cli();
+	idle_start = idleClock();
+	cpu_idle = 1;
+	sleep_enable();
+	sei();
+	sleep_cpu();	// executed before a pending interrupt (sei latency)
+	sleep_disable();
+	cli();
+	if(cpu_idle) {	// woken up by another interrupt
+		idle_time += (uint16_t)(idleClock() - idle_start);
+		cpu_idle = 0;
+	}
+	sei();
+}
+
+/**
+ * Returns the idle time of the last second in percent (0..100).
+ * 100 - getIdlePercent() is the CPU load of your program and the
+ * interrupts.
+ */
+uint8_t getIdlePercent(void)
+{
+	return idle_percent;
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ * - v. 1.1 17.10.2026: idle sleep in the wait loops, idle time measurement
+ * - v. 1.2 17.10.2026: 32 bit ms_ticks, millis32 and micros32
+ * - v. 1.3 17.10.2026: idle() uses sleep_cpu() (host simulation)
+ * - v. 1.4 17.10.2026: getIdlePercent measures the time asleep instead
+ *                      of counting Timer 2 ticks after a sleep
+ * - v. 1.5 17.10.2026: micros32 and the idle time for the 16.384MHz
+ *                      crystal of the older PCBs
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
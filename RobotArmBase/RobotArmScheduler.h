@@ -0,0 +1,77 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmScheduler.h
+ * Version: 1.2
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * Cooperative task scheduler. Detailled description of each function
+ * can be found in the RobotArmScheduler.c file!
+ * This file is included by RobotArmBaseLib.h.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMSCHEDULER_H
+#define ROBOTARMSCHEDULER_H
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// Scheduler
+
+// Maximum number of tasks:
+#ifndef SCHEDULER_TASKS
+	#define SCHEDULER_TASKS 8
+#endif
+
+#define NO_TASK 0xFF	// returned by addTask if there is no free entry
+
+typedef void (*task_func_t)(void);
+
+typedef struct {
+	task_func_t func;
+	uint16_t period;	// ms, 0 = one-shot task
+	uint16_t due;		// ms_ticks when the task has to run
+	uint16_t deadline;	// allowed delay in ms, 0 = no deadline
+	uint16_t misses;	// number of missed deadlines
+	uint8_t flags;
+} task_t;
+
+extern volatile uint32_t ms_ticks;	// milliseconds since initRobotBase
+
+uint16_t getMsTicks(void);
+uint32_t millis32(void);
+uint32_t micros32(void);
+
+uint8_t addTask(task_func_t func, uint16_t period, uint16_t delay);
+void removeTask(uint8_t task);
+void setTaskDeadline(uint8_t task, uint16_t deadline);
+uint16_t getTaskMisses(uint8_t task);
+
+void task_scheduler(void);
+void yieldTicks(uint16_t ticks);
+void yieldFor(uint16_t ms);
+
+/*****************************************************************************/
+// Idle
+
+// Idle time measurement, updated in idle() and the Timer 2 interrupt:
+extern volatile uint8_t cpu_idle;		// 1 while the CPU sleeps in idle()
+extern volatile uint16_t idle_start;	// Timer 2 clock when idle() fell asleep
+extern volatile uint32_t idle_time;		// 0.5us Timer 2 counts asleep this second
+extern volatile uint16_t idle_window;	// ms of the current second
+extern volatile uint8_t idle_percent;	// idle time of the last second
+
+void idle(void);
+uint8_t getIdlePercent(void);
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,197 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmTimer.c
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ *
+ * Software timers. A timer calls a function once after a delay or
+ * periodically, with 1ms resolution. There is no limit for the number
+ * of timers - you provide the memory for each timer:
+ *
+ * Example:
+ *
+ *			soft_timer_t blink_timer;
+ *
+ *			void blink(void)
+ *			{
+ *				static uint8_t leds;
+ *				setLEDs(leds ^= 1);
+ *			}
+ *
+ *			startTimer(&blink_timer, 500, 500, blink);	// every 500 ms
+ *			...
+ *			stopTimer(&blink_timer);
+ *
+ * The function is called in the Timer 2 interrupt! It must be very
+ * short (set a flag, change a variable, ...) and it must not wait or
+ * call functions like writeString. Use addTask (RobotArmScheduler.c)
+ * for longer jobs.
+ * A timer function may start or stop any timer, also its own one.
+ *
+ * The active timers are kept in a list sorted by expiry time. Each entry
+ * only stores the difference to the previous one, so timerTick() just
+ * decrements the first entry - the work per millisecond is the same for
+ * one or for a hundred timers. Starting and stopping a timer has to walk
+ * through the list.
+ *
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// Includes:
+
+#include "RobotArmBaseLib.h"
+
+/*****************************************************************************/
+// Variables:
+
+static soft_timer_t *timer_list;
+
+/*****************************************************************************/
+// Timer list:
+
+/**
+ * Sorts the timer into the list. Timers with the same expiry time run
+ * in the order they were started. Interrupts must be disabled.
+ */
+static void insertTimer(soft_timer_t *timer, uint16_t ms)
+{
+	soft_timer_t **link = &timer_list;
+
+	while(*link && (*link)->delta <= ms) {
+		ms -= (*link)->delta;
+		link = &(*link)->next;
+	}
+	timer->delta = ms;
+	timer->next = *link;
+	if(*link)
+		(*link)->delta -= ms;
+	*link = timer;
+}
+
+/**
+ * Removes the timer from the list. Interrupts must be disabled.
+ */
+static void removeTimer(soft_timer_t *timer)
+{
+	soft_timer_t **link = &timer_list;
+
+	while(*link) {
+		if(*link == timer) {
+			*link = timer->next;
+			if(timer->next)
+				timer->next->delta += timer->delta;
+			return;
+		}
+		link = &(*link)->next;
+	}
+}
+
+/*****************************************************************************/
+// Software timers:
+
+/**
+ * Starts a timer. func is called after ms milliseconds (at least 1ms)
+ * and then every period ms. With period = 0 it is only called once.
+ * If the timer is already active, it is restarted.
+ */
+void startTimer(soft_timer_t *timer, uint16_t ms, uint16_t period, timer_func_t func)
+{
+	if(!ms)
+		ms = 1;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(timer->active)
+			removeTimer(timer);
+		timer->period = period;
+		timer->func = func;
+		timer->active = true;
+		insertTimer(timer, ms);
+	}
+}
+
+/**
+ * Stops a timer. Does nothing if it is not active.
+ */
+void stopTimer(soft_timer_t *timer)
+{
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(timer->active) {
+			removeTimer(timer);
+			timer->active = false;
+		}
+	}
+}
+
+/**
+ * Returns true while a timer is waiting to expire. A one-shot timer is
+ * no longer active when its function is called.
+ */
+uint8_t isTimerActive(soft_timer_t *timer)
+{
+	return timer->active;
+}
+
+/**
+ * Returns the ms until the timer expires, 0 if it is not active.
+ */
+uint16_t getTimerRemaining(soft_timer_t *timer)
+{
+	uint16_t ms = 0;
+	soft_timer_t *t;
+
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		if(timer->active) {
+			for(t = timer_list; t; t = t->next) {
+				ms += t->delta;
+				if(t == timer)
+					break;
+			}
+		}
+	}
+	return ms;
+}
+
+/**
+ * Called every ms in the Timer 2 interrupt.
+ * Periodic timers are sorted in again before their function is called,
+ * so they do not drift and the function can stop or restart them.
+ */
+void timerTick(void)
+{
+	soft_timer_t *timer = timer_list;
+
+	if(!timer)
+		return;
+	timer->delta--;
+	while((timer = timer_list) && !timer->delta) {
+		timer_list = timer->next;
+		if(timer->period)
+			insertTimer(timer, timer->period);
+		else
+			timer->active = false;
+		timer->func();
+	}
+}
+
+/******************************************************************************
+ * Additional info
+ * ****************************************************************************
+ * Changelog:
+ * - v. 1.0 (initial release) 17.10.2026
+ *
+ * ****************************************************************************
+ * - LICENSE -
+ * GNU GPL v2 (http://www.gnu.org/licenses/gpl.txt)
+ * This program is free software. You can redistribute it and/or modify
+ * it under the terms of the GNU General Public License version 2 as published
+ * by the Free Software Foundation.
+ * ****************************************************************************
+ */
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,48 @@
+/* ****************************************************************************
+ *                           ______________________
+ *                           \| ROBOT ARM SYSTEM |/
+ *                            \_-_-_-_-_-_-_-_-_-_/         >>> BASE CONTROLLER
+ * ----------------------------------------------------------------------------
+ * File: RobotArmTimer.h
+ * Version: 1.0
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz
+ * ****************************************************************************
+ * Description:
+ * Software timers with callbacks. Detailled description of each function
+ * can be found in the RobotArmTimer.c file!
+ * This file is included by RobotArmBaseLib.h.
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARMTIMER_H
+#define ROBOTARMTIMER_H
+
+/*****************************************************************************/
+// Includes:
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// Software timers
+
+typedef void (*timer_func_t)(void);
+
+typedef struct soft_timer {
+	struct soft_timer *next;
+	uint16_t delta;		// ms after the previous timer in the list
+	uint16_t period;	// ms, 0 = one-shot timer
+	timer_func_t func;
+	uint8_t active;
+} soft_timer_t;
+
+void startTimer(soft_timer_t *timer, uint16_t ms, uint16_t period, timer_func_t func);
+void stopTimer(soft_timer_t *timer);
+uint8_t isTimerActive(soft_timer_t *timer);
+uint16_t getTimerRemaining(soft_timer_t *timer);
+
+void timerTick(void);
+
+#endif
+
+/*****************************************************************************/
+// EOF
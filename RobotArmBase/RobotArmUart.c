@@ -35,16 +35,146 @@
 /*****************************************************************************/
 // Includes:
 
+#include "RobotArmBase.h"
 #include "RobotArmUart.h"
+#include "RobotArmScheduler.h"	// idle()
+#include "RobotArmTimer.h"		// baudrate fallback timer
+#include "RobotArmIsrStats.h"
 
 
 
+/*****************************************************************************/
+// UART transmit buffer:
+
+// The transmit buffer is a ring buffer which is emptied by the
+// USART1_UDRE interrupt. head and tail are free running 8 bit counters,
+// the buffer position is obtained by masking them with
+// UART_TX_BUFFER_MASK. This way the buffer can be filled completely
+// and (head - tail) is always the number of bytes waiting.
+// head is only changed by the main program. tail is advanced by the ISR
+// and by the main program while the ISR can not run: writeChar() with
+// UART_TX_OVERWRITE discards the oldest byte in an ATOMIC_BLOCK and
+// pollTransmitBuffer() sends bytes with global interrupts disabled.
+
+volatile char uart_tx_buffer[UART_TX_BUFFER_SIZE];
+volatile uint8_t uart_tx_head;
+volatile uint8_t uart_tx_tail;
+volatile uint16_t uart_tx_dropped;
+volatile uint8_t uart_tx_sending;	// a byte was written to UDR1, TXC1 is pending
+volatile uint32_t uart_tx_count;
+uint8_t uart_tx_policy = UART_TX_BLOCK;
+
+ISR(USART1_UDRE_vect)
+{
+	ISR_STATS_ENTER();
+	uint8_t tail = uart_tx_tail;
+	if(tail != uart_tx_head) {
+		UCSR1A |= (1 << TXC1); // clear TXC1, so waitUntilTransmitComplete() works
+		UDR1 = uart_tx_buffer[tail & UART_TX_BUFFER_MASK];
+		uart_tx_sending = 1;
+		uart_tx_count++;
+		uart_tx_tail = tail + 1;
+	}
+	else
+		UCSR1B &= ~(1 << UDRIE1); // buffer empty - stop interrupt
+	ISR_STATS_LEAVE(ISR_STAT_UART_TX);
+}
+
+/**
+ * Sends the next byte of the transmit buffer by polling the UDRE1 flag.
+ * This is only used if global interrupts are disabled - otherwise the
+ * USART1_UDRE interrupt does this job and we must not interfere with it.
+ */
+static void pollTransmitBuffer(void)
+{
+	if(!(SREG & (1 << SREG_I)) && (UCSR1A & (1 << UDRE1))
+	   && uart_tx_tail != uart_tx_head) {
+		UCSR1A |= (1 << TXC1);
+		UDR1 = uart_tx_buffer[uart_tx_tail & UART_TX_BUFFER_MASK];
+		uart_tx_tail++;
+		uart_tx_sending = 1;
+		uart_tx_count++;
+	}
+}
+
+/**
+ * Sets what writeChar() does if the transmit buffer is full:
+ *
+ *	UART_TX_BLOCK     - wait until there is free space (default)
+ *	UART_TX_DROP      - discard the new character
+ *	UART_TX_OVERWRITE - discard the oldest character that is not sent yet
+ *
+ * Dropped characters are counted in uart_tx_dropped.
+ *
+ * Example:
+ *
+ *			// Telemetry output must never slow down the servo control:
+ *			setUARTTransmitPolicy(UART_TX_DROP);
+ */
+void setUARTTransmitPolicy(uint8_t policy)
+{
+	uart_tx_policy = policy;
+}
+
+/**
+ * Returns how many characters can be written before the transmit
+ * buffer is full.
+ */
+uint8_t getUARTTransmitFree(void)
+{
+	return UART_TX_BUFFER_SIZE - (uint8_t)(uart_tx_head - uart_tx_tail);
+}
+
+/**
+ * Non blocking version of writeChar. Puts the character into the
+ * transmit buffer and returns true - or returns false if the buffer
+ * is full. The overflow policy is not applied here!
+ *
+ * Example:
+ *
+ *			if(!tryWriteChar('X'))
+ *				doSomethingElseFirst();
+ */
+uint8_t tryWriteChar(char ch)
+{
+	uint8_t head = uart_tx_head;
+	if((uint8_t)(head - uart_tx_tail) >= UART_TX_BUFFER_SIZE)
+		return 0;
+	uart_tx_buffer[head & UART_TX_BUFFER_MASK] = ch;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		uart_tx_head = head + 1;
+		UCSR1B |= (1 << UDRIE1);
+	}
+	return 1;
+}
+
+/**
+ * Waits until all characters in the transmit buffer have been sent
+ * completely (including the stop bit of the last character).
+ * Call this before you change the baudrate, power down the board or
+ * need to be sure that a message has left the controller.
+ */
+void waitUntilTransmitComplete(void)
+{
+	while(uart_tx_tail != uart_tx_head)
+		pollTransmitBuffer();
+	if(uart_tx_sending) {
+		while(!(UCSR1A & (1 << TXC1)));
+		uart_tx_sending = 0;
+	}
+}
+
 /*****************************************************************************/
 // UART transmit functions:
 
 /**
  * Write a single character to the UART.
  *
+ * The character is put into the transmit buffer and sent in the
+ * background by the USART1_UDRE interrupt, so this function returns
+ * immediately unless the buffer is full. What happens then depends
+ * on setUARTTransmitPolicy().
+ *
  * Example:
  *
  *			writeChar('C');
@@ -66,8 +196,22 @@
  */
 void writeChar(char ch)
 {
-    while (!(UCSR1A & (1<<UDRE1)));
-    UDR1 = (uint8_t)ch;
+	while(!tryWriteChar(ch)) {
+		if(uart_tx_policy == UART_TX_DROP) {
+			uart_tx_dropped++;
+			return;
+		}
+		if(uart_tx_policy == UART_TX_OVERWRITE) {
+			ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+				if((uint8_t)(uart_tx_head - uart_tx_tail) >= UART_TX_BUFFER_SIZE) {
+					uart_tx_tail++;
+					uart_tx_dropped++;
+				}
+			}
+			continue;
+		}
+		pollTransmitBuffer();
+	}
 }
 
 /**
@@ -198,57 +342,205 @@ void writeIntegerLength(int16_t number, uint8_t base, uint8_t length)
 }
 
 /*****************************************************************************/
-// UART receive functions:
+// UART receive buffer:
+
+// The receive buffer is a ring buffer which is filled continuously by
+// the USART1_RX interrupt - no matter if the main program is waiting for
+// data or not. Same scheme as the transmit buffer: free running 8 bit
+// head (only changed by the ISR) and tail (only changed by the main
+// program) counters.
 
 volatile char uart_receive_buffer[UART_RECEIVE_BUFFER_SIZE];
-uint8_t buffer_pos;
+volatile uint8_t uart_rx_head;
+volatile uint8_t uart_rx_tail;
+
+volatile uint16_t uart_rx_overflows;	// buffer full - character lost
+volatile uint16_t uart_rx_overruns;		// hardware data overrun (DOR1)
+volatile uint16_t uart_rx_frame_errors;	// framing error (FE1)
+volatile uint32_t uart_rx_count;
+
 uint8_t uart_receive_bytes;
-volatile uint8_t uart_status;
+volatile uint8_t uart_status = UART_READY;
 
 
 ISR(USART1_RX_vect)
 {
-	volatile char recChar = UDR1;
-	if(uart_status == UART_BUISY) {
-		uart_receive_buffer[buffer_pos++] = recChar;
-		if(buffer_pos >= uart_receive_bytes)
+	ISR_STATS_ENTER();
+	uint8_t status = UCSR1A;	// must be read before UDR1!
+	char recChar = UDR1;
+	uint8_t head = uart_rx_head;
+
+	uart_rx_count++;
+	if(status & (1 << DOR1))
+		uart_rx_overruns++;
+	if(status & (1 << FE1))
+		uart_rx_frame_errors++;
+	else if((uint8_t)(head - uart_rx_tail) >= UART_RECEIVE_BUFFER_SIZE)
+		uart_rx_overflows++;
+	else {
+		uart_receive_buffer[head & UART_RECEIVE_BUFFER_MASK] = recChar;
+		uart_rx_head = ++head;
+
+		if(uart_status == UART_BUISY
+		   && (uint8_t)(head - uart_rx_tail) >= uart_receive_bytes)
 			uart_status = UART_DATA_AVAILABLE;
 	}
+	ISR_STATS_LEAVE(ISR_STAT_UART_RX);
 }
 
 /**
+ * Returns the number of characters waiting in the receive buffer.
  *
+ * Example:
+ *
+ *			if(getBufferLength() >= 3) {
+ *				// a complete 3 byte command is there
+ *			}
  */
-void receiveBytes(uint8_t numberOfBytes)
+uint8_t getBufferLength(void)
 {
-	buffer_pos = 0;
-	uart_receive_bytes = numberOfBytes;
-	uart_status = UART_BUISY;
+	return (uint8_t)(uart_rx_head - uart_rx_tail);
 }
 
 /**
- *
+ * Returns the next received character without removing it from the
+ * buffer. Returns 0 if the buffer is empty - check getBufferLength()
+ * first if 0 is a valid character for you!
  */
-void waitUntilReceptionComplete(void)
+char peekChar(void)
 {
-	while(getUARTReceiveStatus() == UART_BUISY);
+	uint8_t tail = uart_rx_tail;
+	if(tail == uart_rx_head)
+		return 0;
+	return uart_receive_buffer[tail & UART_RECEIVE_BUFFER_MASK];
 }
 
 /**
+ * Removes the next received character from the buffer and returns it.
+ * Returns 0 if the buffer is empty. This function does NOT wait for
+ * new data!
  *
+ * Example:
+ *
+ *			while(getBufferLength())
+ *				handleCommandChar(readChar());
  */
-void copyReceivedBytesToBuffer(char *buffer)
+char readChar(void)
+{
+	uint8_t tail = uart_rx_tail;
+	char ch;
+	if(tail == uart_rx_head)
+		return 0;
+	ch = uart_receive_buffer[tail & UART_RECEIVE_BUFFER_MASK];
+	uart_rx_tail = tail + 1;
+	return ch;
+}
+
+/**
+ * Copies up to numberOfChars received characters to buf and removes
+ * them from the receive buffer. Returns the number of characters copied.
+ * The result is NOT null terminated!
+ */
+uint8_t readChars(char *buf, uint8_t numberOfChars)
 {
 	uint8_t i = 0;
-	while(i < uart_receive_bytes) {
-		buffer[i] = uart_receive_buffer[i];
-		i++;
+	while(i < numberOfChars && uart_rx_tail != uart_rx_head)
+		buf[i++] = readChar();
+	return i;
+}
+
+/**
+ * Non blocking line reader. If a complete line (terminated with the
+ * delimiter character) is in the receive buffer, it is copied to buf
+ * without the delimiter, null terminated, and the length is returned.
+ * Otherwise 0 is returned and nothing is removed from the buffer.
+ *
+ * Lines that do not fit into buf (size - 1 characters) are returned
+ * in parts. Empty lines are skipped.
+ *
+ * Example:
+ *
+ *			char line[32];
+ *			if(readLine(line, sizeof(line), '\n')) {
+ *				writeString_P("Got: ");
+ *				writeString(line);
+ *			}
+ */
+uint8_t readLine(char *buf, uint8_t size, char delimiter)
+{
+	uint8_t length, i;
+
+	if(size == 0)
+		return 0;
+	while(uart_rx_tail != uart_rx_head && peekChar() == delimiter)
+		uart_rx_tail++;	// skip empty lines
+
+	length = getBufferLength();
+	for(i = 0; i < length && i < size - 1; i++)
+		if(uart_receive_buffer[(uint8_t)(uart_rx_tail + i) & UART_RECEIVE_BUFFER_MASK] == delimiter)
+			break;
+	if(i == length && i < size - 1)
+		return 0;	// line not complete yet
+
+	readChars(buf, i);
+	buf[i] = 0;
+	if(uart_rx_tail != uart_rx_head && peekChar() == delimiter)
+		uart_rx_tail++;
+	return i;
+}
+
+/**
+ * Discards all characters in the receive buffer.
+ */
+void clearReceptionBuffer(void)
+{
+	uart_rx_tail = uart_rx_head;
+}
+
+/*****************************************************************************/
+// UART receive functions:
+
+// These functions wait for a fixed number of characters. They work on top
+// of the receive buffer, so characters that arrived before receiveBytes()
+// was called are NOT lost anymore.
+
+/**
+ * Starts waiting for numberOfBytes characters. uart_status is set to
+ * UART_DATA_AVAILABLE as soon as that many characters are in the receive
+ * buffer (maybe even immediately).
+ */
+void receiveBytes(uint8_t numberOfBytes)
+{
+	if(numberOfBytes > UART_RECEIVE_BUFFER_SIZE)
+		numberOfBytes = UART_RECEIVE_BUFFER_SIZE;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		uart_receive_bytes = numberOfBytes;
+		uart_status = (getBufferLength() >= numberOfBytes) ?
+						UART_DATA_AVAILABLE : UART_BUISY;
 	}
+}
+
+/**
+ * Blocks until the characters requested with receiveBytes are there.
+ */
+void waitUntilReceptionComplete(void)
+{
+	while(getUARTReceiveStatus() == UART_BUISY)
+		idle();
+}
+
+/**
+ * Moves the characters requested with receiveBytes from the receive
+ * buffer to buffer.
+ */
+void copyReceivedBytesToBuffer(char *buffer)
+{
+	readChars(buffer, uart_receive_bytes);
 	uart_status = UART_READY;
 }
 
 /**
- *
+ * Cancels receiveBytes. Characters stay in the receive buffer.
  */
 void stopReception(void)
 {
@@ -257,7 +549,7 @@ void stopReception(void)
 }
 
 /**
- *
+ * Blocking reception of numberOfBytes characters into buffer.
  */
 void receiveBytesToBuffer(uint8_t numberOfBytes, char *buffer)
 {
@@ -268,11 +560,150 @@ void receiveBytesToBuffer(uint8_t numberOfBytes, char *buffer)
 
 
 
+/*****************************************************************************/
+// Baudrate:
+
+// UBRR values and U2X flags for the UART_BAUD_xxx codes, calculated by the
+// compiler for F_CPU (s. BAUD_SETTING in RobotArmBase.h). Baudrates with
+// too large an error for the crystal are BAUD_NONE:
+#define BAUD_NONE 0xFFFF
+#define BAUD_ENTRY(__BAUD__) \
+	(BAUD_SUPPORTED(__BAUD__) ? BAUD_SETTING(__BAUD__) : BAUD_NONE)
+
+const uint16_t uart_baud_table[UART_BAUD_COUNT] PROGMEM = {
+	BAUD_ENTRY(BAUD_LOW),
+	BAUD_ENTRY(BAUD_250K),
+	BAUD_ENTRY(BAUD_HIGH),
+	BAUD_ENTRY(BAUD_1M)
+};
+
+uint8_t uart_baud = UART_BAUD_38400;
+static soft_timer_t uart_baud_fallback_timer;
+
+/**
+ * Writes the baudrate registers - does not care about characters that
+ * are just sent or received!
+ */
+static void writeBaudrate(uint8_t baud)
+{
+	uint16_t setting = pgm_read_word(&uart_baud_table[baud]);
+	UBRR1H = (setting >> 8) & 0x0F;
+	UBRR1L = (uint8_t)setting;
+	UCSR1A = (setting & 0x8000) ? (1 << U2X1) : 0;
+	uart_baud = baud;
+}
+
+/**
+ * Returns true if the baudrate can be used with the crystal of the board
+ * (all on the v3 PCB, only UART_BAUD_38400 with 16.384MHz).
+ */
+uint8_t isUARTBaudrateSupported(uint8_t baud)
+{
+	return baud < UART_BAUD_COUNT && pgm_read_word(&uart_baud_table[baud]) != BAUD_NONE;
+}
+
+/**
+ * Changes the UART baudrate. Waits until the transmit buffer is empty
+ * first. baud is one of UART_BAUD_38400, UART_BAUD_250K, UART_BAUD_500K
+ * or UART_BAUD_1M - it is ignored if isUARTBaudrateSupported() is false.
+ *
+ * Hint: at 1 MBaud a new character arrives every 10us (160 cycles), so
+ * other interrupts must be short to avoid receive overruns - check
+ * uart_rx_overruns!
+ *
+ * Example:
+ *
+ *			setUARTBaudrate(UART_BAUD_500K);
+ */
+void setUARTBaudrate(uint8_t baud)
+{
+	if(!isUARTBaudrateSupported(baud))
+		return;
+	waitUntilTransmitComplete();
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		stopTimer(&uart_baud_fallback_timer);
+		writeBaudrate(baud);
+	}
+}
+
+/**
+ * Same as setUARTBaudrate, but falls back to 38.4 kBaud after timeout
+ * milliseconds if confirmUARTBaudrate() is not called until then.
+ * This makes sure the host can always reach the robot again if the new
+ * baudrate does not work (e.g. because of the cable or the USB adapter).
+ */
+void setUARTBaudrateTimed(uint8_t baud, uint16_t timeout)
+{
+	setUARTBaudrate(baud);
+	if(baud != UART_BAUD_38400)
+		startTimer(&uart_baud_fallback_timer, timeout, 0, fallbackUARTBaudrate);
+}
+
+/**
+ * Keeps the baudrate that was set with setUARTBaudrateTimed().
+ */
+void confirmUARTBaudrate(void)
+{
+	stopTimer(&uart_baud_fallback_timer);
+}
+
+/**
+ * Called from the Timer 2 interrupt when the fallback timer has run out
+ * (software timer, s. RobotArmTimer.c).
+ */
+void fallbackUARTBaudrate(void)
+{
+	writeBaudrate(UART_BAUD_38400);
+}
+
+/**
+ * Returns the code of the current baudrate (UART_BAUD_xxx).
+ */
+uint8_t getUARTBaudrate(void)
+{
+	return uart_baud;
+}
+
+/**
+ * Number of characters sent/received since power on. Read them twice
+ * with some delay in between to calculate the throughput.
+ */
+uint32_t getUARTTransmitCount(void)
+{
+	uint32_t count;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		count = uart_tx_count;
+	}
+	return count;
+}
+
+uint32_t getUARTReceiveCount(void)
+{
+	uint32_t count;
+	ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+		count = uart_rx_count;
+	}
+	return count;
+}
+
+
+
 /******************************************************************************
  * Additional info
  * ****************************************************************************
  * Changelog:
  * - v. 1.0 (initial release) 10.04.2007 by Dominik S. Herwald
+ * - v. 1.1 17.10.2026: interrupt driven transmit ring buffer with
+ *          tryWriteChar, overflow policy and waitUntilTransmitComplete
+ * - v. 1.2 17.10.2026: continuously armed receive ring buffer with
+ *          getBufferLength, readChar, peekChar, readChars and readLine
+ * - v. 1.3 17.10.2026: baudrate table for 38.4k/250k/500k/1M with timed
+ *          fallback, transmit/receive counters
+ * - v. 1.4 17.10.2026: waitUntilReceptionComplete sleeps in idle mode
+ * - v. 1.5 17.10.2026: baudrate fallback uses a software timer
+ * - v. 1.6 17.10.2026: optional interrupt statistics (ISR_STATS)
+ * - v. 1.7 17.10.2026: baudrate table for the crystal of the board
+ *          revision, isUARTBaudrateSupported
  *
  * ****************************************************************************
  * Bugs, feedback, questions and modifications can be posted on the AREXX Forum
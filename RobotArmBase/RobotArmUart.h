@@ -31,8 +31,35 @@
 #include <avr/io.h>			// I/O Port definitions
 #include <avr/interrupt.h>	// Interrupt macros (e.g. cli(), sei())
 
+#include <util/atomic.h>	// ATOMIC_BLOCK
 #include <string.h>
 
+/*****************************************************************************/
+// UART transmit buffer
+
+// Size of the transmit ring buffer. Must be a power of two and not
+// larger than 128. Can be changed with -DUART_TX_BUFFER_SIZE=...
+#ifndef UART_TX_BUFFER_SIZE
+#define UART_TX_BUFFER_SIZE 64
+#endif
+#define UART_TX_BUFFER_MASK (UART_TX_BUFFER_SIZE - 1)
+
+#if (UART_TX_BUFFER_SIZE & UART_TX_BUFFER_MASK) || UART_TX_BUFFER_SIZE > 128
+#error "UART_TX_BUFFER_SIZE must be a power of two <= 128!"
+#endif
+
+// Overflow policy - what writeChar does if the buffer is full:
+#define UART_TX_BLOCK 0		// wait for free space
+#define UART_TX_DROP 1		// discard the new character
+#define UART_TX_OVERWRITE 2	// discard the oldest character
+
+extern volatile uint16_t uart_tx_dropped;
+
+void setUARTTransmitPolicy(uint8_t policy);
+uint8_t getUARTTransmitFree(void);
+uint8_t tryWriteChar(char ch);
+void waitUntilTransmitComplete(void);
+
 /*****************************************************************************/
 // UART
 
@@ -49,7 +76,27 @@ void writeNStringP(const char *pstring);
 void writeInteger(int16_t number, uint8_t base);
 void writeIntegerLength(int16_t number, uint8_t base, uint8_t length);
 
-#define UART_RECEIVE_BUFFER_SIZE 16
+// Size of the receive ring buffer. Same rules as for the transmit buffer.
+#ifndef UART_RECEIVE_BUFFER_SIZE
+#define UART_RECEIVE_BUFFER_SIZE 64
+#endif
+#define UART_RECEIVE_BUFFER_MASK (UART_RECEIVE_BUFFER_SIZE - 1)
+
+#if (UART_RECEIVE_BUFFER_SIZE & UART_RECEIVE_BUFFER_MASK) || UART_RECEIVE_BUFFER_SIZE > 128
+#error "UART_RECEIVE_BUFFER_SIZE must be a power of two <= 128!"
+#endif
+
+extern volatile uint16_t uart_rx_overflows;
+extern volatile uint16_t uart_rx_overruns;
+extern volatile uint16_t uart_rx_frame_errors;
+
+uint8_t getBufferLength(void);
+char peekChar(void);
+char readChar(void);
+uint8_t readChars(char *buf, uint8_t numberOfChars);
+uint8_t readLine(char *buf, uint8_t size, char delimiter);
+void clearReceptionBuffer(void);
+
 #define UART_DATA_AVAILABLE 2
 #define UART_READY 1
 #define UART_BUISY 0
@@ -64,6 +111,25 @@ void receiveBytesToBuffer(uint8_t numberOfBytes, char *buffer);
 
 #define getUARTReceiveStatus() uart_status
 
+/*****************************************************************************/
+// Baudrate
+
+#define UART_BAUD_38400		0
+#define UART_BAUD_250K		1
+#define UART_BAUD_500K		2
+#define UART_BAUD_1M		3
+#define UART_BAUD_COUNT		4
+
+uint8_t isUARTBaudrateSupported(uint8_t baud);
+void setUARTBaudrate(uint8_t baud);
+void setUARTBaudrateTimed(uint8_t baud, uint16_t timeout);
+void confirmUARTBaudrate(void);
+void fallbackUARTBaudrate(void);
+uint8_t getUARTBaudrate(void);
+
+uint32_t getUARTTransmitCount(void);
+uint32_t getUARTReceiveCount(void);
+
 #endif
 
 /******************************************************************************
@@ -0,0 +1,147 @@
+/* ****************************************************************************
+ * File: bench/bench.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * main() of the benchmark programs. s. bench/bench.h
+ * ****************************************************************************
+ */
+
+#include "bench.h"
+
+typedef void (*bench_func_t)(uint8_t run);
+
+static uint8_t bench_stack;
+
+/*****************************************************************************/
+// Report on USART0 (polled, independent of the library UART):
+
+static void benchPutc(char ch)
+{
+	while(!(UCSR0A & (1 << UDRE0)));
+	UDR0 = ch;
+}
+
+static void benchPuts_P(const char *s)
+{
+	char ch;
+	while((ch = pgm_read_byte(s++)))
+		benchPutc(ch);
+}
+
+static void benchPutu(uint32_t value)
+{
+	char buffer[11];
+	char *p = buffer;
+
+	benchPutc(' ');
+	ultoa(value, buffer, DEC);
+	while(*p)
+		benchPutc(*p++);
+}
+
+/*****************************************************************************/
+// Measurement:
+
+static void benchEmpty(uint8_t run)
+{
+	(void)run;
+	asm volatile("" ::: "memory");
+}
+
+/**
+ * Runs func once with disabled interrupts and returns the Timer 1 cycles.
+ * The stack depth is stored in bench_stack. Must not be inlined: the
+ * paint loop works below the stack pointer of this function.
+ */
+static uint16_t __attribute__((noinline)) benchMeasure(bench_func_t func, uint8_t run)
+{
+	uint8_t *top, *p;
+	uint16_t cycles;
+
+	cli();
+	top = (uint8_t *)(uintptr_t)SP;		// first free byte
+	for(p = top - BENCH_STACK_AREA + 1; p <= top; p++)
+		*p = STACK_PAINT;
+	TIFR = (1 << TOV1);
+	TCNT1 = 0;
+	func(run);
+	cycles = TCNT1;
+	if(TIFR & (1 << TOV1))
+		cycles = 0xFFFF;
+	for(p = top - BENCH_STACK_AREA + 1; p <= top && *p == STACK_PAINT; p++);
+	bench_stack = top - p + 1;
+	sei();			// an ISR called by the benchmark did this already
+	return cycles;
+}
+
+void benchQuiet(void)
+{
+	stopADCScanner();
+	TIMSK &= ~(1 << OCIE2);
+}
+
+/*****************************************************************************/
+// Main:
+
+int main(void)
+{
+	uint16_t overhead, cycles, min = 0xFFFF, max = 0;
+	uint8_t stack_overhead, stack = 0;
+	uint32_t sum = 0;
+	uint8_t run;
+
+	initRobotBase();
+
+	// USART0, 8N1, 1 MBaud, transmitter only:
+	UBRR0H = 0;
+	UBRR0L = BENCH_BAUD_1M;
+	UCSR0A = 0;
+	UCSR0C = (1 << UCSZ01) | (1 << UCSZ00);
+	UCSR0B = (1 << TXEN0);
+
+	// Timer 1 counts CPU cycles instead of generating the servo PWM:
+	TCCR1A = 0;
+	TCCR1B = (1 << CS10);
+
+	benchSetup();
+	overhead = benchMeasure(benchEmpty, 0);
+	stack_overhead = bench_stack;
+
+	for(run = 0; run < bench_runs; run++) {
+		benchPrepare(run);
+		cycles = benchMeasure(benchRoutine, run);
+		if(cycles != 0xFFFF)
+			cycles -= overhead;
+		if(cycles < min)
+			min = cycles;
+		if(cycles > max)
+			max = cycles;
+		sum += cycles;
+		if(bench_stack - stack_overhead > stack)
+			stack = bench_stack - stack_overhead;
+	}
+
+	benchPuts_P(PSTR("BENCH "));
+	benchPuts_P(bench_name);
+	benchPutc(' ');
+	benchPuts_P(bench_symbol);
+	benchPutu(bench_runs);
+	benchPutu(min);
+	benchPutu(sum / bench_runs);
+	benchPutu(max);
+	benchPutu(stack);
+	UCSR0A |= (1 << TXC0);
+	benchPutc('\n');
+	while(!(UCSR0A & (1 << TXC0)));
+
+	// Sleeping with disabled interrupts ends the simulation:
+	cli();
+	sleep_enable();
+	sleep_cpu();
+	while(true);
+	return 0;
+}
+
+/*****************************************************************************/
+// EOF
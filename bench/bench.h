@@ -0,0 +1,74 @@
+/* ****************************************************************************
+ * File: bench/bench.h
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * Microbenchmark harness for the library routines. Every benchmark is a
+ * small program bench/bench_xxx.c that is linked with bench/bench.c and
+ * the library. bench.c calls initRobotBase(), then measures the routine
+ * bench_runs times and writes one line to USART0:
+ *
+ *   BENCH <name> <symbol> <runs> <min> <avg> <max> <stack>
+ *
+ * cycles are counted with Timer 1 (prescaler 1) with disabled interrupts,
+ * the stack depth is measured by painting the SRAM below the stack
+ * pointer. Both are corrected by the same measurement of an empty
+ * routine, so they show the routine itself without the harness call.
+ * Routines that take more than 65535 cycles are reported as 65535.
+ *
+ * bench/run.sh runs the programs under simavr, adds the flash size of
+ * <symbol> and the size of the program and writes a CSV report.
+ * The same programs also run on the real board (USART0 output on the
+ * programming connector), the numbers are the same.
+ *
+ * Example - bench/bench_foo.c:
+ *
+ *		#include "bench.h"
+ *
+ *		BENCH_NAME("foo", foo);
+ *		const uint8_t bench_runs = 16;
+ *
+ *		void benchSetup(void) { }				// once, not measured
+ *		void benchPrepare(uint8_t run) { }		// before every run
+ *		void benchRoutine(uint8_t run)			// measured
+ *		{
+ *			foo(run);
+ *		}
+ * ****************************************************************************
+ */
+
+#ifndef BENCH_H
+#define BENCH_H
+
+#include "../RobotArmBase/RobotArmBaseLib.h"
+
+#define BENCH_STACK_AREA	256		// bytes painted below the stack pointer
+#define BENCH_BAUD_1M		0		// UBRR0 for USART0 with 1 MBaud
+
+#define BENCH_STRING_(__X__) #__X__
+#define BENCH_STRING(__X__) BENCH_STRING_(__X__)
+
+// Name in the report and symbol in the ELF file for the flash size.
+// The symbol is expanded first, so ISR vectors like TIMER2_COMP_vect
+// become __vector_9.
+#define BENCH_NAME(__NAME__, __SYMBOL__) \
+	const char bench_name[] PROGMEM = __NAME__; \
+	const char bench_symbol[] PROGMEM = BENCH_STRING(__SYMBOL__)
+
+extern const char bench_name[] PROGMEM;
+extern const char bench_symbol[] PROGMEM;
+extern const uint8_t bench_runs;
+
+void benchSetup(void);
+void benchPrepare(uint8_t run);
+void benchRoutine(uint8_t run);
+
+// Stops the interrupts of the library (Timer 2, ADC scanner), so ISRs can
+// be called directly and motionTick() is only called by the benchmark.
+// mSleep() & co. wait forever after this:
+void benchQuiet(void);
+
+#endif
+
+/*****************************************************************************/
+// EOF
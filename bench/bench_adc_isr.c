@@ -0,0 +1,38 @@
+/* ****************************************************************************
+ * File: bench/bench_adc_isr.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * The ADC scanner interrupt, called directly for all 8 channels with the
+ * default filters and overcurrent check.
+ * ****************************************************************************
+ */
+
+#include "bench.h"
+
+BENCH_NAME("ADC_vect", ADC_vect);
+const uint8_t bench_runs = 32;
+
+void ADC_vect(void);
+
+void benchSetup(void)
+{
+	benchQuiet();
+	// ADC on, without interrupt - the ISR starts the next conversion:
+	ADCSRA = (1<<ADEN) | (1<<ADPS2) | (1<<ADPS1);
+}
+
+void benchPrepare(uint8_t run)
+{
+	(void)run;
+	while(ADCSRA & (1 << ADSC));
+}
+
+void benchRoutine(uint8_t run)
+{
+	(void)run;
+	ADC_vect();
+}
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,35 @@
+/* ****************************************************************************
+ * File: bench/bench_atan2.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * atan2() of the avr-libc (float) for the vectors of bench_fixAtan2.c.
+ * The conversion to float is done in benchPrepare and not measured.
+ * ****************************************************************************
+ */
+
+#include "bench_math.h"
+
+BENCH_NAME("atan2", atan2);
+const uint8_t bench_runs = BENCH_MATH_RUNS;
+
+static double x, y;
+
+void benchSetup(void)
+{
+}
+
+void benchPrepare(uint8_t run)
+{
+	x = bench_vectors[run][0];
+	y = bench_vectors[run][1];
+}
+
+void benchRoutine(uint8_t run)
+{
+	(void)run;
+	bench_float_result = atan2(y, x);
+}
+
+/*****************************************************************************/
+// EOF
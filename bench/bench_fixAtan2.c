@@ -0,0 +1,31 @@
+/* ****************************************************************************
+ * File: bench/bench_fixAtan2.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * fixAtan2() of vectors in all quadrants with 1 to 23 bit components
+ * (RobotArmMath.c), compare with bench_atan2.c.
+ * ****************************************************************************
+ */
+
+#include "bench_math.h"
+
+BENCH_NAME("fixAtan2", fixAtan2);
+const uint8_t bench_runs = BENCH_MATH_RUNS;
+
+void benchSetup(void)
+{
+}
+
+void benchPrepare(uint8_t run)
+{
+	(void)run;
+}
+
+void benchRoutine(uint8_t run)
+{
+	bench_fix_result = fixAtan2(bench_vectors[run][1], bench_vectors[run][0]);
+}
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,31 @@
+/* ****************************************************************************
+ * File: bench/bench_fixSin.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * fixSin() of angles in all four quadrants (RobotArmMath.c), compare with
+ * bench_sin.c.
+ * ****************************************************************************
+ */
+
+#include "bench_math.h"
+
+BENCH_NAME("fixSin", fixSin);
+const uint8_t bench_runs = BENCH_MATH_RUNS;
+
+void benchSetup(void)
+{
+}
+
+void benchPrepare(uint8_t run)
+{
+	(void)run;
+}
+
+void benchRoutine(uint8_t run)
+{
+	bench_fix_result = fixSin(bench_angles[run]);
+}
+
+/*****************************************************************************/
+// EOF
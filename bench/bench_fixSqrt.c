@@ -0,0 +1,31 @@
+/* ****************************************************************************
+ * File: bench/bench_fixSqrt.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * fixSqrt() of 0 up to 2^32 - 1 (RobotArmMath.c), compare with
+ * bench_sqrt.c.
+ * ****************************************************************************
+ */
+
+#include "bench_math.h"
+
+BENCH_NAME("fixSqrt", fixSqrt);
+const uint8_t bench_runs = BENCH_MATH_RUNS;
+
+void benchSetup(void)
+{
+}
+
+void benchPrepare(uint8_t run)
+{
+	(void)run;
+}
+
+void benchRoutine(uint8_t run)
+{
+	bench_fix_result = fixSqrt(bench_squares[run]);
+}
+
+/*****************************************************************************/
+// EOF
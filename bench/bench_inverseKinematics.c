@@ -0,0 +1,65 @@
+/* ****************************************************************************
+ * File: bench/bench_inverseKinematics.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * inverseKinematics() (RobotArmKinematics.c) with the default joint
+ * calibration. The poses are calculated from servo offsets (elbow up)
+ * with forwardKinematics() in benchSetup, so all of them are solved with
+ * KIN_OK. The first half spreads over the work space, in the second half
+ * the elbow is almost stretched (1 to 10 degree) and the wrist point is
+ * near the end of the reach. Closer to stretched the rounded pose may be
+ * out of reach, that returns early.
+ * ****************************************************************************
+ */
+
+#include "bench.h"
+#include "../RobotArmBase/RobotArmKinematics.h"
+
+BENCH_NAME("inverseKinematics", inverseKinematics);
+const uint8_t bench_runs = 16;
+
+#define STRETCHED (KIN_DEFAULT_QUARTER / 9)		// elbow offset for 10 degree
+
+static const int16_t joints[16][6] = {
+	{0, 0, 0, -300, 0, 0},
+	{0, -400, 100, -200, -100, 0},
+	{0, 250, -300, -450, 200, 0},
+	{0, 480, 200, -150, -300, 0},
+	{0, -150, -450, -350, 400, 0},
+	{0, 350, 400, -250, 100, 0},
+	{0, -300, -100, -400, -450, 0},
+	{0, 100, 300, -120, 250, 0},
+	{0, 0, 0, -STRETCHED, 0, 0},
+	{0, -400, 100, -STRETCHED / 2, -100, 0},
+	{0, 250, -300, -STRETCHED / 4, 200, 0},
+	{0, 480, 200, -20, -300, 0},
+	{0, -150, -450, -10, 400, 0},
+	{0, 350, 400, -5, 100, 0},
+	{0, -300, -100, -15, -450, 0},
+	{0, 100, 300, -12, 250, 0}
+};
+static kin_pose_t poses[16];
+static int16_t offsets[6];
+volatile uint8_t bench_kin_result;
+
+void benchSetup(void)
+{
+	uint8_t run;
+
+	for(run = 0; run < bench_runs; run++)
+		forwardKinematics(joints[run], &poses[run]);
+}
+
+void benchPrepare(uint8_t run)
+{
+	(void)run;
+}
+
+void benchRoutine(uint8_t run)
+{
+	bench_kin_result = inverseKinematics(&poses[run], offsets);
+}
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,48 @@
+/* ****************************************************************************
+ * File: bench/bench_math.h
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * Inputs of the math benchmarks. bench_fixSin.c and bench_sin.c & co.
+ * use the same values, so the report compares RobotArmMath with the
+ * float functions of the avr-libc for the same work.
+ * ****************************************************************************
+ */
+
+#ifndef BENCH_MATH_H
+#define BENCH_MATH_H
+
+#include "bench.h"
+#include <math.h>
+
+#define BENCH_MATH_RUNS		16
+
+// Binary angles (65536 = 360 degree) in all four quadrants:
+static const int16_t bench_angles[BENCH_MATH_RUNS] = {
+	0, 1000, 5461, 8192, 12345, 16384, 20000, 27307,
+	-32768, -30000, -21845, -16384, -9000, -4096, -100, 32767
+};
+
+// Vectors (x, y) in all quadrants, small and large:
+static const int32_t bench_vectors[BENCH_MATH_RUNS][2] = {
+	{1000, 0}, {1000, 577}, {1, 1}, {-500, 866},
+	{-30000, 1}, {-7071, -7071}, {0, -2000}, {12345, -6789},
+	{2000000, 1000000}, {-3, 4}, {100000, 99999}, {-1, -100000},
+	{40000, 40000}, {7, -7000000}, {-123456, 654321}, {32767, 32767}
+};
+
+// Squares of 16 bit values and numbers in between:
+static const uint32_t bench_squares[BENCH_MATH_RUNS] = {
+	0, 1, 2, 99, 10000, 65535, 65536, 1000000,
+	3610000, 12345678, 100000000, 268435456, 999999999, 2147483647,
+	4000000000UL, 4294836225UL
+};
+
+// Result sink, so the compiler can not remove the calls:
+static volatile int32_t bench_fix_result;
+static volatile double bench_float_result;
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,42 @@
+/* ****************************************************************************
+ * File: bench/bench_motionTick.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * One 1ms step of the motion engine (what s_Move() waits for), with one
+ * servo moving at constant speed and all six moving with moveAllTo().
+ * The first half of the runs is the single servo, the second half all.
+ * ****************************************************************************
+ */
+
+#include "bench.h"
+
+BENCH_NAME("motionTick", motionTick);
+const uint8_t bench_runs = 32;
+
+static const int16_t pose[6] = {100, 200, -150, 300, -250, 50};
+
+void benchSetup(void)
+{
+	Default_Start_position();
+	benchQuiet();		// motionTick() is only called by the benchmark
+}
+
+void benchPrepare(uint8_t run)
+{
+	if(run == 0)
+		moveTo(2, 300, 1);
+	else if(run == bench_runs / 2) {
+		stopMotion();
+		moveAllTo(pose, 1);
+	}
+}
+
+void benchRoutine(uint8_t run)
+{
+	(void)run;
+	motionTick();
+}
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,34 @@
+/* ****************************************************************************
+ * File: bench/bench_sin.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * sin() of the avr-libc (float) for the angles of bench_fixSin.c. The
+ * conversion to radians is done in benchPrepare and not measured.
+ * ****************************************************************************
+ */
+
+#include "bench_math.h"
+
+BENCH_NAME("sin", sin);
+const uint8_t bench_runs = BENCH_MATH_RUNS;
+
+static double angle;
+
+void benchSetup(void)
+{
+}
+
+void benchPrepare(uint8_t run)
+{
+	angle = bench_angles[run] * (M_PI / 32768.0);
+}
+
+void benchRoutine(uint8_t run)
+{
+	(void)run;
+	bench_float_result = sin(angle);
+}
+
+/*****************************************************************************/
+// EOF
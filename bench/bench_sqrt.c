@@ -0,0 +1,34 @@
+/* ****************************************************************************
+ * File: bench/bench_sqrt.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * sqrt() of the avr-libc (float) for the values of bench_fixSqrt.c. The
+ * conversion to float is done in benchPrepare and not measured.
+ * ****************************************************************************
+ */
+
+#include "bench_math.h"
+
+BENCH_NAME("sqrt", sqrt);
+const uint8_t bench_runs = BENCH_MATH_RUNS;
+
+static double value;
+
+void benchSetup(void)
+{
+}
+
+void benchPrepare(uint8_t run)
+{
+	value = bench_squares[run];
+}
+
+void benchRoutine(uint8_t run)
+{
+	(void)run;
+	bench_float_result = sqrt(value);
+}
+
+/*****************************************************************************/
+// EOF
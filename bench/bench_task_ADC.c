@@ -0,0 +1,35 @@
+/* ****************************************************************************
+ * File: bench/bench_task_ADC.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * One call of the polled task_ADC() that stores a result and starts the
+ * next conversion (ADC scanner stopped).
+ * ****************************************************************************
+ */
+
+#include "bench.h"
+
+BENCH_NAME("task_ADC", task_ADC);
+const uint8_t bench_runs = 16;
+
+void benchSetup(void)
+{
+	benchQuiet();
+	task_ADC();		// start the first conversion
+}
+
+void benchPrepare(uint8_t run)
+{
+	(void)run;
+	while(ADCSRA & (1 << ADSC));
+}
+
+void benchRoutine(uint8_t run)
+{
+	(void)run;
+	task_ADC();
+}
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,64 @@
+/* ****************************************************************************
+ * File: bench/bench_timer2_isr.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * The Timer 2 interrupt, called directly. Min is the 100us tick.
+ * The first half of the runs has one servo moving (every tenth run is
+ * the 1ms tick with software timers, motion engine and stack guard).
+ * The second half is the worst case: every run is a 1ms tick, all six
+ * servos use S-curve profiles and follow a path of short queued
+ * segments, so the synchronized move and the start of the next segment
+ * (startMove divides) are in the max.
+ * ****************************************************************************
+ */
+
+#include "bench.h"
+
+BENCH_NAME("TIMER2_COMP_vect", TIMER2_COMP_vect);
+const uint8_t bench_runs = 60;
+
+void TIMER2_COMP_vect(void);
+
+static const int16_t path[2][6] = {
+	{6, -5, 4, -3, 2, -1},
+	{-2, 3, -4, 5, -6, 1}
+};
+static uint8_t path_next;
+
+void benchSetup(void)
+{
+	uint8_t servo;
+
+	Default_Start_position();
+	benchQuiet();
+	moveTo(2, 300, 1);
+	for(servo = 1; servo <= 6; servo++)
+		setMotionProfile(servo, MOTION_SCURVE, MOTION_FIX(2),
+		                 MOTION_FIX(0.5), MOTION_FIX(0.25));
+}
+
+void benchPrepare(uint8_t run)
+{
+	uint8_t servo;
+
+	if(run < bench_runs / 2)
+		return;
+	if(run == bench_runs / 2) {
+		stopMotion();
+		for(servo = 1; servo <= 6; servo++)		// at the end of the path
+			moveTo(servo, path[1][servo - 1], 0);
+	}
+	while(getMotionQueueFree())		// keep the path going
+		queueMove(path[path_next++ & 1], 0);
+	ms_timer = 9;	// the next tick is the 1ms tick
+}
+
+void benchRoutine(uint8_t run)
+{
+	(void)run;
+	TIMER2_COMP_vect();
+}
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,33 @@
+/* ****************************************************************************
+ * File: bench/bench_writeInteger.c
+ * Target: Robotarm v3 - ATMEGA64 @16.000MHz, run under simavr (make bench)
+ * ****************************************************************************
+ * Description:
+ * writeInteger() of values with 1..6 characters into the transmit buffer.
+ * ****************************************************************************
+ */
+
+#include "bench.h"
+
+BENCH_NAME("writeInteger", writeInteger);
+const uint8_t bench_runs = 16;
+
+static const int16_t values[4] = {7, 1234, -32768, 512};
+
+void benchSetup(void)
+{
+}
+
+void benchPrepare(uint8_t run)
+{
+	(void)run;
+	waitUntilTransmitComplete();	// empty transmit buffer for every run
+}
+
+void benchRoutine(uint8_t run)
+{
+	writeInteger(values[run & 3], DEC);
+}
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,39 @@
+#!/bin/sh
+# ****************************************************************************
+# File: bench/run.sh
+# Target: host PC, simavr and avr-binutils
+# ****************************************************************************
+# Description:
+# Runs the benchmark programs under simavr and writes a CSV report to
+# stdout (s. bench/bench.h). Called by "make bench":
+#
+#   bench/run.sh <simavr> <mcu> bench/bench_xxx.elf ...
+#
+# Columns: routine, ELF symbol, runs, min/avg/max cycles, stack bytes,
+# flash bytes of the symbol, flash and static RAM of the whole program.
+# A routine without a BENCH line (crash, timeout) is reported as FAILED
+# and the exit status is 1.
+# ****************************************************************************
+
+SIMAVR=$1
+MCU=$2
+shift 2
+status=0
+
+echo "routine,symbol,runs,cycles_min,cycles_avg,cycles_max,stack,flash,program_flash,program_sram"
+for elf in "$@"; do
+	line=$(timeout 300 "$SIMAVR" -m "$MCU" -f 16000000 "$elf" 2>&1 \
+		| sed 's/\x1b\[[0-9;]*m//g' | grep -o 'BENCH .*' | head -n 1)
+	if [ -z "$line" ]; then
+		echo "$(basename "$elf" .elf),FAILED"
+		status=1
+		continue
+	fi
+	set -- $line
+	name=$2 symbol=$3 runs=$4 min=$5 avg=$6 max=$7 stack=$8
+	size=$(avr-nm -S "$elf" | awk -v s="$symbol" '$4 == s { print $2 }')
+	flash=$((0x${size:-0}))
+	set -- $(avr-size "$elf" | tail -n 1)
+	echo "$name,$symbol,$runs,$min,$avg,$max,$stack,$flash,$(($1 + $2)),$(($2 + $3))"
+done
+exit $status
@@ -0,0 +1,126 @@
+/* ****************************************************************************
+ * File: host/RobotArmKinematics.cpp
+ * Target: host PC (C++11)
+ * ****************************************************************************
+ * Description:
+ * Double precision reference kinematics, s. RobotArmKinematics.hpp.
+ * ****************************************************************************
+ */
+
+#include "host/RobotArmKinematics.hpp"
+
+#include <cmath>
+
+namespace robotarm {
+
+static const double BINARY_ANGLE = M_PI / 32768.0;	// radians per count
+static const double MM = 0.1;						// mm per length unit
+
+static int16_t toBinaryAngle(double angle)
+{
+	long a = std::lround(angle / BINARY_ANGLE);
+	return static_cast<int16_t>(static_cast<uint16_t>(a & 0xFFFF));
+}
+
+Pose fromFixed(const kin_pose_t &pose)
+{
+	return Pose(pose.x * MM, pose.y * MM, pose.z * MM,
+	            pose.pitch * BINARY_ANGLE, pose.roll * BINARY_ANGLE, pose.grip);
+}
+
+kin_pose_t toFixed(const Pose &pose)
+{
+	kin_pose_t fixed;
+	fixed.x = static_cast<int16_t>(std::lround(pose.x / MM));
+	fixed.y = static_cast<int16_t>(std::lround(pose.y / MM));
+	fixed.z = static_cast<int16_t>(std::lround(pose.z / MM));
+	fixed.pitch = toBinaryAngle(pose.pitch);
+	fixed.roll = toBinaryAngle(pose.roll);
+	fixed.grip = pose.grip;
+	return fixed;
+}
+
+Kinematics::Kinematics()
+{
+	for(int i = 0; i < PROTOCOL_JOINTS; i++) {
+		zero_[i] = 0;
+		quarter_[i] = KIN_DEFAULT_QUARTER;
+	}
+}
+
+void Kinematics::setCalibration(int servo, int16_t zero, int16_t quarter)
+{
+	if(servo < 2 || servo > 6 || (quarter > -128 && quarter < 128))
+		return;
+	zero_[servo - 1] = zero;
+	quarter_[servo - 1] = quarter;
+}
+
+double Kinematics::offsetToAngle(int servo, double offset) const
+{
+	if(servo < 2 || servo > 6)
+		return offset;
+	return (offset - zero_[servo - 1]) * (M_PI / 2) / quarter_[servo - 1];
+}
+
+double Kinematics::angleToOffset(int servo, double angle) const
+{
+	if(servo < 2 || servo > 6)
+		return angle;
+	return zero_[servo - 1] + angle * quarter_[servo - 1] / (M_PI / 2);
+}
+
+Pose Kinematics::forward(const Joints &offsets) const
+{
+	double base = offsetToAngle(6, offsets[5]);
+	double a1 = offsetToAngle(5, offsets[4]);
+	double a12 = a1 + offsetToAngle(4, offsets[3]);
+	double a123 = a12 + offsetToAngle(3, offsets[2]);
+	double r = (KIN_UPPER_ARM * std::cos(a1) + KIN_FOREARM * std::cos(a12)
+	            + KIN_TOOL * std::cos(a123)) * MM;
+	double z = (KIN_BASE_HEIGHT + KIN_UPPER_ARM * std::sin(a1)
+	            + KIN_FOREARM * std::sin(a12) + KIN_TOOL * std::sin(a123)) * MM;
+	return Pose(r * std::cos(base), r * std::sin(base), z,
+	            std::remainder(a123, 2 * M_PI), offsetToAngle(2, offsets[1]), offsets[0]);
+}
+
+int Kinematics::inverse(const Pose &pose, std::array<double, PROTOCOL_JOINTS> &offsets) const
+{
+	const double l1 = KIN_UPPER_ARM * MM, l2 = KIN_FOREARM * MM;
+	double r = std::hypot(pose.x, pose.y);
+	double rw = r - KIN_TOOL * MM * std::cos(pose.pitch);
+	double zw = pose.z - KIN_BASE_HEIGHT * MM - KIN_TOOL * MM * std::sin(pose.pitch);
+	double c = (rw * rw + zw * zw - l1 * l1 - l2 * l2) / (2 * l1 * l2);
+	if(c > 1 || c < -1)
+		return KIN_UNREACHABLE;
+
+	double elbow = -std::acos(c);		// elbow up
+	double shoulder = std::atan2(zw, rw) - std::atan2(l2 * std::sin(elbow), l1 + l2 * std::cos(elbow));
+	double angles[PROTOCOL_JOINTS] = {
+		0, pose.roll, std::remainder(pose.pitch - shoulder - elbow, 2 * M_PI),
+		elbow, std::remainder(shoulder, 2 * M_PI), std::atan2(pose.y, pose.x)
+	};
+	offsets[0] = pose.grip;
+	for(int servo = 2; servo <= 6; servo++)
+		offsets[servo - 1] = angleToOffset(servo, angles[servo - 1]);
+	return KIN_OK;
+}
+
+int Kinematics::inverse(const Pose &pose, Joints &offsets) const
+{
+	std::array<double, PROTOCOL_JOINTS> exact;
+	int result = inverse(pose, exact);
+	if(result != KIN_OK)
+		return result;
+	Joints rounded;
+	for(int i = 0; i < PROTOCOL_JOINTS; i++) {
+		long offset = std::lround(exact[i]);
+		if(i && (offset < KIN_OFFSET_MIN || offset > KIN_OFFSET_MAX))
+			return KIN_JOINT_LIMIT;
+		rounded[i] = static_cast<int16_t>(offset);
+	}
+	offsets = rounded;
+	return KIN_OK;
+}
+
+}
@@ -0,0 +1,80 @@
+/* ****************************************************************************
+ * File: host/RobotArmKinematics.hpp
+ * Target: host PC (C++11)
+ * ****************************************************************************
+ * Description:
+ * Double precision reference implementation of the kinematics of the
+ * firmware (RobotArmBase/RobotArmKinematics.c). Geometry, limits and
+ * units are taken from RobotArmBase/RobotArmKinematicsDefs.h, so both
+ * calculate the same arm. Use it on the host to plan paths in
+ * millimeters or to check the accuracy of the fixed point version.
+ *
+ * Example:
+ *
+ *		robotarm::Kinematics kinematics;
+ *		kinematics.setCalibration(5, -380, 1000);
+ *		robotarm::Joints offsets;
+ *		robotarm::Pose pose(150, -40, 60, -30 * M_PI / 180, 0);
+ *		if(kinematics.inverse(pose, offsets) == KIN_OK)
+ *			serial.write(encoder.moveSync(offsets));
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARM_HOST_KINEMATICS_HPP
+#define ROBOTARM_HOST_KINEMATICS_HPP
+
+#include <array>
+#include <cstdint>
+
+#include "RobotArmBase/RobotArmKinematicsDefs.h"
+#include "host/RobotArmProtocol.hpp"
+
+namespace robotarm {
+
+/**
+ * Gripper pose in millimeters and radians.
+ */
+struct Pose {
+	double x;
+	double y;
+	double z;
+	double pitch;
+	double roll;
+	int16_t grip;		// servo 1 offset
+
+	Pose() : x(0), y(0), z(0), pitch(0), roll(0), grip(0) {}
+	Pose(double x_, double y_, double z_, double pitch_, double roll_, int16_t grip_ = 0)
+		: x(x_), y(y_), z(z_), pitch(pitch_), roll(roll_), grip(grip_) {}
+};
+
+/**
+ * Conversion between Pose and the fixed point kin_pose_t of the firmware.
+ */
+Pose fromFixed(const kin_pose_t &pose);
+kin_pose_t toFixed(const Pose &pose);
+
+class Kinematics {
+public:
+	Kinematics();
+
+	// Same as setJointCalibration() of the firmware (servo 2..6).
+	void setCalibration(int servo, int16_t zero, int16_t quarter);
+
+	double offsetToAngle(int servo, double offset) const;
+	double angleToOffset(int servo, double angle) const;
+
+	Pose forward(const Joints &offsets) const;
+
+	// Unrounded offsets, KIN_OK or KIN_UNREACHABLE (no joint limits).
+	int inverse(const Pose &pose, std::array<double, PROTOCOL_JOINTS> &offsets) const;
+	// Rounded offsets with the joint limit check of the firmware.
+	int inverse(const Pose &pose, Joints &offsets) const;
+
+private:
+	int16_t zero_[PROTOCOL_JOINTS];
+	int16_t quarter_[PROTOCOL_JOINTS];
+};
+
+}
+
+#endif
@@ -0,0 +1,355 @@
+/* ****************************************************************************
+ * File: host/RobotArmProtocol.cpp
+ * Target: host PC (C++11)
+ * ****************************************************************************
+ * Description:
+ * Host side encoder/decoder for the binary command protocol,
+ * s. RobotArmProtocol.hpp.
+ * ****************************************************************************
+ */
+
+#include "host/RobotArmProtocol.hpp"
+
+#include <algorithm>
+
+namespace robotarm {
+
+std::vector<uint8_t> encodeFrame(const Frame &frame)
+{
+	std::vector<uint8_t> raw;
+	raw.push_back(frame.type);
+	raw.push_back(frame.seq);
+	raw.insert(raw.end(), frame.payload.begin(), frame.payload.end());
+	uint16_t crc = 0xFFFF;
+	for(size_t i = 0; i < raw.size(); i++)
+		crc = protocolCRC16(crc, raw[i]);
+	raw.push_back(crc & 0xFF);
+	raw.push_back(crc >> 8);
+
+	// COBS:
+	std::vector<uint8_t> out;
+	size_t codePos = out.size();
+	out.push_back(0);
+	uint8_t code = 1;
+	for(size_t i = 0; i < raw.size(); i++) {
+		if(raw[i] == 0) {
+			out[codePos] = code;
+			codePos = out.size();
+			out.push_back(0);
+			code = 1;
+			continue;
+		}
+		out.push_back(raw[i]);
+		if(++code == 0xFF) {
+			out[codePos] = code;
+			codePos = out.size();
+			out.push_back(0);
+			code = 1;
+		}
+	}
+	out[codePos] = code;
+	out.push_back(PROTOCOL_DELIMITER);
+	return out;
+}
+
+bool decodeFrame(const uint8_t *data, size_t length, Frame &frame)
+{
+	std::vector<uint8_t> raw;
+	size_t in = 0;
+	while(in < length) {
+		uint8_t code = data[in++];
+		if(code == 0 || code - 1u > length - in)
+			return false;
+		for(uint8_t n = 1; n < code; n++)
+			raw.push_back(data[in++]);
+		if(code != 0xFF && in < length)
+			raw.push_back(0);
+	}
+	if(raw.size() < PROTOCOL_HEADER_SIZE + PROTOCOL_CRC_SIZE
+	   || raw.size() > PROTOCOL_MAX_FRAME)
+		return false;
+
+	size_t end = raw.size() - PROTOCOL_CRC_SIZE;
+	uint16_t crc = 0xFFFF;
+	for(size_t i = 0; i < end; i++)
+		crc = protocolCRC16(crc, raw[i]);
+	if(raw[end] != (crc & 0xFF) || raw[end + 1] != (crc >> 8))
+		return false;
+
+	frame.type = raw[0];
+	frame.seq = raw[1];
+	frame.payload.assign(raw.begin() + PROTOCOL_HEADER_SIZE, raw.begin() + end);
+	return true;
+}
+
+bool parseState(const Frame &frame, State &state)
+{
+	if(frame.type != MSG_STATE || frame.payload.size() != STATE_SIZE)
+		return false;
+	const uint8_t *p = frame.payload.data();
+	for(int i = 0; i < PROTOCOL_JOINTS; i++, p += 2)
+		state.offsets[i] = static_cast<int16_t>(p[0] | (p[1] << 8));
+	for(int i = 0; i < PROTOCOL_JOINTS; i++, p += 2)
+		state.currents[i] = static_cast<uint16_t>(p[0] | (p[1] << 8));
+	state.flags = *p++;
+	state.queueFree = *p;
+	return true;
+}
+
+static uint16_t getWord(const uint8_t *p)
+{
+	return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+bool parseUartStats(const Frame &frame, UartStats &stats)
+{
+	if(frame.type != MSG_UART_STATS || frame.payload.size() != UART_STATS_SIZE)
+		return false;
+	const uint8_t *p = frame.payload.data();
+	stats.transmitted = getWord(p) | (static_cast<uint32_t>(getWord(p + 2)) << 16);
+	stats.received = getWord(p + 4) | (static_cast<uint32_t>(getWord(p + 6)) << 16);
+	stats.overflows = getWord(p + 8);
+	stats.overruns = getWord(p + 10);
+	stats.frameErrors = getWord(p + 12);
+	stats.dropped = getWord(p + 14);
+	stats.baud = p[16];
+	return true;
+}
+
+bool parseFault(const Frame &frame, Fault &fault)
+{
+	if(frame.type != MSG_FAULT || frame.payload.size() != FAULT_SIZE)
+		return false;
+	const uint8_t *p = frame.payload.data();
+	fault.active = p[0];
+	fault.joint = p[1];
+	fault.current = getWord(p + 2);
+	fault.limit = getWord(p + 4);
+	fault.adcSeq = getWord(p + 6);
+	fault.trips = getWord(p + 8);
+	return true;
+}
+
+bool parseIsrStats(const Frame &frame, IsrStats &stats)
+{
+	if(frame.type != MSG_ISR_STATS || frame.payload.size() != ISR_STATS_SIZE)
+		return false;
+	const uint8_t *p = frame.payload.data();
+	stats.isr = p[0];
+	stats.calls = getWord(p + 1) | (static_cast<uint32_t>(getWord(p + 3)) << 16);
+	stats.min = getWord(p + 5);
+	stats.avg = getWord(p + 7);
+	stats.max = getWord(p + 9);
+	stats.latencyAvg = p[11];
+	stats.latencyMax = p[12];
+	return true;
+}
+
+bool parseMemory(const Frame &frame, Memory &memory)
+{
+	if(frame.type != MSG_MEMORY || frame.payload.size() != MEMORY_SIZE)
+		return false;
+	const uint8_t *p = frame.payload.data();
+	memory.staticRam = getWord(p);
+	memory.heap = getWord(p + 2);
+	memory.stackMax = getWord(p + 4);
+	memory.neverUsed = getWord(p + 6);
+	memory.freeNow = getWord(p + 8);
+	memory.stackFault = p[10];
+	return true;
+}
+
+bool parsePose(const Frame &frame, StoredPose &pose)
+{
+	if(frame.type != MSG_POSE || frame.payload.size() != POSE_SIZE)
+		return false;
+	const uint8_t *p = frame.payload.data();
+	pose.number = p[0];
+	const char *name = reinterpret_cast<const char *>(p + 1);
+	pose.name.assign(name, std::find(name, name + PROTOCOL_NAME_LENGTH, '\0'));
+	p += 1 + PROTOCOL_NAME_LENGTH;
+	for(int i = 0; i < PROTOCOL_JOINTS; i++, p += 2)
+		pose.pulses[i] = getWord(p);
+	return true;
+}
+
+/*****************************************************************************/
+// Encoder:
+
+std::vector<uint8_t> Encoder::next(uint8_t type, const std::vector<uint8_t> &payload)
+{
+	Frame frame;
+	frame.type = type;
+	frame.seq = seq_++;
+	frame.payload = payload;
+	return encodeFrame(frame);
+}
+
+std::vector<uint8_t> Encoder::setAll(const Joints &offsets)
+{
+	std::vector<uint8_t> payload(PROTOCOL_PACKED_JOINTS);
+	packJoints(offsets.data(), payload.data());
+	return next(MSG_SET_ALL, payload);
+}
+
+std::vector<uint8_t> Encoder::moveSync(const Joints &offsets, uint16_t speed)
+{
+	std::vector<uint8_t> payload(MOVE_SYNC_SIZE);
+	packJoints(offsets.data(), payload.data());
+	payload[PROTOCOL_PACKED_JOINTS] = speed & 0xFF;
+	payload[PROTOCOL_PACKED_JOINTS + 1] = speed >> 8;
+	return next(MSG_MOVE_SYNC, payload);
+}
+
+std::vector<uint8_t> Encoder::queueMove(const Joints &offsets, uint16_t speed)
+{
+	std::vector<uint8_t> payload(MOVE_SYNC_SIZE);
+	packJoints(offsets.data(), payload.data());
+	payload[PROTOCOL_PACKED_JOINTS] = speed & 0xFF;
+	payload[PROTOCOL_PACKED_JOINTS + 1] = speed >> 8;
+	return next(MSG_QUEUE_MOVE, payload);
+}
+
+std::vector<uint8_t> Encoder::moveRelative(uint8_t mask, const Joints &deltas)
+{
+	std::vector<uint8_t> payload;
+	mask &= (1 << PROTOCOL_JOINTS) - 1;
+	payload.push_back(mask);
+	for(int i = 0; i < PROTOCOL_JOINTS; i++) {
+		if(mask & (1 << i)) {
+			payload.push_back(deltas[i] & 0xFF);
+			payload.push_back((deltas[i] >> 8) & 0xFF);
+		}
+	}
+	return next(MSG_MOVE_REL, payload);
+}
+
+std::vector<uint8_t> Encoder::queryState()
+{
+	return next(MSG_QUERY_STATE, std::vector<uint8_t>());
+}
+
+std::vector<uint8_t> Encoder::stop(bool powerOff)
+{
+	return next(MSG_STOP, std::vector<uint8_t>(1, powerOff ? STOP_POWER_OFF : STOP_HOLD));
+}
+
+std::vector<uint8_t> Encoder::setBaud(uint8_t baudCode)
+{
+	return next(MSG_SET_BAUD, std::vector<uint8_t>(1, baudCode));
+}
+
+std::vector<uint8_t> Encoder::baudConfirm()
+{
+	// Leading delimiter: ends any garbage received during the switch.
+	std::vector<uint8_t> bytes(1, PROTOCOL_DELIMITER);
+	std::vector<uint8_t> frame = next(MSG_BAUD_CONFIRM, std::vector<uint8_t>());
+	bytes.insert(bytes.end(), frame.begin(), frame.end());
+	return bytes;
+}
+
+std::vector<uint8_t> Encoder::queryUartStats()
+{
+	return next(MSG_QUERY_UART_STATS, std::vector<uint8_t>());
+}
+
+std::vector<uint8_t> Encoder::queryFault()
+{
+	return next(MSG_QUERY_FAULT, std::vector<uint8_t>());
+}
+
+std::vector<uint8_t> Encoder::clearFault()
+{
+	return next(MSG_CLEAR_FAULT, std::vector<uint8_t>());
+}
+
+std::vector<uint8_t> Encoder::queryIsrStats(uint8_t isr, bool reset)
+{
+	std::vector<uint8_t> payload;
+	payload.push_back(isr);
+	payload.push_back(reset ? ISR_STATS_RESET : 0);
+	return next(MSG_QUERY_ISR_STATS, payload);
+}
+
+std::vector<uint8_t> Encoder::queryMemory()
+{
+	return next(MSG_QUERY_MEMORY, std::vector<uint8_t>());
+}
+
+static void putName(std::vector<uint8_t> &payload, const std::string &name)
+{
+	for(size_t i = 0; i < PROTOCOL_NAME_LENGTH; i++)
+		payload.push_back(i < name.size() ? name[i] : 0);
+}
+
+std::vector<uint8_t> Encoder::teachPose(uint8_t pose, const std::string &name)
+{
+	std::vector<uint8_t> payload(1, pose);
+	for(size_t i = 0; i < name.size() && i < PROTOCOL_NAME_LENGTH; i++)
+		payload.push_back(name[i]);
+	return next(MSG_TEACH_POSE, payload);
+}
+
+std::vector<uint8_t> Encoder::setPose(const StoredPose &pose)
+{
+	std::vector<uint8_t> payload(1, pose.number);
+	putName(payload, pose.name);
+	for(int i = 0; i < PROTOCOL_JOINTS; i++) {
+		payload.push_back(pose.pulses[i] & 0xFF);
+		payload.push_back(pose.pulses[i] >> 8);
+	}
+	return next(MSG_SET_POSE, payload);
+}
+
+std::vector<uint8_t> Encoder::queryPose(uint8_t pose)
+{
+	return next(MSG_QUERY_POSE, std::vector<uint8_t>(1, pose));
+}
+
+std::vector<uint8_t> Encoder::setSequence(uint8_t sequence, const std::string &name,
+                                          const std::vector<SequenceStep> &steps)
+{
+	std::vector<uint8_t> payload(1, sequence);
+	putName(payload, name);
+	payload.push_back(static_cast<uint8_t>(steps.size()));
+	for(size_t i = 0; i < steps.size(); i++) {
+		payload.push_back(steps[i].pose);
+		payload.push_back(steps[i].speed);
+		payload.push_back(steps[i].dwell);
+	}
+	return next(MSG_SET_SEQUENCE, payload);
+}
+
+std::vector<uint8_t> Encoder::playSequence(uint8_t sequence, uint8_t repeat, uint16_t speed)
+{
+	std::vector<uint8_t> payload;
+	payload.push_back(sequence);
+	payload.push_back(repeat);
+	payload.push_back(speed & 0xFF);
+	payload.push_back(speed >> 8);
+	return next(MSG_PLAY_SEQUENCE, payload);
+}
+
+/*****************************************************************************/
+// FrameDecoder:
+
+bool FrameDecoder::feed(uint8_t byte)
+{
+	if(byte != PROTOCOL_DELIMITER) {
+		if(buffer_.size() < PROTOCOL_MAX_ENCODED)
+			buffer_.push_back(byte);
+		else
+			overlong_ = true;
+		return false;
+	}
+	if(buffer_.empty())
+		return false;
+	bool ok = !overlong_ && decodeFrame(buffer_.data(), buffer_.size(), frame_);
+	buffer_.clear();
+	overlong_ = false;
+	if(!ok)
+		badFrames_++;
+	return ok;
+}
+
+} // namespace robotarm
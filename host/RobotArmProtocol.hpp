@@ -0,0 +1,217 @@
+/* ****************************************************************************
+ * File: host/RobotArmProtocol.hpp
+ * Target: host PC (C++11)
+ * ****************************************************************************
+ * Description:
+ * Host side encoder/decoder for the binary command protocol of the
+ * Robotarm base controller. The message types, sizes, CRC and joint
+ * packing are taken from RobotArmBase/RobotArmProtocolDefs.h, which is
+ * also used by the firmware.
+ *
+ * Example:
+ *
+ *		robotarm::Encoder encoder;
+ *		std::vector<uint8_t> bytes = encoder.setAll({{0, 100, -50, 0, 0, 0}});
+ *		serial.write(bytes.data(), bytes.size());
+ *
+ *		robotarm::FrameDecoder decoder;
+ *		while(serial.read(&c, 1))
+ *			if(decoder.feed(c) && decoder.frame().type == MSG_ACK)
+ *				...
+ * ****************************************************************************
+ */
+
+#ifndef ROBOTARM_HOST_PROTOCOL_HPP
+#define ROBOTARM_HOST_PROTOCOL_HPP
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "RobotArmBase/RobotArmProtocolDefs.h"
+
+namespace robotarm {
+
+typedef std::array<int16_t, PROTOCOL_JOINTS> Joints;
+
+struct Frame {
+	uint8_t type;
+	uint8_t seq;
+	std::vector<uint8_t> payload;
+
+	Frame() : type(0), seq(0) {}
+};
+
+struct State {
+	Joints offsets;
+	std::array<uint16_t, PROTOCOL_JOINTS> currents;
+	uint8_t flags;
+	uint8_t queueFree;	// free waypoint queue entries
+};
+
+struct UartStats {
+	uint32_t transmitted;
+	uint32_t received;
+	uint16_t overflows;
+	uint16_t overruns;
+	uint16_t frameErrors;
+	uint16_t dropped;
+	uint8_t baud;
+};
+
+struct Fault {
+	uint8_t active;
+	uint8_t joint;
+	uint16_t current;
+	uint16_t limit;
+	uint16_t adcSeq;
+	uint16_t trips;
+};
+
+struct IsrStats {
+	uint8_t isr;			// ISR_STAT_xxx
+	uint32_t calls;
+	uint16_t min;			// run times in 0.5us (8 CPU cycles)
+	uint16_t avg;
+	uint16_t max;
+	uint8_t latencyAvg;		// only for ISR_STAT_TIMER2
+	uint8_t latencyMax;
+};
+
+struct Memory {
+	uint16_t staticRam;		// all in bytes
+	uint16_t heap;
+	uint16_t stackMax;
+	uint16_t neverUsed;
+	uint16_t freeNow;
+	uint8_t stackFault;
+};
+
+struct StoredPose {
+	uint8_t number;
+	std::string name;		// up to PROTOCOL_NAME_LENGTH characters
+	std::array<uint16_t, PROTOCOL_JOINTS> pulses;	// servo pulse in us
+};
+
+struct SequenceStep {
+	uint8_t pose;
+	uint8_t speed;			// ms per count, 0 = profile speed
+	uint8_t dwell;			// 10 ms
+};
+
+/**
+ * Adds CRC, COBS encodes the frame and appends the 0x00 delimiter.
+ */
+std::vector<uint8_t> encodeFrame(const Frame &frame);
+
+/**
+ * Decodes one COBS encoded frame (without the delimiter) and checks the
+ * CRC. Returns false if the data is not a valid frame.
+ */
+bool decodeFrame(const uint8_t *data, size_t length, Frame &frame);
+
+/**
+ * Reads the payload of a MSG_STATE frame.
+ */
+bool parseState(const Frame &frame, State &state);
+
+/**
+ * Reads the payload of a MSG_UART_STATS frame.
+ */
+bool parseUartStats(const Frame &frame, UartStats &stats);
+
+/**
+ * Reads the payload of a MSG_FAULT frame.
+ */
+bool parseFault(const Frame &frame, Fault &fault);
+
+/**
+ * Reads the payload of a MSG_ISR_STATS frame.
+ */
+bool parseIsrStats(const Frame &frame, IsrStats &stats);
+
+/**
+ * Reads the payload of a MSG_MEMORY frame.
+ */
+bool parseMemory(const Frame &frame, Memory &memory);
+
+/**
+ * Reads the payload of a MSG_POSE frame.
+ */
+bool parsePose(const Frame &frame, StoredPose &pose);
+
+/**
+ * Creates the host -> arm messages with increasing sequence numbers.
+ */
+class Encoder {
+public:
+	Encoder() : seq_(0) {}
+
+	std::vector<uint8_t> setAll(const Joints &offsets);
+	std::vector<uint8_t> moveRelative(uint8_t mask, const Joints &deltas);
+	// All joints arrive at the same time, speed in ms per count of the
+	// longest move (0 = use the velocity profiles of the arm).
+	std::vector<uint8_t> moveSync(const Joints &offsets, uint16_t speed = 0);
+	// Same as moveSync, but appended to the waypoint queue of the arm. The
+	// ACK info byte is the number of free entries, NAK_BUSY if it is full.
+	std::vector<uint8_t> queueMove(const Joints &offsets, uint16_t speed = 0);
+	std::vector<uint8_t> queryState();
+	std::vector<uint8_t> stop(bool powerOff = false);
+
+	// Baudrate change: send setBaud(), wait for the ACK, switch the serial
+	// port and send baudConfirm() within BAUD_CONFIRM_TIMEOUT ms.
+	std::vector<uint8_t> setBaud(uint8_t baudCode);
+	std::vector<uint8_t> baudConfirm();
+	std::vector<uint8_t> queryUartStats();
+	std::vector<uint8_t> queryFault();
+	std::vector<uint8_t> clearFault();
+	// Only if the firmware is built with ISR_STATS.
+	std::vector<uint8_t> queryIsrStats(uint8_t isr, bool reset = false);
+	std::vector<uint8_t> queryMemory();
+
+	// Pose library of the arm: teachPose() saves the current servo
+	// positions, setPose()/queryPose() restore/back up a pose. All pose
+	// messages get NAK_BUSY while the arm writes its EEPROM - resend them.
+	std::vector<uint8_t> teachPose(uint8_t pose, const std::string &name);
+	std::vector<uint8_t> setPose(const StoredPose &pose);
+	std::vector<uint8_t> queryPose(uint8_t pose);
+	std::vector<uint8_t> setSequence(uint8_t sequence, const std::string &name,
+	                                 const std::vector<SequenceStep> &steps);
+	// repeat = 0 plays until stop(), speed != 0 overrides the step speeds.
+	std::vector<uint8_t> playSequence(uint8_t sequence, uint8_t repeat = 1, uint16_t speed = 0);
+
+	// Sequence number of the last created message.
+	uint8_t lastSeq() const { return static_cast<uint8_t>(seq_ - 1); }
+
+protected:
+	std::vector<uint8_t> next(uint8_t type, const std::vector<uint8_t> &payload);
+
+private:
+	uint8_t seq_;
+};
+
+/**
+ * Collects received bytes and returns complete, valid frames.
+ */
+class FrameDecoder {
+public:
+	FrameDecoder() : overlong_(false), badFrames_(0) {}
+
+	// Returns true if byte completed a valid frame, s. frame().
+	bool feed(uint8_t byte);
+
+	const Frame &frame() const { return frame_; }
+	unsigned long badFrames() const { return badFrames_; }
+
+private:
+	std::vector<uint8_t> buffer_;
+	Frame frame_;
+	bool overlong_;
+	unsigned long badFrames_;
+};
+
+} // namespace robotarm
+
+#endif
@@ -0,0 +1,655 @@
+/* ****************************************************************************
+ * File: host/avrsim/AvrSim.c
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Register file, virtual clock and peripherals of the simulated ATmega64.
+ * s. AvrSim.h
+ * ****************************************************************************
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <avr/interrupt.h>
+#include <avr/eeprom.h>
+#include "AvrSim.h"
+
+/*****************************************************************************/
+// Variables:
+
+static volatile uint8_t io8[SIM_IO8_COUNT];
+static volatile uint16_t io16[SIM_IO16_COUNT];
+
+uint8_t sim_sram[RAMEND + 1];
+uint8_t sim_eeprom[E2END + 1];
+uint8_t sim_uart_echo;
+
+static uint64_t cycles;
+static uint32_t irq_count[SIM_IRQ_COUNT];
+static uint8_t in_rx_isr;
+
+// Timer 2:
+static uint64_t t2_base;		// cycle of the last counter reset
+static uint32_t t2_period;		// cycles per counter cycle, 0 = stopped
+static uint16_t t2_prescaler;
+
+// ADC:
+static uint16_t adc_input[8];
+static uint64_t adc_done;		// end of the conversion, 0 = idle
+
+// EEPROM:
+#define EE_WRITE_CYCLES ((uint32_t)(F_CPU / 1000 * 17 / 2))	// 8.5ms
+static uint64_t ee_done;		// end of the write, 0 = idle
+
+// USART1:
+#define UART_RX_QUEUE 4096
+#define UART_TX_QUEUE 65536
+static uint8_t u1_flags;		// RXC1, TXC1, UDRE1, FE1, DOR1 (hardware owned)
+static uint8_t u1_rx_data;
+static uint8_t u1_tx_pending;	// UDR1 was accessed for a write
+static uint8_t u1_rx_read;		// UDR1 was accessed for a read
+static int16_t u1_tx_next = -1;	// byte waiting in UDR1
+static uint64_t u1_tx_done;		// end of the frame in the shift register
+static uint64_t u1_rx_time;		// arrival of the next received byte
+static uint8_t u1_rx_queue[UART_RX_QUEUE];
+static uint16_t u1_rx_head, u1_rx_tail;
+static uint8_t u1_tx_queue[UART_TX_QUEUE];
+static uint32_t u1_tx_head, u1_tx_tail;
+
+// Interrupt routines - weak, the program does not need to have them all:
+extern void TIMER2_COMP_vect(void) __attribute__((weak));
+extern void ADC_vect(void) __attribute__((weak));
+extern void EE_READY_vect(void) __attribute__((weak));
+extern void USART1_RX_vect(void) __attribute__((weak));
+extern void USART1_UDRE_vect(void) __attribute__((weak));
+extern void USART1_TX_vect(void) __attribute__((weak));
+
+#define NEVER UINT64_MAX
+
+/*****************************************************************************/
+// Reset:
+
+/**
+ * Sets all registers to their reset values and the clock to 0. The
+ * EEPROM and the SRAM keep their contents. Called automatically before
+ * main().
+ */
+void simReset(void)
+{
+	memset((void *)io8, 0, sizeof(io8));
+	memset((void *)io16, 0, sizeof(io16));
+	io16[SIM_SP] = RAMEND;
+	io8[SIM_UCSR0A] = (1 << UDRE1);
+	cycles = 0;
+	memset(irq_count, 0, sizeof(irq_count));
+	in_rx_isr = 0;
+	t2_period = 0;
+	adc_done = 0;
+	ee_done = 0;
+	u1_flags = (1 << UDRE1);
+	u1_tx_pending = u1_rx_read = 0;
+	u1_tx_next = -1;
+	u1_tx_done = 0;
+	u1_rx_head = u1_rx_tail = 0;
+	u1_tx_head = u1_tx_tail = 0;
+}
+
+static void simInit(void) __attribute__((constructor));
+static void simInit(void)
+{
+	memset(sim_eeprom, 0xFF, sizeof(sim_eeprom));	// erased EEPROM
+	simReset();
+}
+
+/*****************************************************************************/
+// Timer 2:
+
+static void updateTimer2(void)
+{
+	static const uint16_t prescaler[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+	uint8_t tccr = io8[SIM_TCCR2];
+	uint16_t p = prescaler[tccr & 7];
+	uint16_t top = (tccr & (1 << WGM21)) ? io8[SIM_OCR2] : 0xFF;
+	uint32_t period = (uint32_t)(top + 1) * p;
+
+	if(period != t2_period || p != t2_prescaler) {
+		// (Re)started or changed - the counter continues from its value:
+		uint32_t count = 0;
+		if(t2_period)
+			count = (cycles - t2_base) / t2_prescaler;
+		if(count > top)
+			count = 0;
+		t2_period = period;
+		t2_prescaler = p;
+		t2_base = cycles - (uint64_t)count * p;
+	}
+	if(!t2_period)
+		return;
+	while(cycles - t2_base >= t2_period) {
+		t2_base += t2_period;
+		io8[SIM_TIFR] |= (tccr & (1 << WGM21)) ? (1 << OCF2) : (1 << TOV2);
+	}
+}
+
+static uint8_t timer2Count(void)
+{
+	if(!t2_period)
+		return io8[SIM_TCNT2];
+	return (cycles - t2_base) / t2_prescaler;
+}
+
+/*****************************************************************************/
+// ADC:
+
+static void updateADC(void)
+{
+	uint8_t adcsra = io8[SIM_ADCSRA];
+
+	if(!(adcsra & (1 << ADEN)) || !(adcsra & (1 << ADSC))) {
+		adc_done = 0;
+		return;
+	}
+	if(!adc_done) {
+		uint8_t ps = adcsra & 7;
+		adc_done = cycles + 13UL * (ps ? (1 << ps) : 2);
+	}
+	if(cycles >= adc_done) {
+		io16[SIM_ADC] = adc_input[io8[SIM_ADMUX] & 7] & 0x3FF;
+		io8[SIM_ADCSRA] = (adcsra & ~(1 << ADSC)) | (1 << ADIF);
+		adc_done = 0;
+	}
+}
+
+/**
+ * Sets the voltage of an ADC input as 10 bit value (0..1023).
+ */
+void simSetADC(uint8_t channel, uint16_t value)
+{
+	adc_input[channel & 7] = value;
+}
+
+/*****************************************************************************/
+// EEPROM:
+
+static void updateEEPROM(void)
+{
+	uint8_t eecr = io8[SIM_EECR];
+	uint16_t addr = io16[SIM_EEAR] & E2END;
+
+	if(eecr & (1 << EERE)) {
+		io8[SIM_EEDR] = sim_eeprom[addr];
+		eecr &= ~(1 << EERE);
+		cycles += 4;
+	}
+	if((eecr & (1 << EEWE)) && !ee_done) {
+		if(eecr & (1 << EEMWE)) {
+			sim_eeprom[addr] = io8[SIM_EEDR];
+			ee_done = cycles + EE_WRITE_CYCLES;
+		}
+		else
+			eecr &= ~(1 << EEWE);	// EEWE without EEMWE is ignored
+		eecr &= ~(1 << EEMWE);
+	}
+	if(ee_done && cycles >= ee_done) {
+		eecr &= ~(1 << EEWE);
+		ee_done = 0;
+	}
+	io8[SIM_EECR] = eecr;
+}
+
+/*****************************************************************************/
+// USART1:
+
+static uint32_t uartFrameCycles(void)
+{
+	uint16_t ubrr = ((io8[SIM_UBRR1H] & 0x0F) << 8) | io8[SIM_UBRR1L];
+	return 10UL * (ubrr + 1) * ((io8[SIM_UCSR1A] & (1 << U2X1)) ? 8 : 16);
+}
+
+static void transmit(uint8_t data)
+{
+	if(u1_tx_head - u1_tx_tail < UART_TX_QUEUE)
+		u1_tx_queue[u1_tx_head++ % UART_TX_QUEUE] = data;
+	if(sim_uart_echo) {
+		putchar(data);
+		fflush(stdout);
+	}
+	u1_tx_done = cycles + uartFrameCycles();
+}
+
+/**
+ * Takes the byte written to UDR1 after the access.
+ */
+static void latchUDR1(void)
+{
+	uint8_t data = io8[SIM_UDR1];
+
+	if(u1_rx_read) {
+		u1_rx_read = 0;
+		if(!u1_tx_pending || data == u1_rx_data)
+			return;
+	}
+	if(!u1_tx_pending)
+		return;
+	u1_tx_pending = 0;
+	if(!(io8[SIM_UCSR1B] & (1 << TXEN1)))
+		return;
+	u1_flags &= ~(1 << TXC1);
+	if(!u1_tx_done)
+		transmit(data);
+	else {
+		u1_tx_next = data;
+		u1_flags &= ~(1 << UDRE1);
+	}
+}
+
+static void updateUART(void)
+{
+	latchUDR1();
+	if(u1_tx_done && cycles >= u1_tx_done) {
+		if(u1_tx_next >= 0) {
+			transmit(u1_tx_next);
+			u1_tx_next = -1;
+			u1_flags |= (1 << UDRE1);
+		}
+		else {
+			u1_tx_done = 0;
+			u1_flags |= (1 << TXC1);
+		}
+	}
+	while(u1_rx_head != u1_rx_tail && cycles >= u1_rx_time) {
+		uint8_t data = u1_rx_queue[u1_rx_tail++ % UART_RX_QUEUE];
+		if(io8[SIM_UCSR1B] & (1 << RXEN1)) {
+			if(u1_flags & (1 << RXC1))
+				u1_flags |= (1 << DOR1);	// not read in time - lost
+			else {
+				u1_rx_data = data;
+				u1_flags |= (1 << RXC1);
+			}
+		}
+		u1_rx_time += uartFrameCycles();
+	}
+	io8[SIM_UCSR1A] = (io8[SIM_UCSR1A] & ((1 << U2X1) | (1 << MPCM1))) | u1_flags;
+}
+
+/**
+ * The bytes arrive one after the other with the timing of the current
+ * baudrate.
+ */
+void simUartReceive(const uint8_t *data, uint16_t length)
+{
+	if(u1_rx_head == u1_rx_tail)
+		u1_rx_time = cycles + uartFrameCycles();
+	while(length-- && (uint16_t)(u1_rx_head - u1_rx_tail) < UART_RX_QUEUE)
+		u1_rx_queue[u1_rx_head++ % UART_RX_QUEUE] = *data++;
+}
+
+/**
+ * Bytes given to simUartReceive() that have not arrived yet.
+ */
+uint16_t simUartReceivePending(void)
+{
+	return u1_rx_head - u1_rx_tail;
+}
+
+/**
+ * Copies and removes up to size transmitted bytes, returns the number.
+ */
+uint16_t simUartTransmitted(uint8_t *buffer, uint16_t size)
+{
+	uint16_t n = 0;
+	while(n < size && u1_tx_tail != u1_tx_head)
+		buffer[n++] = u1_tx_queue[u1_tx_tail++ % UART_TX_QUEUE];
+	return n;
+}
+
+/*****************************************************************************/
+// Interrupts:
+
+static void callISR(uint8_t irq, void (*isr)(void))
+{
+	uint8_t sreg = io8[SIM_SREG];
+
+	io8[SIM_SREG] = sreg & ~(1 << SREG_I);
+	cycles += SIM_ISR_CYCLES / 2;
+	irq_count[irq]++;
+	in_rx_isr = (irq == SIM_IRQ_USART1_RX);
+	isr();
+	in_rx_isr = 0;
+	latchUDR1();
+	cycles += SIM_ISR_CYCLES / 2;
+	io8[SIM_SREG] |= (1 << SREG_I);		// reti
+}
+
+/**
+ * Returns the highest priority interrupt that is enabled and pending,
+ * 0xFF if there is none.
+ */
+static uint8_t pendingInterrupt(void)
+{
+	if(!(io8[SIM_SREG] & (1 << SREG_I)))
+		return 0xFF;
+	if((io8[SIM_TIFR] & (1 << OCF2)) && (io8[SIM_TIMSK] & (1 << OCIE2)) && TIMER2_COMP_vect)
+		return SIM_IRQ_TIMER2_COMP;
+	if((io8[SIM_ADCSRA] & (1 << ADIF)) && (io8[SIM_ADCSRA] & (1 << ADIE)) && ADC_vect)
+		return SIM_IRQ_ADC;
+	if((io8[SIM_EECR] & (1 << EERIE)) && !(io8[SIM_EECR] & (1 << EEWE)) && EE_READY_vect)
+		return SIM_IRQ_EE_READY;
+	if((u1_flags & (1 << RXC1)) && (io8[SIM_UCSR1B] & (1 << RXCIE1)) && USART1_RX_vect)
+		return SIM_IRQ_USART1_RX;
+	if((u1_flags & (1 << UDRE1)) && (io8[SIM_UCSR1B] & (1 << UDRIE1)) && USART1_UDRE_vect)
+		return SIM_IRQ_USART1_UDRE;
+	if((u1_flags & (1 << TXC1)) && (io8[SIM_UCSR1B] & (1 << TXCIE1)) && USART1_TX_vect)
+		return SIM_IRQ_USART1_TX;
+	return 0xFF;
+}
+
+/**
+ * Executes the highest priority pending interrupt. Only one - the
+ * program continues between two interrupts like on the chip.
+ */
+static void dispatch(void)
+{
+	switch(pendingInterrupt()) {
+		case SIM_IRQ_TIMER2_COMP:
+			io8[SIM_TIFR] &= ~(1 << OCF2);
+			callISR(SIM_IRQ_TIMER2_COMP, TIMER2_COMP_vect);
+			break;
+		case SIM_IRQ_ADC:
+			io8[SIM_ADCSRA] &= ~(1 << ADIF);
+			callISR(SIM_IRQ_ADC, ADC_vect);
+			break;
+		case SIM_IRQ_EE_READY:
+			callISR(SIM_IRQ_EE_READY, EE_READY_vect);
+			break;
+		case SIM_IRQ_USART1_RX:
+			callISR(SIM_IRQ_USART1_RX, USART1_RX_vect);
+			break;
+		case SIM_IRQ_USART1_UDRE:
+			callISR(SIM_IRQ_USART1_UDRE, USART1_UDRE_vect);
+			break;
+		case SIM_IRQ_USART1_TX:
+			u1_flags &= ~(1 << TXC1);
+			callISR(SIM_IRQ_USART1_TX, USART1_TX_vect);
+			break;
+	}
+}
+
+uint32_t simInterruptCount(uint8_t irq)
+{
+	return (irq < SIM_IRQ_COUNT) ? irq_count[irq] : 0;
+}
+
+/*****************************************************************************/
+// Virtual clock:
+
+static void update(void)
+{
+	updateTimer2();
+	updateADC();
+	updateEEPROM();
+	updateUART();
+}
+
+/**
+ * Advances the clock, updates the peripherals and executes one pending
+ * interrupt.
+ */
+static void step(uint32_t n)
+{
+	latchUDR1();
+	cycles += n;
+	update();
+	dispatch();
+}
+
+/**
+ * Cycle of the next peripheral event, NEVER if nothing is running.
+ */
+static uint64_t nextEvent(void)
+{
+	uint64_t next = NEVER;
+
+	if(pendingInterrupt() != 0xFF)
+		return cycles;
+	if(t2_period)
+		next = t2_base + t2_period;
+	if(adc_done && adc_done < next)
+		next = adc_done;
+	if(ee_done && ee_done < next)
+		next = ee_done;
+	if(u1_tx_done && u1_tx_done < next)
+		next = u1_tx_done;
+	if(u1_rx_head != u1_rx_tail && u1_rx_time < next)
+		next = u1_rx_time;
+	return next;
+}
+
+uint64_t simCycles(void)
+{
+	return cycles;
+}
+
+double simSeconds(void)
+{
+	return (double)cycles / F_CPU;
+}
+
+/**
+ * Lets the virtual time pass, the interrupts are executed in the
+ * meantime (if enabled).
+ */
+void simRun(uint32_t n)
+{
+	uint64_t end = cycles + n;
+
+	do {
+		uint64_t next = nextEvent();
+		if(next > end)
+			next = end;
+		step(next > cycles ? (uint32_t)(next - cycles) : 0);
+	} while(cycles < end);
+}
+
+void simRunMs(uint32_t ms)
+{
+	while(ms--)
+		simRun(F_CPU / 1000);
+}
+
+/**
+ * sleep_cpu(): waits for the next interrupt. With disabled interrupts
+ * the chip would sleep forever - here 1ms passes.
+ */
+void simSleep(void)
+{
+	uint32_t calls = 0;
+	uint64_t end = cycles + F_CPU / 1000;
+	uint8_t i;
+
+	for(i = 0; i < SIM_IRQ_COUNT; i++)
+		calls += irq_count[i];
+	while(cycles < end) {
+		uint64_t next = nextEvent();
+		uint32_t now = 0;
+		if(next > end)
+			next = end;
+		step(next > cycles ? (uint32_t)(next - cycles) : 0);
+		for(i = 0; i < SIM_IRQ_COUNT; i++)
+			now += irq_count[i];
+		if(now != calls)
+			break;
+	}
+}
+
+/*****************************************************************************/
+// Register access:
+
+volatile uint8_t *simReg8(uint8_t reg)
+{
+	step(SIM_ACCESS_CYCLES);
+	switch(reg) {
+		case SIM_TCNT2:
+			io8[SIM_TCNT2] = timer2Count();
+			break;
+		case SIM_UDR1:
+			io8[SIM_UDR1] = u1_rx_data;
+			if(in_rx_isr || (!(io8[SIM_UCSR1B] & (1 << RXCIE1)) && (u1_flags & (1 << RXC1)))) {
+				u1_flags &= ~((1 << RXC1) | (1 << DOR1) | (1 << FE1));
+				u1_rx_read = 1;
+			}
+			if(!in_rx_isr)
+				u1_tx_pending = 1;
+			break;
+	}
+	return &io8[reg];
+}
+
+volatile uint16_t *simReg16(uint8_t reg)
+{
+	step(SIM_ACCESS_CYCLES);
+	return &io16[reg];
+}
+
+volatile uint8_t *simReg16Byte(uint8_t reg, uint8_t high)
+{
+	step(SIM_ACCESS_CYCLES);
+	return (volatile uint8_t *)&io16[reg] + (high ? 1 : 0);	// little endian host
+}
+
+/*****************************************************************************/
+// avr-libc functions:
+
+uint8_t eeprom_read_byte(const uint8_t *addr)
+{
+	eeprom_busy_wait();
+	EEAR = (uintptr_t)addr & E2END;
+	EECR |= (1 << EERE);
+	return EEDR;
+}
+
+uint16_t eeprom_read_word(const uint16_t *addr)
+{
+	const uint8_t *p = (const uint8_t *)addr;
+	return eeprom_read_byte(p) | (eeprom_read_byte(p + 1) << 8);
+}
+
+uint32_t eeprom_read_dword(const uint32_t *addr)
+{
+	const uint16_t *p = (const uint16_t *)addr;
+	return eeprom_read_word(p) | ((uint32_t)eeprom_read_word(p + 1) << 16);
+}
+
+void eeprom_read_block(void *dst, const void *src, size_t n)
+{
+	uint8_t *d = dst;
+	const uint8_t *s = src;
+	while(n--)
+		*d++ = eeprom_read_byte(s++);
+}
+
+void eeprom_write_byte(uint8_t *addr, uint8_t value)
+{
+	eeprom_busy_wait();
+	EEAR = (uintptr_t)addr & E2END;
+	EEDR = value;
+	EECR |= (1 << EEMWE);
+	EECR |= (1 << EEWE);
+}
+
+void eeprom_write_word(uint16_t *addr, uint16_t value)
+{
+	uint8_t *p = (uint8_t *)addr;
+	eeprom_write_byte(p, value);
+	eeprom_write_byte(p + 1, value >> 8);
+}
+
+void eeprom_write_dword(uint32_t *addr, uint32_t value)
+{
+	uint16_t *p = (uint16_t *)addr;
+	eeprom_write_word(p, value);
+	eeprom_write_word(p + 1, value >> 16);
+}
+
+void eeprom_write_block(const void *src, void *dst, size_t n)
+{
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	while(n--)
+		eeprom_write_byte(d++, *s++);
+}
+
+void eeprom_update_byte(uint8_t *addr, uint8_t value)
+{
+	if(eeprom_read_byte(addr) != value)
+		eeprom_write_byte(addr, value);
+}
+
+void eeprom_update_word(uint16_t *addr, uint16_t value)
+{
+	uint8_t *p = (uint8_t *)addr;
+	eeprom_update_byte(p, value);
+	eeprom_update_byte(p + 1, value >> 8);
+}
+
+void eeprom_update_dword(uint32_t *addr, uint32_t value)
+{
+	uint16_t *p = (uint16_t *)addr;
+	eeprom_update_word(p, value);
+	eeprom_update_word(p + 1, value >> 16);
+}
+
+void eeprom_update_block(const void *src, void *dst, size_t n)
+{
+	const uint8_t *s = src;
+	uint8_t *d = dst;
+	while(n--)
+		eeprom_update_byte(d++, *s++);
+}
+
+static char *convert(unsigned long value, int negative, char *string, int radix)
+{
+	char buffer[34];
+	char *p = buffer, *s = string;
+
+	do {
+		uint8_t digit = value % radix;
+		*p++ = digit < 10 ? '0' + digit : 'a' + digit - 10;
+		value /= radix;
+	} while(value);
+	if(negative)
+		*s++ = '-';
+	while(p > buffer)
+		*s++ = *--p;
+	*s = 0;
+	return string;
+}
+
+char *itoa(int value, char *string, int radix)
+{
+	// like avr-libc: only radix 10 is signed
+	if(radix == 10 && value < 0)
+		return convert(-(long)value, 1, string, radix);
+	return convert((unsigned int)value & 0xFFFF, 0, string, radix);
+}
+
+char *utoa(unsigned int value, char *string, int radix)
+{
+	return convert(value & 0xFFFF, 0, string, radix);
+}
+
+char *ltoa(long value, char *string, int radix)
+{
+	if(radix == 10 && value < 0)
+		return convert(-(long long)value, 1, string, radix);
+	return convert((unsigned long)value & 0xFFFFFFFFUL, 0, string, radix);
+}
+
+char *ultoa(unsigned long value, char *string, int radix)
+{
+	return convert(value & 0xFFFFFFFFUL, 0, string, radix);
+}
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,102 @@
+/* ****************************************************************************
+ * File: host/avrsim/AvrSim.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Register level simulation of the parts of the ATmega64 the Robotarm
+ * library uses, so RobotArmBaseLib.c, RobotArmUart.c & co. can be compiled
+ * for the host without changes ("make sim") and run in native programs:
+ *
+ *  - Timer 2 in CTC mode with the TIMER2_COMP interrupt
+ *  - ADC with single conversions and the ADC interrupt, the input
+ *    voltages are set with simSetADC()
+ *  - USART1 transmitter and receiver with the USART1_RX, USART1_UDRE and
+ *    USART1_TX interrupts and the timing of the selected baudrate
+ *  - EEPROM with EERE/EEWE, 8.5ms write time and the EE_READY interrupt
+ *  - all other registers (ports, OCR1x/OCR3x, ...) are plain storage
+ *
+ * There is no CPU simulation. The virtual clock advances by
+ * SIM_ACCESS_CYCLES for every register access, to the next interrupt
+ * in sleep_cpu() and by the requested time in simRun() and the
+ * _delay_xx() functions. Pending interrupts are executed at these
+ * points if the I bit in SREG is set - like on the chip, but between
+ * register accesses instead of between instructions. So the virtual
+ * time only measures waiting, not computing.
+ *
+ * Example:
+ *
+ *		#include "RobotArmBase/RobotArmBaseLib.h"
+ *		#include "host/avrsim/AvrSim.h"
+ *
+ *		int main(void)
+ *		{
+ *			initRobotBase();				// 1 second virtual time
+ *			simSetADC(ADC_UBAT, 700);
+ *			moveTo(2, 100, 2);
+ *			waitForServo(2);
+ *			printf("%u %.3f s\n", Pos_Servo_2, simSeconds());
+ *		}
+ *
+ * Known differences to the chip: writing 1 to clear an interrupt flag is
+ * not simulated (TXC1 is cleared by writing UDR1, the other flags when
+ * the interrupt is executed), writes to TCNT2 are ignored and UDR1 is
+ * only read in the USART1_RX interrupt or when RXCIE1 is off.
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_H
+#define AVRSIM_H
+
+#include <stdint.h>
+#include <avr/io.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*****************************************************************************/
+// Virtual clock:
+
+#define SIM_ACCESS_CYCLES	2		// per register access
+#define SIM_ISR_CYCLES		8		// interrupt entry and reti
+
+void simReset(void);
+uint64_t simCycles(void);
+double simSeconds(void);
+void simRun(uint32_t cycles);
+void simRunMs(uint32_t ms);
+void simSleep(void);
+
+/*****************************************************************************/
+// Interrupts:
+
+#define SIM_IRQ_TIMER2_COMP	0
+#define SIM_IRQ_ADC			1
+#define SIM_IRQ_EE_READY	2
+#define SIM_IRQ_USART1_RX	3
+#define SIM_IRQ_USART1_UDRE	4
+#define SIM_IRQ_USART1_TX	5
+#define SIM_IRQ_COUNT		6
+
+uint32_t simInterruptCount(uint8_t irq);
+
+/*****************************************************************************/
+// Peripherals:
+
+void simSetADC(uint8_t channel, uint16_t value);
+
+void simUartReceive(const uint8_t *data, uint16_t length);
+uint16_t simUartReceivePending(void);
+uint16_t simUartTransmitted(uint8_t *buffer, uint16_t size);
+
+extern uint8_t sim_uart_echo;	// copy transmitted characters to stdout
+extern uint8_t sim_eeprom[E2END + 1];
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*****************************************************************************/
+// EOF
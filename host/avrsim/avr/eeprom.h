@@ -0,0 +1,47 @@
+/* ****************************************************************************
+ * File: host/avrsim/avr/eeprom.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Replacement for <avr/eeprom.h> in the host build. The functions use
+ * the simulated EEPROM registers, so a write takes 8.5ms of virtual time
+ * like on the chip. EEMEM variables are not supported - use fixed
+ * EEPROM addresses (0..E2END).
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_EEPROM_H
+#define AVRSIM_EEPROM_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <avr/io.h>
+
+#define EEMEM
+
+#define eeprom_is_ready()	(!(EECR & (1 << EEWE)))
+#define eeprom_busy_wait()	do {} while(!eeprom_is_ready())
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+uint8_t eeprom_read_byte(const uint8_t *addr);
+uint16_t eeprom_read_word(const uint16_t *addr);
+uint32_t eeprom_read_dword(const uint32_t *addr);
+void eeprom_read_block(void *dst, const void *src, size_t n);
+void eeprom_write_byte(uint8_t *addr, uint8_t value);
+void eeprom_write_word(uint16_t *addr, uint16_t value);
+void eeprom_write_dword(uint32_t *addr, uint32_t value);
+void eeprom_write_block(const void *src, void *dst, size_t n);
+void eeprom_update_byte(uint8_t *addr, uint8_t value);
+void eeprom_update_word(uint16_t *addr, uint16_t value);
+void eeprom_update_dword(uint32_t *addr, uint32_t value);
+void eeprom_update_block(const void *src, void *dst, size_t n);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,42 @@
+/* ****************************************************************************
+ * File: host/avrsim/avr/interrupt.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Replacement for <avr/interrupt.h> in the host build. ISR(vector)
+ * defines a normal function with the name of the vector; the simulator
+ * calls it when the interrupt is enabled and pending (s. AvrSim.c).
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_INTERRUPT_H
+#define AVRSIM_INTERRUPT_H
+
+#include <avr/io.h>
+
+#define ISR(vector, ...) void vector(void); void vector(void)
+
+#define sei() (SREG |= (1 << SREG_I))
+#define cli() (SREG &= ~(1 << SREG_I))
+#define reti() return
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Interrupts the simulator can fire, highest priority first:
+void TIMER2_COMP_vect(void);
+void ADC_vect(void);
+void EE_READY_vect(void);
+void USART1_RX_vect(void);
+void USART1_UDRE_vect(void);
+void USART1_TX_vect(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*****************************************************************************/
+// EOF
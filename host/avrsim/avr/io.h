@@ -0,0 +1,434 @@
+/* ****************************************************************************
+ * File: host/avrsim/avr/io.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Replacement for <avr/io.h> in the host build (make sim). Every register
+ * access goes through simReg8()/simReg16(), which advance the virtual
+ * clock of the simulated ATmega64 and run its peripherals, so polling
+ * loops like while(ADCSRA & (1<<ADSC)) work as on the real chip.
+ * s. host/avrsim/AvrSim.h
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_IO_H
+#define AVRSIM_IO_H
+
+#include <stdint.h>
+
+/*****************************************************************************/
+// Registers:
+
+enum {
+	SIM_PINF,
+	SIM_PINE,
+	SIM_DDRE,
+	SIM_PORTE,
+	SIM_ADCSRA,
+	SIM_ADMUX,
+	SIM_ACSR,
+	SIM_UCSR0B,
+	SIM_UCSR0A,
+	SIM_UDR0,
+	SIM_SPCR,
+	SIM_SPSR,
+	SIM_SPDR,
+	SIM_PIND,
+	SIM_DDRD,
+	SIM_PORTD,
+	SIM_PINC,
+	SIM_DDRC,
+	SIM_PORTC,
+	SIM_PINB,
+	SIM_DDRB,
+	SIM_PORTB,
+	SIM_PINA,
+	SIM_DDRA,
+	SIM_PORTA,
+	SIM_EECR,
+	SIM_EEDR,
+	SIM_SFIOR,
+	SIM_WDTCR,
+	SIM_OCDR,
+	SIM_OCR2,
+	SIM_TCNT2,
+	SIM_TCCR2,
+	SIM_ASSR,
+	SIM_OCR0,
+	SIM_TCNT0,
+	SIM_TCCR0,
+	SIM_MCUCSR,
+	SIM_MCUCR,
+	SIM_TIFR,
+	SIM_TIMSK,
+	SIM_EIFR,
+	SIM_EIMSK,
+	SIM_EICRB,
+	SIM_XDIV,
+	SIM_SREG,
+	SIM_DDRF,
+	SIM_PORTF,
+	SIM_PING,
+	SIM_DDRG,
+	SIM_PORTG,
+	SIM_SPMCSR,
+	SIM_EICRA,
+	SIM_XMCRB,
+	SIM_XMCRA,
+	SIM_OSCCAL,
+	SIM_TWBR,
+	SIM_TWSR,
+	SIM_TWAR,
+	SIM_TWDR,
+	SIM_TWCR,
+	SIM_ETIFR,
+	SIM_ETIMSK,
+	SIM_TCCR1A,
+	SIM_TCCR1B,
+	SIM_TCCR1C,
+	SIM_TCCR3A,
+	SIM_TCCR3B,
+	SIM_TCCR3C,
+	SIM_UBRR0H,
+	SIM_UBRR1H,
+	SIM_UBRR0L,
+	SIM_UBRR1L,
+	SIM_UCSR0C,
+	SIM_UCSR1C,
+	SIM_UCSR1A,
+	SIM_UCSR1B,
+	SIM_UDR1,
+	SIM_ADCSRB,
+	SIM_IO8_COUNT
+};
+
+enum {
+	SIM_ADC,
+	SIM_OCR1A,
+	SIM_OCR1B,
+	SIM_OCR1C,
+	SIM_OCR3A,
+	SIM_OCR3B,
+	SIM_OCR3C,
+	SIM_ICR1,
+	SIM_ICR3,
+	SIM_TCNT1,
+	SIM_TCNT3,
+	SIM_EEAR,
+	SIM_SP,
+	SIM_IO16_COUNT
+};
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+volatile uint8_t *simReg8(uint8_t reg);
+volatile uint16_t *simReg16(uint8_t reg);
+volatile uint8_t *simReg16Byte(uint8_t reg, uint8_t high);
+#ifdef __cplusplus
+}
+#endif
+
+#define PINF     (*simReg8(SIM_PINF))
+#define PINE     (*simReg8(SIM_PINE))
+#define DDRE     (*simReg8(SIM_DDRE))
+#define PORTE    (*simReg8(SIM_PORTE))
+#define ADCSRA   (*simReg8(SIM_ADCSRA))
+#define ADMUX    (*simReg8(SIM_ADMUX))
+#define ACSR     (*simReg8(SIM_ACSR))
+#define UCSR0B   (*simReg8(SIM_UCSR0B))
+#define UCSR0A   (*simReg8(SIM_UCSR0A))
+#define UDR0     (*simReg8(SIM_UDR0))
+#define SPCR     (*simReg8(SIM_SPCR))
+#define SPSR     (*simReg8(SIM_SPSR))
+#define SPDR     (*simReg8(SIM_SPDR))
+#define PIND     (*simReg8(SIM_PIND))
+#define DDRD     (*simReg8(SIM_DDRD))
+#define PORTD    (*simReg8(SIM_PORTD))
+#define PINC     (*simReg8(SIM_PINC))
+#define DDRC     (*simReg8(SIM_DDRC))
+#define PORTC    (*simReg8(SIM_PORTC))
+#define PINB     (*simReg8(SIM_PINB))
+#define DDRB     (*simReg8(SIM_DDRB))
+#define PORTB    (*simReg8(SIM_PORTB))
+#define PINA     (*simReg8(SIM_PINA))
+#define DDRA     (*simReg8(SIM_DDRA))
+#define PORTA    (*simReg8(SIM_PORTA))
+#define EECR     (*simReg8(SIM_EECR))
+#define EEDR     (*simReg8(SIM_EEDR))
+#define SFIOR    (*simReg8(SIM_SFIOR))
+#define WDTCR    (*simReg8(SIM_WDTCR))
+#define OCDR     (*simReg8(SIM_OCDR))
+#define OCR2     (*simReg8(SIM_OCR2))
+#define TCNT2    (*simReg8(SIM_TCNT2))
+#define TCCR2    (*simReg8(SIM_TCCR2))
+#define ASSR     (*simReg8(SIM_ASSR))
+#define OCR0     (*simReg8(SIM_OCR0))
+#define TCNT0    (*simReg8(SIM_TCNT0))
+#define TCCR0    (*simReg8(SIM_TCCR0))
+#define MCUCSR   (*simReg8(SIM_MCUCSR))
+#define MCUCR    (*simReg8(SIM_MCUCR))
+#define TIFR     (*simReg8(SIM_TIFR))
+#define TIMSK    (*simReg8(SIM_TIMSK))
+#define EIFR     (*simReg8(SIM_EIFR))
+#define EIMSK    (*simReg8(SIM_EIMSK))
+#define EICRB    (*simReg8(SIM_EICRB))
+#define XDIV     (*simReg8(SIM_XDIV))
+#define SREG     (*simReg8(SIM_SREG))
+#define DDRF     (*simReg8(SIM_DDRF))
+#define PORTF    (*simReg8(SIM_PORTF))
+#define PING     (*simReg8(SIM_PING))
+#define DDRG     (*simReg8(SIM_DDRG))
+#define PORTG    (*simReg8(SIM_PORTG))
+#define SPMCSR   (*simReg8(SIM_SPMCSR))
+#define EICRA    (*simReg8(SIM_EICRA))
+#define XMCRB    (*simReg8(SIM_XMCRB))
+#define XMCRA    (*simReg8(SIM_XMCRA))
+#define OSCCAL   (*simReg8(SIM_OSCCAL))
+#define TWBR     (*simReg8(SIM_TWBR))
+#define TWSR     (*simReg8(SIM_TWSR))
+#define TWAR     (*simReg8(SIM_TWAR))
+#define TWDR     (*simReg8(SIM_TWDR))
+#define TWCR     (*simReg8(SIM_TWCR))
+#define ETIFR    (*simReg8(SIM_ETIFR))
+#define ETIMSK   (*simReg8(SIM_ETIMSK))
+#define TCCR1A   (*simReg8(SIM_TCCR1A))
+#define TCCR1B   (*simReg8(SIM_TCCR1B))
+#define TCCR1C   (*simReg8(SIM_TCCR1C))
+#define TCCR3A   (*simReg8(SIM_TCCR3A))
+#define TCCR3B   (*simReg8(SIM_TCCR3B))
+#define TCCR3C   (*simReg8(SIM_TCCR3C))
+#define UBRR0H   (*simReg8(SIM_UBRR0H))
+#define UBRR1H   (*simReg8(SIM_UBRR1H))
+#define UBRR0L   (*simReg8(SIM_UBRR0L))
+#define UBRR1L   (*simReg8(SIM_UBRR1L))
+#define UCSR0C   (*simReg8(SIM_UCSR0C))
+#define UCSR1C   (*simReg8(SIM_UCSR1C))
+#define UCSR1A   (*simReg8(SIM_UCSR1A))
+#define UCSR1B   (*simReg8(SIM_UCSR1B))
+#define UDR1     (*simReg8(SIM_UDR1))
+#define ADCSRB   (*simReg8(SIM_ADCSRB))
+
+#define ADC      (*simReg16(SIM_ADC))
+#define OCR1A    (*simReg16(SIM_OCR1A))
+#define OCR1B    (*simReg16(SIM_OCR1B))
+#define OCR1C    (*simReg16(SIM_OCR1C))
+#define OCR3A    (*simReg16(SIM_OCR3A))
+#define OCR3B    (*simReg16(SIM_OCR3B))
+#define OCR3C    (*simReg16(SIM_OCR3C))
+#define ICR1     (*simReg16(SIM_ICR1))
+#define ICR3     (*simReg16(SIM_ICR3))
+#define TCNT1    (*simReg16(SIM_TCNT1))
+#define TCNT3    (*simReg16(SIM_TCNT3))
+#define EEAR     (*simReg16(SIM_EEAR))
+#define SP       (*simReg16(SIM_SP))
+#define ADCW     ADC
+
+#define ADCL     (*simReg16Byte(SIM_ADC, 0))
+#define ADCH     (*simReg16Byte(SIM_ADC, 1))
+#define OCR1AL   (*simReg16Byte(SIM_OCR1A, 0))
+#define OCR1AH   (*simReg16Byte(SIM_OCR1A, 1))
+#define OCR1BL   (*simReg16Byte(SIM_OCR1B, 0))
+#define OCR1BH   (*simReg16Byte(SIM_OCR1B, 1))
+#define OCR1CL   (*simReg16Byte(SIM_OCR1C, 0))
+#define OCR1CH   (*simReg16Byte(SIM_OCR1C, 1))
+#define OCR3AL   (*simReg16Byte(SIM_OCR3A, 0))
+#define OCR3AH   (*simReg16Byte(SIM_OCR3A, 1))
+#define OCR3BL   (*simReg16Byte(SIM_OCR3B, 0))
+#define OCR3BH   (*simReg16Byte(SIM_OCR3B, 1))
+#define OCR3CL   (*simReg16Byte(SIM_OCR3C, 0))
+#define OCR3CH   (*simReg16Byte(SIM_OCR3C, 1))
+#define ICR1L    (*simReg16Byte(SIM_ICR1, 0))
+#define ICR1H    (*simReg16Byte(SIM_ICR1, 1))
+#define ICR3L    (*simReg16Byte(SIM_ICR3, 0))
+#define ICR3H    (*simReg16Byte(SIM_ICR3, 1))
+#define TCNT1L   (*simReg16Byte(SIM_TCNT1, 0))
+#define TCNT1H   (*simReg16Byte(SIM_TCNT1, 1))
+#define TCNT3L   (*simReg16Byte(SIM_TCNT3, 0))
+#define TCNT3H   (*simReg16Byte(SIM_TCNT3, 1))
+#define EEARL    (*simReg16Byte(SIM_EEAR, 0))
+#define EEARH    (*simReg16Byte(SIM_EEAR, 1))
+#define SPL      (*simReg16Byte(SIM_SP, 0))
+#define SPH      (*simReg16Byte(SIM_SP, 1))
+
+/*****************************************************************************/
+// Memory:
+
+#define RAMSTART	0x100
+#define RAMEND		0x10FF
+#define E2END		0x7FF
+
+// Simulated SRAM, index = AVR address (s. RobotArmMemory.c):
+extern uint8_t sim_sram[RAMEND + 1];
+
+/*****************************************************************************/
+// Bits:
+
+#define _BV(bit) (1 << (bit))
+
+#define R8(n) extern volatile uint8_t n
+#define R16(n) extern volatile uint16_t n
+#define PINA0 0
+#define PINA1 1
+#define PINA2 2
+#define PINA3 3
+#define PINA4 4
+#define PINA5 5
+#define PINA6 6
+#define PINA7 7
+#define PINB0 0
+#define PINB1 1
+#define PINB2 2
+#define PINB3 3
+#define PINB4 4
+#define PINB5 5
+#define PINB6 6
+#define PINB7 7
+#define PINC0 0
+#define PINC1 1
+#define PINC2 2
+#define PINC3 3
+#define PINC4 4
+#define PINC5 5
+#define PINC6 6
+#define PINC7 7
+#define PIND0 0
+#define PIND1 1
+#define PIND2 2
+#define PIND3 3
+#define PIND4 4
+#define PIND5 5
+#define PIND6 6
+#define PIND7 7
+#define PINE0 0
+#define PINE1 1
+#define PINE2 2
+#define PINE3 3
+#define PINE4 4
+#define PINE5 5
+#define PINE6 6
+#define PINE7 7
+#define PINF0 0
+#define PINF1 1
+#define PINF2 2
+#define PINF3 3
+#define PINF4 4
+#define PINF5 5
+#define PINF6 6
+#define PINF7 7
+#define PING0 0
+#define PING1 1
+#define PING2 2
+#define PING3 3
+#define PING4 4
+#define WGM00 6
+#define WGM01 3
+#define COM00 4
+#define COM01 5
+#define CS00 0
+#define CS01 1
+#define CS02 2
+#define WGM20 6
+#define WGM21 3
+#define COM20 4
+#define COM21 5
+#define CS20 0
+#define CS21 1
+#define CS22 2
+#define OCIE2 7
+#define TOIE2 6
+#define OCF2 7
+#define TOV2 6
+#define OCIE0 1
+#define TOIE0 0
+#define ICNC1 7
+#define ICES1 6
+#define WGM13 4
+#define WGM12 3
+#define CS12 2
+#define CS11 1
+#define CS10 0
+#define COM1A1 7
+#define COM1A0 6
+#define COM1B1 5
+#define COM1B0 4
+#define COM1C1 3
+#define COM1C0 2
+#define WGM11 1
+#define WGM10 0
+#define TICIE1 5
+#define OCIE1A 4
+#define OCIE1B 3
+#define TOIE1 2
+#define ICF1 5
+#define OCF1A 4
+#define OCF1B 3
+#define TOV1 2
+#define OCF0 1
+#define TOV0 0
+#define REFS0 6
+#define REFS1 7
+#define ADLAR 5
+#define MUX0 0
+#define MUX1 1
+#define MUX2 2
+#define MUX3 3
+#define MUX4 4
+#define ADEN 7
+#define ADSC 6
+#define ADATE 5
+#define ADFR 5
+#define ADIF 4
+#define ADIE 3
+#define ADPS2 2
+#define ADPS1 1
+#define ADPS0 0
+#define ADTS0 0
+#define ADTS1 1
+#define ADTS2 2
+#define RXC0 7
+#define TXC0 6
+#define UDRE0 5
+#define FE0 4
+#define DOR0 3
+#define UPE0 2
+#define U2X0 1
+#define MPCM0 0
+#define RXCIE0 7
+#define TXCIE0 6
+#define UDRIE0 5
+#define RXEN0 4
+#define TXEN0 3
+#define UCSZ02 2
+#define UCSZ01 2
+#define UCSZ00 1
+#define RXC1 7
+#define TXC1 6
+#define UDRE1 5
+#define FE1 4
+#define DOR1 3
+#define UPE1 2
+#define U2X1 1
+#define MPCM1 0
+#define RXCIE1 7
+#define TXCIE1 6
+#define UDRIE1 5
+#define RXEN1 4
+#define TXEN1 3
+#define UCSZ12 2
+#define UCSZ11 2
+#define UCSZ10 1
+#define EERIE 3
+#define EEMWE 2
+#define EEWE 1
+#define EERE 0
+#define SREG_I 7
+#define SE 5
+#define SM0 3
+#define SM1 4
+#define SM2 2
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,36 @@
+/* ****************************************************************************
+ * File: host/avrsim/avr/pgmspace.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Replacement for <avr/pgmspace.h> in the host build. There is only one
+ * address space on the host, so PROGMEM data is read directly.
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_PGMSPACE_H
+#define AVRSIM_PGMSPACE_H
+
+#include <stdint.h>
+#include <string.h>
+
+#define PROGMEM
+#define PGM_P const char *
+#define PSTR(s) (s)
+
+#define pgm_read_byte(addr)			(*(const uint8_t *)(addr))
+#define pgm_read_byte_near(addr)	pgm_read_byte(addr)
+#define pgm_read_word(addr)			(*(const uint16_t *)(addr))
+#define pgm_read_word_near(addr)	pgm_read_word(addr)
+#define pgm_read_dword(addr)		(*(const uint32_t *)(addr))
+#define pgm_read_dword_near(addr)	pgm_read_dword(addr)
+
+#define memcpy_P	memcpy
+#define strlen_P	strlen
+#define strcpy_P	strcpy
+#define strcmp_P	strcmp
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,41 @@
+/* ****************************************************************************
+ * File: host/avrsim/avr/sleep.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Replacement for <avr/sleep.h> in the host build. sleep_cpu() lets the
+ * virtual clock jump to the next interrupt.
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_SLEEP_H
+#define AVRSIM_SLEEP_H
+
+#include <avr/io.h>
+
+#define SLEEP_MODE_IDLE			0
+#define SLEEP_MODE_ADC			(1 << SM0)
+#define SLEEP_MODE_PWR_DOWN		(1 << SM1)
+#define SLEEP_MODE_PWR_SAVE		((1 << SM0) | (1 << SM1))
+#define SLEEP_MODE_STANDBY		((1 << SM1) | (1 << SM2))
+#define SLEEP_MODE_EXT_STANDBY	((1 << SM0) | (1 << SM1) | (1 << SM2))
+
+#define set_sleep_mode(mode) \
+	(MCUCR = (MCUCR & ~((1 << SM0) | (1 << SM1) | (1 << SM2))) | (mode))
+#define sleep_enable()	(MCUCR |= (1 << SE))
+#define sleep_disable()	(MCUCR &= ~(1 << SE))
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void simSleep(void);
+#ifdef __cplusplus
+}
+#endif
+#define sleep_cpu()		simSleep()
+#define sleep_mode()	do { sleep_enable(); sleep_cpu(); sleep_disable(); } while(0)
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,30 @@
+/* ****************************************************************************
+ * File: host/avrsim/stdlib.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Adds the avr-libc number conversion functions to the <stdlib.h> of the
+ * host (implemented in AvrSim.c).
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_STDLIB_H
+#define AVRSIM_STDLIB_H
+
+#include_next <stdlib.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+char *itoa(int value, char *string, int radix);
+char *utoa(unsigned int value, char *string, int radix);
+char *ltoa(long value, char *string, int radix);
+char *ultoa(unsigned long value, char *string, int radix);
+#ifdef __cplusplus
+}
+#endif
+
+#endif
+
+/*****************************************************************************/
+// EOF
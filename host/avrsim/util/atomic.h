@@ -0,0 +1,63 @@
+/* ****************************************************************************
+ * File: host/avrsim/util/atomic.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Replacement for <util/atomic.h> in the host build. Works like the
+ * avr-libc version: the I bit of the simulated SREG is cleared for the
+ * block and restored (or set) when the block is left, also with return
+ * or break.
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_ATOMIC_H
+#define AVRSIM_ATOMIC_H
+
+#include <avr/interrupt.h>
+
+static inline uint8_t simAtomicCli(void)
+{
+	cli();
+	return 1;
+}
+
+static inline uint8_t simAtomicSei(void)
+{
+	sei();
+	return 1;
+}
+
+static inline void simAtomicRestore(const uint8_t *sreg)
+{
+	SREG = *sreg;
+}
+
+static inline void simAtomicForceOn(const uint8_t *sreg)
+{
+	(void)sreg;
+	sei();
+}
+
+static inline void simAtomicForceOff(const uint8_t *sreg)
+{
+	(void)sreg;
+	cli();
+}
+
+#define ATOMIC_BLOCK(type) \
+	for(type, sim_atomic_todo = simAtomicCli(); sim_atomic_todo; sim_atomic_todo = 0)
+#define NONATOMIC_BLOCK(type) \
+	for(type, sim_atomic_todo = simAtomicSei(); sim_atomic_todo; sim_atomic_todo = 0)
+
+#define ATOMIC_RESTORESTATE \
+	uint8_t sim_sreg_save __attribute__((__cleanup__(simAtomicRestore))) = SREG
+#define ATOMIC_FORCEON \
+	uint8_t sim_sreg_save __attribute__((__cleanup__(simAtomicForceOn))) = 0
+#define NONATOMIC_RESTORESTATE ATOMIC_RESTORESTATE
+#define NONATOMIC_FORCEOFF \
+	uint8_t sim_sreg_save __attribute__((__cleanup__(simAtomicForceOff))) = 0
+
+#endif
+
+/*****************************************************************************/
+// EOF
@@ -0,0 +1,32 @@
+/* ****************************************************************************
+ * File: host/avrsim/util/delay.h
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Replacement for <util/delay.h> in the host build. The delays advance
+ * the virtual clock, interrupts are executed in the meantime.
+ * ****************************************************************************
+ */
+
+#ifndef AVRSIM_DELAY_H
+#define AVRSIM_DELAY_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+void simRun(uint32_t cycles);
+#ifdef __cplusplus
+}
+#endif
+
+#define _delay_loop_1(count)	simRun(3UL * ((count) ? (count) : 256))
+#define _delay_loop_2(count)	simRun(4UL * ((count) ? (count) : 65536))
+#define _delay_us(us)			simRun((uint32_t)((us) * (F_CPU / 1e6)))
+#define _delay_ms(ms)			simRun((uint32_t)((ms) * (F_CPU / 1e3)))
+
+#endif
+
+/*****************************************************************************/
+// EOF
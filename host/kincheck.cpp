@@ -0,0 +1,151 @@
+/* ****************************************************************************
+ * File: host/kincheck.cpp
+ * Target: host PC (C++11), firmware kinematics from host/libRobotArmSim.a
+ * ****************************************************************************
+ * Description:
+ * Checks the fixed point kinematics of the firmware
+ * (RobotArmBase/RobotArmKinematics.c) against the double precision
+ * reference (host/RobotArmKinematics.cpp). Build and run with
+ * "make kincheck", the exit code is 1 if a check fails.
+ *
+ *  - forward kinematics of 200000 random joint offsets: position and
+ *    pitch error
+ *  - inverse kinematics of the poses reached by these offsets: difference
+ *    of the servo offsets, separately for an almost stretched elbow
+ *  - a sweep over the whole int16 input range: a wrist point more than
+ *    1% out of reach must return KIN_UNREACHABLE (once 32 bit overflows
+ *    returned KIN_OK or KIN_JOINT_LIMIT here)
+ * ****************************************************************************
+ */
+
+#include <cmath>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <random>
+
+extern "C" {
+#include "RobotArmBase/RobotArmKinematics.h"
+}
+#include "host/RobotArmKinematics.hpp"
+
+using namespace robotarm;
+
+static const double MM = 0.1;						// mm per length unit
+static const int LIMIT_MARGIN = 4;					// counts, rounding error + 1
+static const int STRETCHED = KIN_DEFAULT_QUARTER / 9;	// elbow offset for 10 degree
+
+static int failures;
+
+static void check(bool ok, const char *what)
+{
+	std::printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+	if(!ok)
+		failures++;
+}
+
+/**
+ * Distance of the wrist axis from the shoulder axis in mm, like the
+ * reference inverse kinematics.
+ */
+static double wristDistance(const kin_pose_t &fixed)
+{
+	Pose pose = fromFixed(fixed);
+	double rw = std::hypot(pose.x, pose.y) - KIN_TOOL * MM * std::cos(pose.pitch);
+	double zw = pose.z - KIN_BASE_HEIGHT * MM - KIN_TOOL * MM * std::sin(pose.pitch);
+	return std::hypot(rw, zw);
+}
+
+static void randomPoses()
+{
+	Kinematics reference;
+	std::mt19937 random(12345);
+	std::uniform_int_distribution<int> offset(KIN_OFFSET_MIN, KIN_OFFSET_MAX);
+	double fkPosition = 0, fkPitch = 0;
+	int ikCounts = 0, ikStretched = 0;
+	long ikMissing = 0, poses = 200000;
+
+	for(long n = 0; n < poses; n++) {
+		Joints joints;
+		int16_t fixedJoints[PROTOCOL_JOINTS];
+		for(int i = 0; i < PROTOCOL_JOINTS; i++)
+			fixedJoints[i] = joints[i] = offset(random);
+
+		kin_pose_t fixed;
+		forwardKinematics(fixedJoints, &fixed);
+		Pose exact = reference.forward(joints);
+		Pose approx = fromFixed(fixed);
+		fkPosition = std::fmax(fkPosition, std::sqrt(std::pow(approx.x - exact.x, 2)
+			+ std::pow(approx.y - exact.y, 2) + std::pow(approx.z - exact.z, 2)));
+		fkPitch = std::fmax(fkPitch, std::fabs(std::remainder(approx.pitch - exact.pitch, 2 * M_PI)));
+
+		// Inverse of the exact pose, both rounded to the input resolution:
+		kin_pose_t target = toFixed(exact);
+		Joints expected;
+		int16_t result[PROTOCOL_JOINTS];
+		if(reference.inverse(fromFixed(target), expected) != KIN_OK)
+			continue;	// elbow down solution or rounded beyond a limit
+		if(std::any_of(expected.begin(), expected.end(),
+		               [](int16_t offset) { return std::abs(offset) > KIN_OFFSET_MAX - LIMIT_MARGIN; }))
+			continue;	// the rounding error may cross the joint limit
+		if(inverseKinematics(&target, result) != KIN_OK) {
+			if(std::abs(expected[3]) > STRETCHED)
+				ikMissing++;
+			continue;
+		}
+		int counts = 0;
+		for(int i = 0; i < PROTOCOL_JOINTS; i++)
+			counts = std::max(counts, std::abs(result[i] - expected[i]));
+		if(std::abs(expected[3]) > STRETCHED)
+			ikCounts = std::max(ikCounts, counts);
+		else
+			ikStretched = std::max(ikStretched, counts);
+	}
+
+	std::printf("%ld random poses:\n", poses);
+	std::printf("  forward position error   %8.3f mm\n", fkPosition);
+	std::printf("  forward pitch error      %8.3f degree\n", fkPitch * 180 / M_PI);
+	std::printf("  inverse offset error     %8d counts\n", ikCounts);
+	std::printf("  - elbow within 10 degree %8d counts\n", ikStretched);
+	std::printf("  inverse not solved       %8ld poses (elbow > 10 degree)\n", ikMissing);
+	check(fkPosition <= 0.2, "forward kinematics better than 0.2 mm");
+	check(fkPitch * 180 / M_PI <= 0.03, "forward kinematics better than 0.03 degree");
+	check(ikCounts <= 3, "inverse kinematics within 3 counts (elbow > 10 degree)");
+	check(ikMissing == 0, "inverse kinematics solves all poses (elbow > 10 degree)");
+}
+
+static void reachSweep()
+{
+	const double reach = (KIN_UPPER_ARM + KIN_FOREARM) * MM;
+	const int16_t pitches[] = {-32768, -24576, -16384, -8192, 0, 8192, 16384, 24576};
+	const int16_t ys[] = {-32768, 0, 20000};
+	long unreachable = 0, wrong = 0;
+
+	for(int16_t pitch : pitches)
+		for(int16_t y : ys)
+			for(long x = -32768; x < 32768; x += 97)
+				for(long z = -32768; z < 32768; z += 89) {
+					kin_pose_t pose = {(int16_t)x, y, (int16_t)z, pitch, 0, 0};
+					int16_t offsets[PROTOCOL_JOINTS];
+					if(wristDistance(pose) <= reach * 1.01)
+						continue;
+					unreachable++;
+					if(inverseKinematics(&pose, offsets) != KIN_UNREACHABLE)
+						wrong++;
+				}
+	std::printf("%ld poses out of reach, %ld not KIN_UNREACHABLE\n", unreachable, wrong);
+	check(wrong == 0, "poses out of reach return KIN_UNREACHABLE");
+
+	// Found by the sweep before the range check: 1.4 m out of reach, KIN_OK
+	kin_pose_t far = {7596, 0, -15091, -8192, 0, 0};
+	int16_t offsets[PROTOCOL_JOINTS];
+	check(inverseKinematics(&far, offsets) == KIN_UNREACHABLE,
+	      "x=7596 z=-15091 pitch=-8192 is KIN_UNREACHABLE");
+}
+
+int main()
+{
+	randomPoses();
+	reachSweep();
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,93 @@
+/* ****************************************************************************
+ * File: host/mathbench.cpp
+ * Target: host PC (C++11)
+ * ****************************************************************************
+ * Description:
+ * Checks the fixed point math of the firmware (RobotArmBase/RobotArmMath.c,
+ * compiled for the host) against libm: maximum error over the whole input
+ * range and nanoseconds per call of both. Build and run with
+ * "make mathbench".
+ *
+ * The speed on the host only shows the relation between the functions,
+ * on the ATmega64 the float functions are much slower (no FPU, no 32 bit
+ * multiplier).
+ * ****************************************************************************
+ */
+
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdint>
+
+extern "C" {
+#include "RobotArmBase/RobotArmMath.h"
+}
+
+static const double ANGLE = M_PI / 32768.0;		// radians per binary angle
+static volatile int32_t sink;					// keeps the loops alive
+static volatile double sinkf;
+
+template<typename F>
+static double nsPerCall(long calls, F f)
+{
+	auto start = std::chrono::steady_clock::now();
+	for(long i = 0; i < calls; i++)
+		f(i);
+	std::chrono::duration<double, std::nano> time = std::chrono::steady_clock::now() - start;
+	return time.count() / calls;
+}
+
+static void result(const char *name, const char *unit, double error, double fix, double libm)
+{
+	std::printf("%-10s %10.4f %-14s %8.2f %8.2f\n", name, error, unit, fix, libm);
+}
+
+int main()
+{
+	const long calls = 1000000;
+	double error;
+
+	std::printf("%-10s %25s %8s %8s\n", "function", "max. error", "ns fix", "ns libm");
+
+	error = 0;
+	for(long a = -32768; a < 32768; a++)
+		error = std::fmax(error, std::fabs(fixSin(a) - FIX_ONE * std::sin(a * ANGLE)));
+	result("fixSin", "(of 32767)", error,
+	       nsPerCall(calls, [](long i) { sink = fixSin(i * 7); }),
+	       nsPerCall(calls, [](long i) { sinkf = std::sin(i * 7 * ANGLE); }));
+
+	error = 0;
+	for(long y = -40000; y <= 40000; y += 397)
+		for(long x = -40000; x <= 40000; x += 401)
+			error = std::fmax(error, std::fabs(std::remainder(
+				fixAtan2(y, x) - std::atan2(y, x) / ANGLE, 65536.0)));
+	result("fixAtan2", "(binary angle)", error,
+	       nsPerCall(calls, [](long i) { sink = fixAtan2(i * 13 - 6500000, 1234567 - i * 3); }),
+	       nsPerCall(calls, [](long i) { sinkf = std::atan2(i * 13 - 6500000, 1234567 - i * 3); }));
+
+	error = 0;
+	for(uint32_t v = 0; v < 0xFFFF0000UL; v += 65521) {
+		uint32_t r = fixSqrt(v);
+		if((uint64_t)r * r > v || (uint64_t)(r + 1) * (r + 1) <= v)
+			error = 1;
+	}
+	result("fixSqrt", "(exact = 0)", error,
+	       nsPerCall(calls, [](long i) { sink = fixSqrt(i * 4093); }),
+	       nsPerCall(calls, [](long i) { sinkf = std::sqrt((double)(i * 4093)); }));
+
+	error = 0;
+	for(long x = 2; x < 65536; x++)
+		error = std::fmax(error, std::fabs(fixRecip(x) - 4294967296.0 / x) * x / 65536.0);
+	result("fixRecip", "(* 2^-16 rel.)", error,
+	       nsPerCall(calls, [](long i) { sink = fixRecip(i | 2); }),
+	       nsPerCall(calls, [](long i) { sinkf = 4294967296.0 / (i | 2); }));
+
+	error = 0;
+	for(long a = 0; a < 65536; a += 7)
+		for(long x = 1; x < 65536; x += 89)
+			error = std::fmax(error, std::fabs((double)(a / x) - (double)fixDiv(a, x)));
+	result("fixDiv", "(integer)", error,
+	       nsPerCall(calls, [](long i) { sink = fixDiv(i & 0xFFFF, (i >> 4) | 1); }),
+	       nsPerCall(calls, [](long i) { sinkf = (double)(i & 0xFFFF) / ((i >> 4) | 1); }));
+	return 0;
+}
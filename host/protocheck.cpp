@@ -0,0 +1,214 @@
+/* ****************************************************************************
+ * File: host/protocheck.cpp
+ * Target: host PC (C++11), firmware from host/libRobotArmSim.a
+ * ****************************************************************************
+ * Description:
+ * Checks the binary command protocol end to end: the host library
+ * (host/RobotArmProtocol.cpp) encodes the frames, they are received by
+ * the simulated USART1 and executed by task_protocol() of the firmware
+ * (RobotArmBase/RobotArmProtocol.c), the answers are decoded by the host
+ * library again. Build and run with "make protocheck", the exit code is
+ * 1 if a check fails.
+ *
+ *  - MSG_SET_ALL is 15 bytes on the wire and sets the servos
+ *  - ACK and NAK with the sequence number of the frame
+ *  - a retransmission is acknowledged but not executed twice
+ *  - CRC, COBS and length errors, unknown types and bad parameters
+ *  - the pose messages: teach, set, query, NAK_BUSY while the EEPROM is
+ *    written, sequences and playback
+ * ****************************************************************************
+ */
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "RobotArmBase/RobotArmBaseLib.h"
+#include "RobotArmBase/RobotArmProtocol.h"
+#include "host/avrsim/AvrSim.h"
+}
+#include "host/RobotArmProtocol.hpp"
+
+using namespace robotarm;
+
+static const int TIMEOUT = 1000;		// ms for an answer
+
+static int failures;
+static FrameDecoder decoder;
+
+static void check(bool ok, const std::string &what)
+{
+	std::printf("%-60s %s\n", what.c_str(), ok ? "ok" : "FAILED");
+	if(!ok)
+		failures++;
+}
+
+/**
+ * Sends the bytes to the simulated arm and returns the answer. The
+ * type of the returned frame is 0 if there was none within TIMEOUT.
+ */
+static Frame transfer(const std::vector<uint8_t> &bytes)
+{
+	simUartReceive(bytes.data(), bytes.size());
+	for(int ms = 0; ms < TIMEOUT; ms++) {
+		uint8_t buffer[64];
+		uint16_t n;
+
+		task_protocol();
+		mSleep(1);
+		while((n = simUartTransmitted(buffer, sizeof(buffer))) > 0)
+			for(uint16_t i = 0; i < n; i++)
+				if(decoder.feed(buffer[i]))
+					return decoder.frame();
+	}
+	return Frame();
+}
+
+static bool isAck(const Frame &frame, uint8_t seq)
+{
+	return frame.type == MSG_ACK && frame.payload.size() == 2 && frame.payload[0] == seq;
+}
+
+static bool isNak(const Frame &frame, uint8_t seq, uint8_t error)
+{
+	return frame.type == MSG_NAK && frame.payload.size() == 2
+		&& frame.payload[0] == seq && frame.payload[1] == error;
+}
+
+/**
+ * COBS encodes type, seq, payload and crc without further checks - for
+ * frames the Encoder can not create.
+ */
+static std::vector<uint8_t> rawFrame(std::vector<uint8_t> raw, uint16_t crcXor)
+{
+	uint16_t crc = 0xFFFF;
+	for(uint8_t c : raw)
+		crc = protocolCRC16(crc, c);
+	crc ^= crcXor;
+	raw.push_back(crc & 0xFF);
+	raw.push_back(crc >> 8);
+
+	std::vector<uint8_t> out(1, 1);			// frames < 254 bytes
+	size_t code = 0;
+	for(uint8_t c : raw) {
+		if(c) {
+			out.push_back(c);
+			out[code]++;
+		}
+		else {
+			code = out.size();
+			out.push_back(1);
+		}
+	}
+	out.push_back(PROTOCOL_DELIMITER);
+	return out;
+}
+
+static void frames()
+{
+	Encoder encoder;
+	Frame answer;
+	State state;
+
+	std::vector<uint8_t> setAll = encoder.setAll({{100, -50, 200, 0, -300, 25}});
+	check(setAll.size() == 15, "MSG_SET_ALL is 15 bytes on the wire");
+	answer = transfer(setAll);
+	check(isAck(answer, encoder.lastSeq()), "MSG_SET_ALL is acknowledged");
+	answer = transfer(encoder.queryState());
+	check(answer.type == MSG_STATE && answer.seq == encoder.lastSeq()
+		&& parseState(answer, state), "MSG_QUERY_STATE is answered with MSG_STATE");
+	check(state.offsets == Joints{{100, -50, 200, 0, -300, 25}}, "MSG_SET_ALL sets all servos");
+
+	// Retransmission: same type and seq - ACK again, but not executed
+	std::vector<uint8_t> move = encoder.moveRelative(0x02, {{0, 40, 0, 0, 0, 0}});
+	uint8_t moveSeq = encoder.lastSeq();
+	check(isAck(transfer(move), moveSeq), "MSG_MOVE_REL is acknowledged");
+	check(isAck(transfer(move), moveSeq), "retransmission is acknowledged");
+	check(getServoPosition(2) == -10, "retransmission is not executed twice");
+
+	// Errors
+	answer = transfer(rawFrame({MSG_SET_ALL, 0x42, 1, 2, 3, 4, 5, 6, 7, 8, 9}, 0x0100));
+	check(isNak(answer, 0x42, NAK_CRC), "CRC error is NAK_CRC with the seq of the frame");
+	check(getServoPosition(1) == 100, "frame with CRC error is not executed");
+	static const uint8_t badCobs[] = {0x09, 0x01, 0x02, PROTOCOL_DELIMITER};
+	answer = transfer(std::vector<uint8_t>(badCobs, badCobs + sizeof(badCobs)));
+	check(isNak(answer, 0, NAK_CRC), "COBS error is NAK_CRC");
+	answer = transfer(rawFrame({MSG_SET_ALL}, 0));
+	check(isNak(answer, 0, NAK_LENGTH), "frame without seq is NAK_LENGTH");
+	std::vector<uint8_t> overlong(PROTOCOL_MAX_ENCODED + 10, 0x55);
+	overlong.push_back(PROTOCOL_DELIMITER);
+	answer = transfer(overlong);
+	check(isNak(answer, 0, NAK_LENGTH), "overlong frame is NAK_LENGTH");
+	answer = transfer(rawFrame({0x7F, 0x43}, 0));
+	check(isNak(answer, 0x43, NAK_UNKNOWN_TYPE), "unknown type is NAK_UNKNOWN_TYPE");
+	answer = transfer(rawFrame({MSG_SET_ALL, 0x44, 1, 2, 3}, 0));
+	check(isNak(answer, 0x44, NAK_BAD_PARAM), "short MSG_SET_ALL is NAK_BAD_PARAM");
+
+	// A rejected frame is not a retransmission: the same seq is executed
+	answer = transfer(rawFrame({MSG_MOVE_REL, 0x45, 0x01, 10, 0}, 0x0001));
+	check(isNak(answer, 0x45, NAK_CRC), "MSG_MOVE_REL with CRC error is rejected");
+	answer = transfer(rawFrame({MSG_MOVE_REL, 0x45, 0x01, 10, 0}, 0));
+	check(isAck(answer, 0x45) && getServoPosition(1) == 110,
+		"resent frame after a NAK is executed");
+}
+
+static void poses()
+{
+	Encoder encoder;
+	Frame answer;
+	StoredPose pose, read;
+	State state;
+
+	waitEEStore();
+	answer = transfer(encoder.teachPose(0, "home"));
+	check(isAck(answer, encoder.lastSeq()), "MSG_TEACH_POSE is acknowledged");
+	pose.number = 1;
+	pose.name = "pick";
+	pose.pulses = {{1600, 1300, 1550, 1500, 1500, 1800}};
+	answer = transfer(encoder.setPose(pose));
+	check(isNak(answer, encoder.lastSeq(), NAK_BUSY), "MSG_SET_POSE while the EEPROM is written is NAK_BUSY");
+	waitEEStore();
+	answer = transfer(encoder.setPose(pose));
+	check(isAck(answer, encoder.lastSeq()), "MSG_SET_POSE after the write is acknowledged");
+	waitEEStore();
+
+	answer = transfer(encoder.queryPose(1));
+	check(answer.type == MSG_POSE && parsePose(answer, read), "MSG_QUERY_POSE is answered with MSG_POSE");
+	check(read.number == 1 && read.name == "pick" && read.pulses == pose.pulses,
+		"MSG_POSE returns the saved pose");
+	answer = transfer(encoder.queryPose(0));
+	check(parsePose(answer, read) && read.name == "home"
+		&& read.pulses[4] == Start_Position[5] - 300, "MSG_TEACH_POSE saved the servo positions");
+	answer = transfer(encoder.queryPose(7));
+	check(isNak(answer, encoder.lastSeq(), NAK_BAD_PARAM), "MSG_QUERY_POSE of an empty pose is NAK_BAD_PARAM");
+
+	std::vector<SequenceStep> steps = {{1, 1, 0}, {0, 1, 0}};
+	answer = transfer(encoder.setSequence(2, "cycle", steps));
+	check(isAck(answer, encoder.lastSeq()), "MSG_SET_SEQUENCE is acknowledged");
+	waitEEStore();
+	answer = transfer(encoder.setSequence(3, "bad", {{POSES, 1, 0}}));
+	check(isNak(answer, encoder.lastSeq(), NAK_BAD_PARAM), "MSG_SET_SEQUENCE with a bad pose is NAK_BAD_PARAM");
+
+	answer = transfer(encoder.playSequence(2, 0));
+	check(isAck(answer, encoder.lastSeq()), "MSG_PLAY_SEQUENCE is acknowledged");
+	mSleep(100);
+	answer = transfer(encoder.queryState());
+	check(parseState(answer, state) && (state.flags & STATE_PLAYING), "MSG_STATE shows STATE_PLAYING");
+	answer = transfer(encoder.stop());
+	answer = transfer(encoder.queryState());
+	check(parseState(answer, state) && !(state.flags & STATE_PLAYING), "MSG_STOP stops the playback");
+	answer = transfer(encoder.playSequence(5));
+	check(isNak(answer, encoder.lastSeq(), NAK_BAD_PARAM), "MSG_PLAY_SEQUENCE of an empty sequence is NAK_BAD_PARAM");
+}
+
+int main()
+{
+	initRobotBase();
+	Power_Servos();
+	Default_Start_position();
+	frames();
+	poses();
+	check(decoder.badFrames() == 0, "all answers are valid frames");
+	return failures ? 1 : 0;
+}
@@ -0,0 +1,432 @@
+/* ****************************************************************************
+ * File: host/simcheck.c
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Checks the background features of the library against the simulated
+ * ATmega64 (make simcheck, part of make simtest). The exit code is 1 if
+ * a check fails.
+ *
+ *  - exact 1ms tick, millis32/micros32, stopwatches, idle time
+ *  - scheduler tasks and software timers
+ *  - motion engine: velocity profiles, synchronized moves, waypoint queue
+ *  - overcurrent protection: freeze, backoff, global power off
+ *  - pose library: sequence playback timing, also while a pose is saved
+ *  - stack guard (last, it freezes the servos until a reset)
+ * ****************************************************************************
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "RobotArmBase/RobotArmBaseLib.h"
+#include "host/avrsim/AvrSim.h"
+
+static int failures;
+
+static void check(int ok, const char *what)
+{
+	printf("%-60s %s\n", what, ok ? "ok" : "FAILED");
+	if(!ok)
+		failures++;
+}
+
+static double msNow(void)
+{
+	return simSeconds() * 1000;
+}
+
+/**
+ * Sets all servos to the offsets immediately.
+ */
+static void setAll(const int16_t *offsets)
+{
+	uint8_t i;
+
+	for(i = 0; i < 6; i++)
+		moveTo(i + 1, offsets[i], 0);
+}
+
+/*****************************************************************************/
+// Time:
+
+static void timeChecks(void)
+{
+	uint32_t ms, ticks, us, last;
+	double t, offset, error, deviation = 0;
+	int i, backwards = 0;
+
+	ms = millis32();
+	ticks = simInterruptCount(SIM_IRQ_TIMER2_COMP);
+	t = msNow();
+	mSleep(10000);
+	printf("10 s: %lu ms, %lu Timer 2 interrupts\n",
+		(unsigned long)(millis32() - ms),
+		(unsigned long)(simInterruptCount(SIM_IRQ_TIMER2_COMP) - ticks));
+	check(labs((long)(millis32() - ms) - (long)(msNow() - t + 0.5)) <= 1,
+		"millis32 follows the simulated time");
+	check(labs((long)(simInterruptCount(SIM_IRQ_TIMER2_COMP) - ticks) - 100000) <= 10,
+		"Timer 2 interrupt every 100us (1ms = 1.000ms)");
+
+	// micros32 at random times, 0.5us resolution against the exact
+	// simulated time:
+	last = micros32();
+	offset = simSeconds() * 1e6 - last;
+	for(i = 0; i < 20000; i++) {
+		simRun(rand() % 400);
+		us = micros32();
+		if(us < last)
+			backwards++;
+		error = simSeconds() * 1e6 - us - offset;
+		if(error > deviation || -error > deviation)
+			deviation = error < 0 ? -error : error;
+		last = us;
+	}
+	printf("micros32 deviation: %.2f us\n", deviation);
+	check(!backwards, "micros32 never runs backwards");
+	check(deviation <= 1.5, "micros32 follows the simulated time");
+
+	startStopwatch1();
+	mSleep(250);
+	check(abs((int)getStopwatch1() - 250) <= 1, "stopwatch 1 counts 250ms in mSleep(250)");
+}
+
+static void idleChecks(void)
+{
+	int i;
+
+	mSleep(2000);
+	printf("idle: %u%%\n", getIdlePercent());
+	check(getIdlePercent() >= 90, "idle time in mSleep >= 90%");
+
+	for(i = 0; i < 2000; i++)		// busy, never sleeps
+		simRun(F_CPU / 1000);
+	printf("busy: %u%%\n", getIdlePercent());
+	check(getIdlePercent() == 0, "idle time of a busy loop is 0%");
+
+	for(i = 0; i < 1000; i++) {		// every second ms busy
+		mSleep(1);
+		simRun(F_CPU / 1000);
+	}
+	printf("half busy: %u%%\n", getIdlePercent());
+	check(getIdlePercent() >= 40 && getIdlePercent() <= 55, "idle time with half of the ms busy");
+}
+
+/*****************************************************************************/
+// Scheduler tasks and software timers:
+
+static volatile uint16_t task_runs, oneshot_calls, periodic_calls, self_calls;
+static volatile uint32_t oneshot_ms;
+static soft_timer_t oneshot, periodic, self;
+
+static void countTask(void) { task_runs++; }
+static void oneshotTimer(void) { oneshot_calls++; oneshot_ms = millis32(); }
+static void periodicTimer(void) { periodic_calls++; }
+static void selfTimer(void)
+{
+	if(++self_calls == 3)
+		stopTimer(&self);
+}
+
+static void schedulerChecks(void)
+{
+	uint8_t task;
+	uint32_t start;
+
+	task = addTask(countTask, 10, 0);
+	check(task != NO_TASK, "addTask");
+	mSleep(1000);
+	printf("task with 10ms period: %u runs in 1s\n", task_runs);
+	check(task_runs >= 99 && task_runs <= 101, "task runs every 10ms in mSleep");
+	removeTask(task);
+	task_runs = 0;
+	mSleep(100);
+	check(task_runs == 0, "removed task does not run");
+
+	start = millis32();
+	startTimer(&oneshot, 25, 0, oneshotTimer);
+	startTimer(&periodic, 7, 7, periodicTimer);
+	startTimer(&self, 5, 5, selfTimer);
+	mSleep(700);
+	stopTimer(&periodic);
+	printf("one-shot after %lu ms, periodic %u calls in 700ms\n",
+		(unsigned long)(oneshot_ms - start), periodic_calls);
+	check(oneshot_calls == 1 && oneshot_ms - start == 25, "one-shot timer fires once after 25ms");
+	check(periodic_calls == 100, "periodic 7ms timer does not drift");
+	check(self_calls == 3 && !isTimerActive(&self), "timer function stops its own timer");
+	mSleep(20);
+	check(periodic_calls == 100, "stopped timer does not fire");
+}
+
+/*****************************************************************************/
+// Motion engine:
+
+static const int16_t zero[6] = {0, 0, 0, 0, 0, 0};
+
+/**
+ * Moves servo 2 from 0 to 600 with its profile, returns the time in ms.
+ * steps is the largest change of the step per ms, fastest the largest
+ * step.
+ */
+static int profileMove(int *steps, int *fastest)
+{
+	int16_t last = 0, pos;
+	int step, lastStep = 0, ms = 0;
+
+	setAll(zero);
+	*steps = *fastest = 0;
+	moveToProfile(2, 600);
+	while(isServoMoving(2) && ms < 5000) {
+		mSleep(1);
+		ms++;
+		pos = getServoPosition(2);
+		step = pos - last;
+		if(abs(step - lastStep) > *steps)
+			*steps = abs(step - lastStep);
+		if(step > *fastest)
+			*fastest = step;
+		last = pos;
+		lastStep = step;
+	}
+	return getServoPosition(2) == 600 ? ms : -1;
+}
+
+static void profileChecks(void)
+{
+	int trapezoid, scurve, steps, fastest;
+
+	// 2 counts/ms, 0.01 counts/ms^2: 200ms up (200 counts), 100ms at top
+	// speed (200 counts), 200ms down = 500ms
+	setMotionProfile(2, MOTION_TRAPEZOID, MOTION_FIX(2), MOTION_FIX(0.01), 0);
+	trapezoid = profileMove(&steps, &fastest);
+	printf("trapezoid: %d ms, top speed %d counts/ms, speed change %d\n",
+		trapezoid, fastest, steps);
+	// The braking distance is an estimate, the end is a bit slower:
+	check(trapezoid >= 500 && trapezoid <= 540, "trapezoid profile arrives after 500-540ms");
+	check(fastest <= 3 && steps <= 1, "trapezoid profile limits speed and acceleration");
+
+	// + 20ms jerk time (0.01 / 0.0005) at the start and the end
+	setMotionProfile(2, MOTION_SCURVE, MOTION_FIX(2), MOTION_FIX(0.01), MOTION_FIX(0.0005));
+	scurve = profileMove(&steps, &fastest);
+	printf("S-curve: %d ms\n", scurve);
+	check(scurve > trapezoid + 20 && scurve <= trapezoid + 100, "S-curve is slower than the trapezoid by the jerk time");
+
+	setMotionProfile(2, MOTION_CONSTANT, MOTION_FIX(1), MOTION_FIX(0.01), 0);
+}
+
+static void syncChecks(void)
+{
+	static const int16_t target[6] = {100, -200, 300, 50, 0, -25};
+	int arrival[6] = {0, 0, 0, 0, 0, 0};
+	int ms = 0, deviation = 0, i;
+
+	setAll(zero);
+	moveAllTo(target, 1);		// servo 3 is the master: 300ms
+	while(isMoving() && ms < 2000) {
+		int16_t master;
+
+		mSleep(1);
+		ms++;
+		master = getServoPosition(3);
+		for(i = 0; i < 6; i++) {
+			int16_t pos = getServoPosition(i + 1);
+			int expected = (master * target[i] + (target[i] < 0 ? -150 : 150)) / 300;
+			if(abs(pos - expected) > deviation)
+				deviation = abs(pos - expected);
+			if(!arrival[i] && !isServoMoving(i + 1) && target[i])
+				arrival[i] = ms;
+		}
+	}
+	printf("moveAllTo: %d ms, deviation from the straight line %d counts\n", ms, deviation);
+	check(ms >= 299 && ms <= 302, "synchronized move takes as long as the master");
+	check(deviation <= 1, "all servos follow the master proportionally");
+	for(i = 0; i < 6; i++)
+		if(target[i] && arrival[i] != arrival[2])
+			break;
+	check(i == 6, "all servos arrive in the same tick");
+}
+
+static void queueChecks(void)
+{
+	static const int16_t path[3][6] = {
+		{100, 0, 0, 0, 0, 0},		// 100ms
+		{100, 200, 0, 50, 0, 0},	// 200ms
+		{0, 0, 0, 0, 0, 0}			// 200ms
+	};
+	int16_t last = 0;
+	int ms = 0, pause = 0, longest = 0, i;
+
+	setAll(zero);
+	for(i = 0; i < 3; i++)
+		check(queueMove(path[i], 1), "queueMove");
+	check(getMotionQueueFree() == MOTION_QUEUE_SIZE - 3, "queue holds 3 segments");
+	while((isMoving() || getMotionQueueFree() != MOTION_QUEUE_SIZE) && ms < 2000) {
+		int16_t sum = 0;
+
+		mSleep(1);
+		ms++;
+		for(i = 0; i < 6; i++)
+			sum += abs(getServoPosition(i + 1));
+		// The first segment is started in the first tick and moves
+		// from the second one:
+		pause = (sum == last && ms > 1) ? pause + 1 : 0;
+		if(pause > longest)
+			longest = pause;
+		last = sum;
+	}
+	printf("waypoint queue: %d ms, longest stop %d ms\n", ms, longest);
+	check(ms >= 499 && ms <= 503, "queued segments take the sum of their times");
+	check(longest == 0, "no stop between the segments");
+	check(getServoPosition(1) == 0 && getServoPosition(2) == 0, "queue ends at the last waypoint");
+}
+
+/*****************************************************************************/
+// Overcurrent protection:
+
+static void overcurrentChecks(void)
+{
+	static const int16_t target[6] = {100, 200, 300, 150, 50, 20};
+	static const uint16_t currents[6] = {110, 90, 190, 290, 290, 290};
+	overcurrent_fault_t fault;
+	int16_t pos;
+	uint8_t i;
+
+	// Freeze:
+	setOvercurrentAction(OC_FREEZE);
+	setAll(zero);
+	moveTo(3, 300, 2);
+	mSleep(50);
+	simSetADC(ADC_CURRENT_3, 1000);
+	mSleep(10);
+	simSetADC(ADC_CURRENT_3, 0);
+	getOvercurrentFault(&fault);
+	check(fault.active == 0x04 && fault.joint == 3 && isServoFrozen(3),
+		"servo 3 trips and is frozen");
+	check(!isServoMoving(3), "frozen servo stops moving");
+	pos = getServoPosition(3);
+	moveTo(3, 0, 1);
+	mSleep(50);
+	check(getServoPosition(3) == pos, "frozen servo ignores moveTo");
+	mSleep(50);
+	clearOvercurrentFault();
+	moveTo(3, 0, 0);
+	check(getServoPosition(3) == 0 && !isServoFrozen(3), "clearOvercurrentFault unfreezes");
+
+	// Backoff during a synchronized move:
+	setOvercurrentAction(OC_BACKOFF);
+	moveAllTo(target, 2);
+	queueMove(zero, 2);
+	mSleep(100);
+	pos = getServoPosition(3);
+	simSetADC(ADC_CURRENT_3, 1000);
+	mSleep(20);
+	simSetADC(ADC_CURRENT_3, 0);
+	printf("backoff: servo 3 from %d to %d\n", pos, getServoPosition(3));
+	check(getServoPosition(3) < pos - OC_BACKOFF_STEPS + 3, "servo 3 moves back");
+	check(!isMoving() && getMotionQueueFree() == MOTION_QUEUE_SIZE,
+		"backoff stops the synchronized move and the queue");
+	mSleep(100);
+	clearOvercurrentFault();
+	pos = getServoPosition(3);
+	moveTo(3, pos + 10, 1);
+	mSleep(20);
+	check(getServoPosition(3) == pos + 10, "servo moves from the backoff position");
+
+	// Global limit:
+	setOvercurrentAction(OC_POWER_OFF);
+	Power_Servos();
+	for(i = 0; i < 6; i++)
+		simSetADC(ADC_CURRENT_1 + i, currents[i]);
+	mSleep(20);
+	for(i = 0; i < 6; i++)
+		simSetADC(ADC_CURRENT_1 + i, 0);
+	getOvercurrentFault(&fault);
+	check(fault.active == OC_FAULT_GLOBAL && fault.joint == 0, "sum of the currents trips the global limit");
+	check(!(PORTG & SERVO_POWER_v3), "OC_POWER_OFF switches the servo power off");
+	mSleep(50);
+	clearOvercurrentFault();
+	setOvercurrentAction(OC_FREEZE | OC_BACKOFF);
+	Power_Servos();
+}
+
+/*****************************************************************************/
+// Pose library:
+
+static void playbackChecks(void)
+{
+	pose_t p = {"a", {1600, 1500, 1500, 1500, 1500, 1500}};
+	pose_sequence_t s = {"ab", 2, {{0, 2, 5}, {1, 1, 0}}};
+	uint16_t i;
+	double t;
+
+	// Pose a: servo 1 +100, pose b: start position. One run is
+	// 100 * 2ms + 50ms dwell + 100 * 1ms = 350ms
+	for(i = 0; i < 6; i++)
+		p.pos[i] = Start_Position[i + 1] + (i ? 0 : 100);
+	check(savePose(0, &p) == EE_OK, "savePose");
+	for(i = 0; i < 6; i++)
+		p.pos[i] = Start_Position[i + 1];
+	strcpy(p.name, "b");
+	check(savePose(1, &p) == EE_OK, "savePose");
+	check(saveSequence(0, &s) == EE_OK, "saveSequence");
+	waitEEStore();
+	check(findPose("b") == 1 && findSequence("ab") == 0, "findPose and findSequence");
+
+	setAll(zero);
+	t = msNow();
+	check(playSequence(0, 2, 0) == EE_OK, "playSequence");
+	while(isPlaying() && msNow() - t < 3000)
+		mSleep(1);
+	t = msNow() - t;
+	// + up to one PLAYBACK_PERIOD per step until task_playback sees the
+	// arrival:
+	printf("2 runs: %.0f ms (expected 700-740 ms)\n", t);
+	check(t >= 700 && t <= 740, "playback time = step speeds + dwell times");
+	check(getServoPosition(1) == 0, "playback ends at the last pose");
+
+	// A pose saved during the playback is written in the background:
+	t = msNow();
+	playSequence(0, 2, 0);
+	mSleep(20);
+	p.pos[1] += 50;
+	savePose(5, &p);
+	check(isEEStoreBusy(), "savePose returns before the record is written");
+	while(isPlaying() && msNow() - t < 3000)
+		mSleep(1);
+	t = msNow() - t;
+	printf("2 runs while saving: %.0f ms\n", t);
+	check(t >= 700 && t <= 740, "saving a pose does not delay the playback");
+	waitEEStore();
+}
+
+/*****************************************************************************/
+// Stack guard:
+
+static void stackGuardChecks(void)
+{
+	check(!stack_fault, "no stack fault");
+	sim_sram[RAMSTART + STACK_GUARD_SIZE - 1] = 0;	// stack reached the guard
+	mSleep(2);
+	check(stack_fault && servo_frozen == 0x3F, "stack guard freezes all servos within 2ms");
+}
+
+int main(void)
+{
+	initRobotBase();
+	Power_Servos();
+	timeChecks();
+	idleChecks();
+	schedulerChecks();
+	profileChecks();
+	syncChecks();
+	queueChecks();
+	overcurrentChecks();
+	playbackChecks();
+	stackGuardChecks();
+	if(failures) {
+		printf("%d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}
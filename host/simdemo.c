@@ -0,0 +1,126 @@
+/* ****************************************************************************
+ * File: host/simdemo.c
+ * Target: host PC (gcc), simulated ATmega64
+ * ****************************************************************************
+ * Description:
+ * Runs the unchanged Robotarm library against the simulated ATmega64
+ * (make simdemo): initialisation, a servo move, ADC, EEPROM, UART output and
+ * input, and how much faster than real time the simulation runs.
+ * Every result is checked, the exit code is 1 if one is wrong - "make
+ * simtest" runs this, host/simcheck, host/kincheck and host/protocheck
+ * as regression test.
+ * ****************************************************************************
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include "RobotArmBase/RobotArmBaseLib.h"
+#include "host/avrsim/AvrSim.h"
+
+static double wallSeconds(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static int failures;
+
+static void check(int ok, const char *what)
+{
+	if(!ok) {
+		printf("  FAILED: %s\n", what);
+		failures++;
+	}
+}
+
+static void printTransmitted(void)
+{
+	uint8_t buffer[256];
+	uint16_t n;
+
+	while((n = simUartTransmitted(buffer, sizeof(buffer))) > 0)
+		fwrite(buffer, 1, n, stdout);
+}
+
+int main(void)
+{
+	double wall = wallSeconds();
+	double t;
+	int16_t from;
+	char line[32] = "";
+
+	initRobotBase();
+	printf("init done at %.3f s, board v3: %u\n", simSeconds(), robot_arm_v3);
+
+	// UART output:
+	writeString_P("Hello from the simulated Robotarm\n");
+	waitUntilTransmitComplete();
+	printTransmitted();
+
+	// ADC scanner:
+	simSetADC(ADC_UBAT, 700);
+	mSleep(500);		// EMA filter of the UBAT channel
+	printf("UBAT ADC: %u (expected 700)\n", adcUBat);
+	check(adcUBat == 700, "UBAT ADC");
+
+	// Motion: 2 ms per count
+	Default_Start_position();
+	Power_Servos();
+	from = getServoPosition(2);
+	t = simSeconds();
+	moveTo(2, 300, 2);
+	waitForServo(2);
+	t = simSeconds() - t;
+	printf("servo 2 from %d to %d in %.3f s (expected %.3f s)\n",
+		from, getServoPosition(2), t, abs(300 - from) * 0.002);
+	check(getServoPosition(2) == 300, "servo 2 target");
+	check(fabs(t - abs(300 - from) * 0.002) < 0.01, "servo 2 move time");
+
+	// EEPROM record store: saving does not block, a damaged record falls
+	// back to the previous one
+	Start_Position[3] = 1400;
+	t = simSeconds();
+	write_Values_EE();
+	printf("write_Values_EE returned after %.3f ms, busy: %u\n",
+		(simSeconds() - t) * 1000, isEEStoreBusy());
+	check(simSeconds() - t < 0.001 && isEEStoreBusy(), "write_Values_EE in the background");
+	waitEEStore();
+	printf("record written in %.3f ms, writes: %u\n",
+		(simSeconds() - t) * 1000, getRecordWrites(EE_AREA_CALIBRATION));
+	Start_Position[3] = 1600;
+	write_Values_EE();
+	waitEEStore();
+	sim_eeprom[EE_CALIBRATION_START + EE_SLOT_SIZE(EE_CALIBRATION_SIZE) + 9]++;
+	Read_Values_EE();
+	printf("start position 3 after a damaged record: %u (expected 1400)\n",
+		Start_Position[3]);
+	check(Start_Position[3] == 1400, "EEPROM fallback to the previous record");
+
+	// UART input:
+	simUartReceive((const uint8_t *)"ping\n", 5);
+	t = simSeconds();
+	while(!readLine(line, sizeof(line), '\n') && simSeconds() - t < 1)
+		mSleep(1);
+	printf("received \"%s\" at %.3f s\n", line, simSeconds());
+	check(!strcmp(line, "ping"), "UART input");
+
+	// Speed:
+	t = simSeconds();
+	mSleep(10000);
+	printf("idle: %u%%, Timer 2 interrupts: %u\n", getIdlePercent(),
+		simInterruptCount(SIM_IRQ_TIMER2_COMP));
+	printf("%.3f s virtual time in %.3f s wall time\n",
+		simSeconds(), wallSeconds() - wall);
+	check(simSeconds() - t >= 9.99, "mSleep(10000)");
+	check(getIdlePercent() >= 90, "idle time in mSleep");
+
+	if(failures) {
+		printf("%d checks FAILED\n", failures);
+		return 1;
+	}
+	printf("all checks passed\n");
+	return 0;
+}